@@ -1,2 +1,13 @@
 /usr/local/bin/glslc shaders/simple_shader.vert -o shaders/simple_shader.vert.spv
-/usr/local/bin/glslc shaders/simple_shader.frag -o shaders/simple_shader.frag.spv
\ No newline at end of file
+/usr/local/bin/glslc shaders/simple_shader.frag -o shaders/simple_shader.frag.spv
+/usr/local/bin/glslc shaders/cull.comp -o shaders/cull.comp.spv
+/usr/local/bin/glslc shaders/instanced.vert -o shaders/instanced.vert.spv
+/usr/local/bin/glslc shaders/instanced.frag -o shaders/instanced.frag.spv
+/usr/local/bin/glslc shaders/sierpinski.vert -o shaders/sierpinski.vert.spv
+/usr/local/bin/glslc shaders/chaos.comp -o shaders/chaos.comp.spv
+/usr/local/bin/glslc -DLVE_BINDLESS shaders/chaos.comp -o shaders/chaos_bindless.comp.spv
+/usr/local/bin/glslc shaders/fullscreen.vert -o shaders/fullscreen.vert.spv
+/usr/local/bin/glslc shaders/chaos_tonemap.frag -o shaders/chaos_tonemap.frag.spv
+/usr/local/bin/glslc -DLVE_BINDLESS shaders/chaos_tonemap.frag -o shaders/chaos_tonemap_bindless.frag.spv
+/usr/local/bin/glslc shaders/textured_quad.vert -o shaders/textured_quad.vert.spv
+/usr/local/bin/glslc shaders/textured_quad.frag -o shaders/textured_quad.frag.spv
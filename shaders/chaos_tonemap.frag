@@ -0,0 +1,34 @@
+#version 450
+
+#ifdef LVE_BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Storage buffer array of the bindless heap, indexed by push.histogramIndex
+layout(std430, set = 0, binding = 0) readonly buffer Histogram {
+    uint maxCount;
+    uint counts[];
+} histograms[];
+#define histogram histograms[push.histogramIndex]
+#else
+layout(std430, binding = 0) readonly buffer Histogram {
+    uint maxCount;
+    uint counts[];
+} histogram;
+#endif
+
+layout(push_constant) uniform Push {
+    uvec2 size;
+    uint histogramIndex;
+} push;
+
+layout (location = 0) out vec4 outColor;
+
+void main() {
+    uvec2 pixel = min(uvec2(gl_FragCoord.xy), push.size - 1u);
+    uint count = histogram.counts[pixel.y * push.size.x + pixel.x];
+
+    // Log density keeps sparse pixels visible next to saturated ones
+    float density = log(1.0 + float(count)) / log(1.0 + float(max(histogram.maxCount, 1u)));
+    vec3 color = mix(vec3(0.2, 0.1, 0.6), vec3(1.0, 0.9, 0.6), density);
+    outColor = vec4(color, density);
+}
@@ -0,0 +1,22 @@
+#version 450
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 instancePosition;
+layout(location = 2) in float instanceRotation;
+layout(location = 3) in float instanceScale;
+layout(location = 4) in vec4 instanceColor;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(push_constant) uniform Push {
+    vec2 scale;
+    vec2 offset;
+} push;
+
+void main() {
+    float s = sin(instanceRotation);
+    float c = cos(instanceRotation);
+    vec2 world = mat2(c, s, -s, c) * position * instanceScale + instancePosition;
+    gl_Position = vec4(world * push.scale + push.offset, 0.0, 1.0);
+    fragColor = instanceColor;
+}
@@ -0,0 +1,42 @@
+#version 450
+
+// Sierpinski triangle with no vertex input: the base-3 digits of the triangle id pick
+// the left (0), right (1) or top (2) child at each level, most significant digit first
+
+layout(push_constant) uniform Push {
+    vec2 scale;
+    vec2 offset;
+    vec2 origin;
+    float length;
+    uint depth;
+} push;
+
+const float HEIGHT = 0.86602540378;  // sin(60 degrees)
+
+void main() {
+    uint triangle = uint(gl_VertexIndex) / 3u;
+    uint corner = uint(gl_VertexIndex) % 3u;
+
+    // Walk from the deepest level up so the digits come out least significant first
+    vec2 local = vec2(0.0);
+    for (uint level = push.depth; level > 0u; level--) {
+        uint digit = triangle % 3u;
+        triangle /= 3u;
+        float size = exp2(-float(level));
+        if (digit == 1u) {
+            local += vec2(size, 0.0);
+        } else if (digit == 2u) {
+            local += vec2(0.5 * size, -HEIGHT * size);
+        }
+    }
+
+    float size = exp2(-float(push.depth));
+    if (corner == 1u) {
+        local += vec2(0.5 * size, -HEIGHT * size);
+    } else if (corner == 2u) {
+        local += vec2(size, 0.0);
+    }
+
+    vec2 position = push.origin + local * push.length;
+    gl_Position = vec4(position * push.scale + push.offset, 0.0, 1.0);
+}
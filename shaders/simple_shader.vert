@@ -2,6 +2,11 @@
 
 layout(location = 0) in vec2 position;
 
+layout(push_constant) uniform Push {
+    vec2 scale;
+    vec2 offset;
+} push;
+
 void main() {
-    gl_Position = vec4(position, 0.0, 1.0);
-}
\ No newline at end of file
+    gl_Position = vec4(position * push.scale + push.offset, 0.0, 1.0);
+}
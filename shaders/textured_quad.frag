@@ -0,0 +1,19 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Image array of the bindless heap, indexed by push.imageIndex
+layout(set = 0, binding = 1) uniform sampler2D images[];
+
+layout(push_constant) uniform Push {
+    vec2 offset;
+    vec2 size;
+    uint imageIndex;
+} push;
+
+layout(location = 0) in vec2 fragUv;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(images[push.imageIndex], fragUv);
+}
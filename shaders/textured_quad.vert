@@ -0,0 +1,15 @@
+#version 450
+
+layout(push_constant) uniform Push {
+    vec2 offset;
+    vec2 size;
+    uint imageIndex;
+} push;
+
+layout(location = 0) out vec2 fragUv;
+
+// Four-vertex triangle strip, no vertex input
+void main() {
+    fragUv = vec2(gl_VertexIndex & 1, (gl_VertexIndex >> 1) & 1);
+    gl_Position = vec4(push.offset + fragUv * push.size, 0.0, 1.0);
+}
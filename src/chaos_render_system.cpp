@@ -0,0 +1,306 @@
+#include "chaos_render_system.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+    ChaosRenderSystem::ChaosRenderSystem(
+        LveDevice &device,
+        const RenderTargetInfo &renderTarget,
+        VkExtent2D extent,
+        uint64_t pointsPerFrame,
+        uint32_t frameCount,
+        LveBindlessHeap *bindlessHeap)
+        : lveDevice{device}, extent{extent}, bindlessHeap{bindlessHeap} {
+        assert(pointsPerFrame > 0 && "Chaos game needs at least one point per frame");
+
+        // Round to whole workgroups within the dispatch limit
+        const uint64_t pointsPerGroup = uint64_t{WORKGROUP_SIZE} * ITERATIONS_PER_INVOCATION;
+        const uint64_t maxGroups = lveDevice.properties.limits.maxComputeWorkGroupCount[0];
+        groupCount = static_cast<uint32_t>(
+            std::clamp<uint64_t>((pointsPerFrame + pointsPerGroup - 1) / pointsPerGroup, 1, maxGroups));
+        this->pointsPerFrame = groupCount * pointsPerGroup;
+
+        createHistogram();
+        if (bindlessHeap) {
+            histogramIndex = bindlessHeap->registerBuffer(histogramBuffer);
+        } else {
+            createDescriptors();
+        }
+        createPipelineLayouts();
+        createPipelines(renderTarget);
+        createQueryPool(frameCount);
+    }
+
+    ChaosRenderSystem::~ChaosRenderSystem() {
+        if (queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(lveDevice.device(), queryPool, lveDevice.getAllocator());
+        }
+        accumulatePipeline.reset();
+        tonemapPipeline.reset();
+        vkDestroyPipelineLayout(lveDevice.device(), accumulateLayout, lveDevice.getAllocator());
+        vkDestroyPipelineLayout(lveDevice.device(), tonemapLayout, lveDevice.getAllocator());
+        if (bindlessHeap) {
+            bindlessHeap->releaseBuffer(histogramIndex);
+        } else {
+            vkDestroyDescriptorPool(lveDevice.device(), descriptorPool, lveDevice.getAllocator());
+            vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, lveDevice.getAllocator());
+        }
+        vkDestroyBuffer(lveDevice.device(), histogramBuffer, lveDevice.getAllocator());
+        vkFreeMemory(lveDevice.device(), histogramMemory, lveDevice.getAllocator());
+    }
+
+    void ChaosRenderSystem::createHistogram() {
+        // maxCount followed by one counter per pixel
+        VkDeviceSize size = sizeof(uint32_t) * (1 + VkDeviceSize{extent.width} * extent.height);
+        lveDevice.createBuffer(
+            size,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            histogramBuffer,
+            histogramMemory
+        );
+    }
+
+    void ChaosRenderSystem::createDescriptors() {
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &binding;
+
+        if (vkCreateDescriptorSetLayout(lveDevice.device(), &layoutInfo, lveDevice.getAllocator(), &descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create chaos descriptor set layout");
+        }
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = 1;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = 1;
+
+        if (vkCreateDescriptorPool(lveDevice.device(), &poolInfo, lveDevice.getAllocator(), &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create chaos descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &descriptorSetLayout;
+
+        if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate chaos descriptor set");
+        }
+
+        VkDescriptorBufferInfo bufferInfo{histogramBuffer, 0, VK_WHOLE_SIZE};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = descriptorSet;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &bufferInfo;
+        vkUpdateDescriptorSets(lveDevice.device(), 1, &write, 0, nullptr);
+    }
+
+    void ChaosRenderSystem::createPipelineLayouts() {
+        VkDescriptorSetLayout setLayout = bindlessHeap ? bindlessHeap->getSetLayout() : descriptorSetLayout;
+        auto createLayout = [&](VkShaderStageFlags stage, uint32_t pushSize, VkPipelineLayout &layout) {
+            VkPushConstantRange pushConstantRange{};
+            pushConstantRange.stageFlags = stage;
+            pushConstantRange.offset = 0;
+            pushConstantRange.size = pushSize;
+
+            VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+            pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            pipelineLayoutInfo.setLayoutCount = 1;
+            pipelineLayoutInfo.pSetLayouts = &setLayout;
+            pipelineLayoutInfo.pushConstantRangeCount = 1;
+            pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+            if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, lveDevice.getAllocator(), &layout) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create chaos pipeline layout");
+            }
+        };
+        createLayout(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(AccumulatePushConstants), accumulateLayout);
+        createLayout(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(TonemapPushConstants), tonemapLayout);
+    }
+
+    void ChaosRenderSystem::createPipelines(const RenderTargetInfo &renderTarget) {
+        accumulatePipeline = std::make_unique<LveComputePipeline>(
+            lveDevice,
+            bindlessHeap ? "shaders/chaos_bindless.comp.spv" : "shaders/chaos.comp.spv",
+            accumulateLayout);
+
+        auto pipelineConfig = LvePipeline::defaultPipelineConfigInfo(extent.width, extent.height);
+        pipelineConfig.setRenderTarget(renderTarget);
+        pipelineConfig.pipelineLayout = tonemapLayout;
+        pipelineConfig.bindingDescriptions.clear();
+        pipelineConfig.attributeDescriptions.clear();
+        // Blended over the triangle fractal by point density
+        pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+        pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+        pipelineConfig.colorBlendAttachment.blendEnable = VK_TRUE;
+        pipelineConfig.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        pipelineConfig.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        pipelineConfig.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        pipelineConfig.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+
+        tonemapPipeline = std::make_unique<LvePipeline>(
+            lveDevice,
+            "shaders/fullscreen.vert.spv",
+            bindlessHeap ? "shaders/chaos_tonemap_bindless.frag.spv" : "shaders/chaos_tonemap.frag.spv",
+            pipelineConfig
+        );
+    }
+
+    void ChaosRenderSystem::createQueryPool(uint32_t frameCount) {
+        // Timing is optional: some queues cannot write timestamps
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(lveDevice.getPhysicalDevice(), &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(lveDevice.getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+        uint32_t graphicsFamily = lveDevice.findPhysicalQueueFamilies().graphicsFamily;
+        if (queueFamilies[graphicsFamily].timestampValidBits == 0 ||
+            lveDevice.properties.limits.timestampPeriod <= 0.0f) {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = 2 * frameCount;
+
+        if (vkCreateQueryPool(lveDevice.device(), &queryPoolInfo, lveDevice.getAllocator(), &queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create chaos timestamp query pool");
+        }
+        timestampPeriod = lveDevice.properties.limits.timestampPeriod;
+        timestampsWritten.resize(frameCount, false);
+    }
+
+    void ChaosRenderSystem::collectTimings(uint32_t frameIndex) {
+        if (queryPool == VK_NULL_HANDLE || !timestampsWritten[frameIndex]) {
+            return;
+        }
+        std::array<uint64_t, 2> timestamps{};
+        VkResult result = vkGetQueryPoolResults(
+            lveDevice.device(),
+            queryPool,
+            2 * frameIndex,
+            2,
+            sizeof(timestamps),
+            timestamps.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT);
+        timestampsWritten[frameIndex] = false;
+        if (result != VK_SUCCESS) {
+            return;
+        }
+        measuredSeconds += static_cast<double>(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-9;
+        measuredPoints += pointsPerFrame;
+    }
+
+    double ChaosRenderSystem::takeGpuPointsPerSecond() {
+        double pointsPerSecond = measuredSeconds > 0.0 ? measuredPoints / measuredSeconds : 0.0;
+        measuredSeconds = 0.0;
+        measuredPoints = 0;
+        return pointsPerSecond;
+    }
+
+    void ChaosRenderSystem::recordAccumulate(
+        VkCommandBuffer commandBuffer,
+        uint32_t frameIndex,
+        const LveCamera &camera) {
+        if (clearPending) {
+            vkCmdFillBuffer(commandBuffer, histogramBuffer, 0, VK_WHOLE_SIZE, 0);
+
+            VkBufferMemoryBarrier clearBarrier{};
+            clearBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            clearBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            clearBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            clearBarrier.buffer = histogramBuffer;
+            clearBarrier.offset = 0;
+            clearBarrier.size = VK_WHOLE_SIZE;
+            clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 0, nullptr, 1, &clearBarrier, 0, nullptr);
+            clearPending = false;
+        }
+
+        if (queryPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, queryPool, 2 * frameIndex, 2);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 2 * frameIndex);
+        }
+
+        auto transform = camera.getTransform(glm::dvec2{0.0});
+        AccumulatePushConstants push{};
+        push.scale = transform.scale;
+        push.offset = transform.offset;
+        push.size = {extent.width, extent.height};
+        push.seed = seed++ * 0x9E3779B9u;
+        push.iterations = ITERATIONS_PER_INVOCATION;
+        push.histogramIndex = histogramIndex;
+
+        accumulatePipeline->bind(commandBuffer);
+        bindHistogram(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, accumulateLayout);
+        vkCmdPushConstants(
+            commandBuffer,
+            accumulateLayout,
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(AccumulatePushConstants),
+            &push);
+        vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+
+        if (queryPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, queryPool, 2 * frameIndex + 1);
+            timestampsWritten[frameIndex] = true;
+        }
+    }
+
+    void ChaosRenderSystem::render(VkCommandBuffer commandBuffer) {
+        TonemapPushConstants push{};
+        push.size = {extent.width, extent.height};
+        push.histogramIndex = histogramIndex;
+
+        tonemapPipeline->bind(commandBuffer);
+        bindHistogram(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, tonemapLayout);
+        vkCmdPushConstants(
+            commandBuffer,
+            tonemapLayout,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            sizeof(TonemapPushConstants),
+            &push);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    void ChaosRenderSystem::bindHistogram(
+        VkCommandBuffer commandBuffer,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout layout) {
+        if (bindlessHeap) {
+            bindlessHeap->bind(commandBuffer, bindPoint, layout);
+            return;
+        }
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, 0, 1, &descriptorSet, 0, nullptr);
+    }
+}
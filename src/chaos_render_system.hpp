@@ -0,0 +1,106 @@
+#pragma once
+
+#include "lve_bindless_heap.hpp"
+#include "lve_camera.hpp"
+#include "lve_compute_pipeline.hpp"
+#include "lve_device.hpp"
+#include "lve_pipeline.hpp"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+    // Renders the Sierpinski attractor as a point cloud: a compute pass plays the chaos game
+    // into a per-pixel hit histogram with atomics, and a fullscreen pass tone-maps it over the
+    // frame. Memory is one counter per pixel regardless of how many points are drawn.
+    // With a bindless heap the histogram is registered there and both passes index it by push
+    // constant; otherwise the system owns a one-buffer descriptor set.
+    class ChaosRenderSystem {
+        public:
+            static constexpr uint32_t WORKGROUP_SIZE = 64;
+            // Points plotted by each invocation per dispatch
+            static constexpr uint32_t ITERATIONS_PER_INVOCATION = 256;
+
+            ChaosRenderSystem(
+                LveDevice &device,
+                const RenderTargetInfo &renderTarget,
+                VkExtent2D extent,
+                uint64_t pointsPerFrame,
+                uint32_t frameCount,
+                LveBindlessHeap *bindlessHeap = nullptr);
+            ~ChaosRenderSystem();
+
+            ChaosRenderSystem(const ChaosRenderSystem &) = delete;
+            ChaosRenderSystem &operator=(const ChaosRenderSystem &) = delete;
+
+            // Restarts accumulation, e.g. after the camera moved
+            void reset() { clearPending = true; }
+
+            // Reads back the GPU time of the last use of this frame slot; call once its fence has signalled
+            void collectTimings(uint32_t frameIndex);
+            // Must be recorded outside of a render pass. The caller orders it after the previous
+            // frame's tone-map reads and before this frame's, e.g. through the render graph.
+            void recordAccumulate(VkCommandBuffer commandBuffer, uint32_t frameIndex, const LveCamera &camera);
+            // Must be recorded inside the render pass
+            void render(VkCommandBuffer commandBuffer);
+
+            VkBuffer getHistogramBuffer() const { return histogramBuffer; }
+
+            uint64_t getPointsPerFrame() const { return pointsPerFrame; }
+            bool hasGpuTimings() const { return timestampPeriod > 0.0; }
+            // Points per second of GPU compute time since the last call, 0 when nothing was measured
+            double takeGpuPointsPerSecond();
+
+        private:
+            struct AccumulatePushConstants {
+                glm::vec2 scale;
+                glm::vec2 offset;
+                glm::uvec2 size;
+                uint32_t seed;
+                uint32_t iterations;
+                uint32_t histogramIndex;
+            };
+
+            struct TonemapPushConstants {
+                glm::uvec2 size;
+                uint32_t histogramIndex;
+            };
+
+            void createHistogram();
+            void createDescriptors();
+            void createPipelineLayouts();
+            void createPipelines(const RenderTargetInfo &renderTarget);
+            void bindHistogram(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout);
+            void createQueryPool(uint32_t frameCount);
+
+            LveDevice &lveDevice;
+            VkExtent2D extent;
+            uint64_t pointsPerFrame;
+            uint32_t groupCount;
+            uint32_t seed = 1;
+            bool clearPending = true;
+
+            VkBuffer histogramBuffer;
+            VkDeviceMemory histogramMemory;
+
+            LveBindlessHeap *bindlessHeap;
+            uint32_t histogramIndex = 0;
+            // Only without a bindless heap
+            VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+            VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            VkPipelineLayout accumulateLayout;
+            VkPipelineLayout tonemapLayout;
+            std::unique_ptr<LveComputePipeline> accumulatePipeline;
+            std::unique_ptr<LvePipeline> tonemapPipeline;
+
+            // Two timestamps per frame slot around the dispatch
+            VkQueryPool queryPool = VK_NULL_HANDLE;
+            double timestampPeriod = 0.0;
+            std::vector<bool> timestampsWritten;
+            double measuredSeconds = 0.0;
+            uint64_t measuredPoints = 0;
+    };
+}
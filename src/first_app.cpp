@@ -1,163 +1,715 @@
 #include "first_app.hpp"
+#include "lve_mesh_importer.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_stripifier.hpp"
 
 // STD
 #include <stdexcept>
 #include <memory>
-#include <array>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <random>
+#define _USE_MATH_DEFINES
+#include <cmath>
 
 namespace lve {
 
-    FirstApp::FirstApp() {
+    FirstApp::FirstApp(const LveAppConfig &config) : config{config} {
         std::cout << "Starting App...\n";
-        loadModels();
-        createPipelineLayout();
-        createPipeline();
-        createCommandBuffers();
+        startTime = LveStartupGraph::Clock::now();
+        scene.setJobSystem(&jobSystem);
+
+        // CPU-only phases (geometry, SPIR-V loading) overlap with instance and device creation.
+        // Phases that allocate from the device command pool are chained, as the pool is not thread safe.
+        using Thread = LveStartupGraph::Thread;
+        LveStartupGraph startup{jobSystem};
+        std::vector<char> vertCode;
+        std::vector<char> fragCode;
+
+        auto window = startup.addTask("window", Thread::Main, [this]() {
+            lveWindow = std::make_unique<LveWindow>(WIDTH, HEIGHT, "Hello, Vulkan!");
+        });
+        auto device = startup.addTask("device", Thread::Worker, [this]() {
+            lveDevice = std::make_unique<LveDevice>(*lveWindow, this->config.device, !this->config.systemAllocator);
+            if (this->config.submitThread) {
+                lveDevice->startSubmitThread();
+            }
+            dynamicRendering = lveDevice->supportsDynamicRendering() && !this->config.renderPasses;
+            std::cout << "Rendering path: " << (dynamicRendering ? "dynamic rendering" : "render passes") << "\n";
+        }, {window});
+        auto swapChain = startup.addTask("swap chain", Thread::Worker, [this]() {
+            lveSwapChain = std::make_unique<LveSwapChain>(*lveDevice, lveWindow->getExtent(), dynamicRendering);
+        }, {device});
+        auto shaders = startup.addTask("shader load", Thread::Worker, [&]() {
+            vertCode = LvePipeline::readFile(
+                this->config.procedural ? "shaders/sierpinski.vert.spv" : "shaders/simple_shader.vert.spv");
+            fragCode = LvePipeline::readFile("shaders/simple_shader.frag.spv");
+        });
+        auto geometry = startup.addTask("fractal generate", Thread::Worker, [this]() { generateFractal(); });
+        auto models = startup.addTask("fractal upload", Thread::Worker, [this]() { loadModels(); }, {device, geometry});
+        auto sceneLoad = startup.addTask("scene", Thread::Worker, [this]() { loadScene(); }, {device});
+        auto layout = startup.addTask("pipeline layout", Thread::Worker, [this]() { createPipelineLayout(); }, {device});
+        // Only one of these does any work: with dynamic rendering the pipeline needs just the
+        // attachment formats, otherwise it waits for the swap chain's render pass. Both wait for
+        // the model, whose topology the pipeline's input assembly follows.
+        auto dynamicPipeline = startup.addTask("pipeline (dynamic)", Thread::Worker, [&]() {
+            if (dynamicRendering) {
+                createPipeline(vertCode, fragCode);
+            }
+        }, {device, layout, shaders, models});
+        auto renderPassPipeline = startup.addTask("pipeline (pass)", Thread::Worker, [&]() {
+            if (!dynamicRendering) {
+                createPipeline(vertCode, fragCode);
+            }
+        }, {swapChain, layout, shaders, models});
+        auto renderSystems = startup.addTask("render systems", Thread::Worker, [this]() {
+            createRenderSystems();
+        }, {swapChain, sceneLoad, layout});
+        startup.addTask("render graph", Thread::Worker, [this]() {
+            createRenderGraph();
+        }, {dynamicPipeline, renderPassPipeline, renderSystems, models});
+        startup.addTask("command buffers", Thread::Worker, [this]() { createCommandBuffers(); }, {sceneLoad});
+
+        startup.run();
+        startup.printReport();
     }
 
     FirstApp::~FirstApp() {
-        vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
+        vkDestroyPipelineLayout(lveDevice->device(), pipelineLayout, lveDevice->getAllocator());
     }
 
     void FirstApp::run() {
-        while (!lveWindow.shouldClose()) {
-            glfwPollEvents();
+        auto currentTime = std::chrono::high_resolution_clock::now();
+        auto reportTime = currentTime;
+        uint64_t reportFrames = 0;
+
+        const bool onDemand = config.renderPolicy == RenderPolicy::OnDemand;
+        std::unique_ptr<LveFrameLimiter> frameLimiter;
+        if (config.maxFps > 0) {
+            frameLimiter = std::make_unique<LveFrameLimiter>(config.maxFps);
+        }
+        // On demand, a frame is drawn only when redraw is set. After drawing, events are polled
+        // once more so held keys keep animating; the loop blocks once an iteration changes nothing.
+        bool redraw = true;
+        bool drewLastIteration = false;
+        uint32_t chaosFrames = 0;
+        uint64_t framesDrawn = 0;
+        double idleSeconds = 0.0;
+        auto runStart = currentTime;
+
+        // Startup peak is kept aside so the frame loop's own peak and steady state show up
+        auto &hostAllocator = lveDevice->getHostAllocator();
+        const uint64_t startupHostPeak = hostAllocator.getSnapshot().peakBytes;
+        hostAllocator.resetPeak();
+        const auto frameHostBefore = hostAllocator.getThreadStats();
+
+        while (!lveWindow->shouldClose()) {
+            if (onDemand && !redraw && !drewLastIteration) {
+                auto waitStart = std::chrono::high_resolution_clock::now();
+                glfwWaitEvents();
+                idleSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - waitStart).count();
+            } else {
+                glfwPollEvents();
+            }
+
+            auto newTime = std::chrono::high_resolution_clock::now();
+            float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
+            // Keeps the first key press after an idle wait from jumping the camera
+            frameTime = std::min(frameTime, MAX_FRAME_TIME);
+            currentTime = newTime;
+
+            if (cameraController.update(*lveWindow, camera, frameTime)) {
+                if (fractal) {
+                    updateFractal();
+                }
+                if (chaosRenderSystem) {
+                    chaosRenderSystem->reset();
+                    chaosFrames = 0;
+                }
+                redraw = true;
+            }
+            if (lveWindow->takeDamage()) {
+                redraw = true;
+            }
+            if (scene.hasMotion()) {
+                scene.update(frameTime);
+                redraw = true;
+            }
+            if (chaosRenderSystem && chaosFrames < CHAOS_SETTLE_FRAMES) {
+                // The point cloud keeps refining for a while after every reset
+                redraw = true;
+            }
+            if (textureStreamer && textureStreamer->isStreaming()) {
+                // Uploads and promotions only advance in frames that are drawn
+                redraw = true;
+            }
+
+            drewLastIteration = false;
+            if (onDemand && !redraw) {
+                continue;
+            }
+            if (frameLimiter) {
+                frameLimiter->wait();
+            }
             drawFrame();
+            redraw = false;
+            drewLastIteration = true;
+            framesDrawn++;
+            chaosFrames = std::min(chaosFrames + 1, CHAOS_SETTLE_FRAMES);
+
+            if (!firstFrameSubmitted) {
+                firstFrameSubmitted = true;
+                double ms = std::chrono::duration<double, std::milli>(LveStartupGraph::Clock::now() - startTime).count();
+                std::cout << "Time to first frame: " << ms << " ms\n";
+            }
+
+            reportFrames++;
+            double reportSeconds = std::chrono::duration<double>(newTime - reportTime).count();
+            if ((chaosRenderSystem || queryStats) && reportSeconds >= 1.0) {
+                if (chaosRenderSystem) {
+                    double wallRate = chaosRenderSystem->getPointsPerFrame() * reportFrames / reportSeconds;
+                    std::cout << "chaos: " << wallRate * 1e-6 << " Mpoints/s";
+                    if (chaosRenderSystem->hasGpuTimings()) {
+                        std::cout << ", " << chaosRenderSystem->takeGpuPointsPerSecond() * 1e-6 << " Mpoints/s of GPU time";
+                    }
+                    std::cout << "\n";
+                }
+                if (queryStats) {
+                    auto stats = queryStats->takeAverage();
+                    std::cout << "per frame: " << stats.samplesPassed << " samples passed";
+                    if (queryStats->hasPipelineStatistics()) {
+                        std::cout << ", " << stats.inputAssemblyVertices << " vertices, "
+                                  << stats.vertexShaderInvocations << " VS invocations, "
+                                  << stats.clippingPrimitives << " primitives after clipping, "
+                                  << stats.fragmentShaderInvocations << " FS invocations";
+                    }
+                    std::cout << "\n";
+                }
+                reportTime = newTime;
+                reportFrames = 0;
+            }
+        }
+
+        double runSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - runStart).count();
+        std::cout << "Drew " << framesDrawn << " frames in " << runSeconds << " s";
+        if (onDemand) {
+            std::cout << ", idle in glfwWaitEvents for " << idleSeconds << " s";
+        }
+        if (frameLimiter) {
+            std::cout << ", limiter slept " << frameLimiter->getSleepSeconds() << " s and spun "
+                      << frameLimiter->getSpinSeconds() << " s";
+        }
+        std::cout << "\n";
+
+        if (lveDevice->tracksHostAllocations()) {
+            auto frameHostAfter = hostAllocator.getThreadStats();
+            auto snapshot = hostAllocator.getSnapshot();
+            double frames = static_cast<double>(std::max<uint64_t>(framesDrawn, 1));
+            std::cout << "Host memory: " << startupHostPeak / 1024.0 << " KB startup peak, "
+                      << snapshot.peakBytes / 1024.0 << " KB frame loop peak, "
+                      << snapshot.currentBytes / 1024.0 << " KB steady state\n";
+            std::cout << "Per frame on the main thread: "
+                      << (frameHostAfter.calls - frameHostBefore.calls) / frames << " allocator calls, "
+                      << (frameHostAfter.bytes - frameHostBefore.bytes) / frames << " bytes, "
+                      << (frameHostAfter.nanoseconds - frameHostBefore.nanoseconds) / frames << " ns\n";
+            hostAllocator.printReport();
         }
 
-        vkDeviceWaitIdle(lveDevice.device());
+        lveDevice->waitIdle();
+        if (LveSubmitThread *submitThread = lveDevice->getSubmitThread()) {
+            submitThread->printReport();
+        }
+        if (frameReadback) {
+            frameReadback->collectAll();
+            frameReadback->printReport();
+        }
+        if (queryStats) {
+            for (uint32_t slot = 0; slot < LveSwapChain::MAX_FRAMES_IN_FLIGHT; slot++) {
+                queryStats->collect(slot);
+            }
+            queryStats->printReport();
+        }
+        if (textureStreamer) {
+            textureStreamer->printReport();
+        }
+    }
+
+    void FirstApp::generateFractal() {
+        if (config.procedural || !config.modelPath.empty()) {
+            return;
+        }
+        // The swap chain may not exist yet; its extent matches the window's
+        fractal = std::make_unique<LveFractal>(MAX_TRIANGLES, REFINE_PIXEL_SIZE);
+        fractal->update(camera, static_cast<float>(WIDTH));
     }
 
     void FirstApp::loadModels() {
-        
-        std::vector<LveModel::Vertex> vertices = {
-            //{{0.0f, -0.5f}},
-            //{{0.5f, 0.5f}},
-            //{{-0.5f, 0.5f}},
+        if (config.procedural) {
+            // Positions are derived in the vertex shader, so nothing is generated or uploaded
+            lveModel = std::make_unique<LveModel>(*lveDevice, LveModel::Procedural{config.proceduralDepth});
+            std::cout << "Procedural fractal: depth " << config.proceduralDepth << ", "
+                      << lveModel->getVertexCount() / 3 << " triangles\n";
+            return;
+        }
+        if (!config.modelPath.empty()) {
+            loadImportedModel();
+            return;
+        }
+
+        const uint32_t frameCount = LveSwapChain::MAX_FRAMES_IN_FLIGHT;
+        lveModel = std::make_unique<LveModel>(*lveDevice, MAX_TRIANGLES * 3, frameCount);
+        gpuCuller = std::make_unique<LveGpuCuller>(*lveDevice, fractal->getMaxBlockCount(), frameCount);
+        uploadFractalChanges();
+    }
+
+    void FirstApp::loadImportedModel() {
+        auto start = std::chrono::high_resolution_clock::now();
+        LveMeshImporter importer{jobSystem};
+        LveMeshData mesh = importer.load(config.modelPath);
+        if (mesh.indices.empty()) {
+            throw std::runtime_error("model has no triangles: " + config.modelPath);
+        }
+        auto imported = std::chrono::high_resolution_clock::now();
+
+        std::vector<LveModel::Vertex> vertices = mesh.toModelVertices();
+        MeshOptimizeReport report = optimizeMesh(vertices, mesh.indices, mesh.positions);
+        if (config.strips) {
+            // Strips follow edge neighbours, so neither the overdraw cluster order nor the
+            // optimized ACMR below carries over to what is drawn
+            lveModel = std::make_unique<LveModel>(
+                *lveDevice, vertices, stripify(mesh.indices), VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+        } else {
+            lveModel = std::make_unique<LveModel>(*lveDevice, vertices, mesh.indices);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
 
-            // First
-            //{{0.0, -0.5}},
-            //{{0.25, 0.0}},
-            //{{-0.25, 0.0}},
+        std::cout << "Model " << config.modelPath << ": " << mesh.indices.size() / 3 << " triangles, "
+                  << report.vertexCount << " vertices, imported in "
+                  << std::chrono::duration<double, std::milli>(imported - start).count() << " ms, optimized in "
+                  << std::chrono::duration<double, std::milli>(end - imported).count() << " ms, ACMR "
+                  << report.before.acmr << " -> " << report.after.acmr;
+        if (config.strips) {
+            std::cout << ", drawn as strips with " << lveModel->getIndexCount() << " indices";
+        }
+        std::cout << "\n";
+    }
 
-            // Second
-            //{{-0.25, 0.0}},
-            //{{0.0, 0.5}},
-            //{{-0.5, 0.5}},
+    void FirstApp::loadScene() {
+        if (config.sceneObjects == 0) {
+            return;
+        }
 
-            // Third
-            //{{0.25, 0.0}},
-            //{{0.5, 0.5}},
-            //{{0.0, 0.5}},
-        };
+        // A handful of regular polygons (triangle fans) shared by every object
+        const uint32_t meshCount = 4;
+        meshPool = std::make_unique<LveMeshPool>(*lveDevice, 1024, 1024, meshCount, LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+        for (uint32_t sides = 3; sides < 3 + meshCount; sides++) {
+            std::vector<LveModel::Vertex> vertices;
+            std::vector<uint32_t> indices;
+            vertices.push_back({{0.0f, 0.0f}});
+            for (uint32_t i = 0; i < sides; i++) {
+                float angle = 2.0f * static_cast<float>(M_PI) * i / sides;
+                vertices.push_back({{glm::cos(angle), glm::sin(angle)}});
+                indices.push_back(0);
+                indices.push_back(1 + i);
+                indices.push_back(1 + (i + 1) % sides);
+            }
+            // Flat and drawn without depth, so only the cache and fetch passes apply
+            optimizeMesh(vertices, indices);
+            meshPool->addMesh(vertices, indices);
+        }
+        meshPool->upload();
 
-        seirpinskiSieve(-1.0, 1, 2.0f, 1, vertices);
-        lveModel = std::make_unique<LveModel>(lveDevice, vertices);
+        std::mt19937 rng{1234};
+        std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+        scene.reserve(config.sceneObjects);
+        scene.setWorldBounds({-1.0f, -1.0f}, {1.0f, 1.0f});
+        for (uint32_t i = 0; i < config.sceneObjects; i++) {
+            LveScene::ObjectDesc desc{};
+            desc.position = {2.0f * unit(rng) - 1.0f, 2.0f * unit(rng) - 1.0f};
+            desc.velocity = {0.2f * (unit(rng) - 0.5f), 0.2f * (unit(rng) - 0.5f)};
+            desc.angularVelocity = 2.0f * (unit(rng) - 0.5f);
+            desc.scale = 0.01f + 0.02f * unit(rng);
+            desc.color = {unit(rng), unit(rng), unit(rng), 1.0f};
+            desc.meshId = i % meshCount;
+            scene.create(desc);
+        }
+        std::cout << "Scene objects: " << scene.size() << "\n";
+    }
+
+    void FirstApp::updateFractal() {
+        if (fractal->update(camera, static_cast<float>(lveSwapChain->width()))) {
+            uploadFractalChanges();
+        }
+    }
+
+    void FirstApp::uploadFractalChanges() {
+        // Only the slots whose leaf changed are copied to the vertex buffers
+        fractal->takeChanges(dirtySpans, dirtyBlocks);
+        const auto &vertices = fractal->getVertices();
+        for (const auto &span : dirtySpans) {
+            lveModel->writeVertices(span.firstVertex, &vertices[span.firstVertex], span.vertexCount);
+        }
+        for (uint32_t blockIndex : dirtyBlocks) {
+            const auto &block = fractal->getBlock(blockIndex);
+            gpuCuller->updateObject(
+                blockIndex,
+                {block.minBounds, block.maxBounds, block.firstVertex, block.vertexCount});
+        }
+        lveModel->setVertexCount(fractal->getVertexCount());
+        gpuCuller->setObjectCount(fractal->getBlockCount());
     }
 
     void FirstApp::createPipelineLayout() {
         std::cout << "Creating Pipeline Layout...\n";
+        if (lveDevice->supportsDescriptorIndexing() && !config.noBindless) {
+            bindlessHeap = std::make_unique<LveBindlessHeap>(*lveDevice);
+            std::cout << "Bindless heap: " << bindlessHeap->getBufferCapacity() << " buffers, "
+                      << bindlessHeap->getImageCapacity() << " images\n";
+        }
+        VkDescriptorSetLayout setLayout = bindlessHeap ? bindlessHeap->getSetLayout() : VK_NULL_HANDLE;
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = config.procedural
+            ? sizeof(ProceduralPushConstantData)
+            : sizeof(SimplePushConstantData);
+
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 0;
-        pipelineLayoutInfo.pSetLayouts = nullptr;
-        pipelineLayoutInfo.pushConstantRangeCount = 0;
-        pipelineLayoutInfo.pPushConstantRanges = nullptr;
+        pipelineLayoutInfo.setLayoutCount = bindlessHeap ? 1 : 0;
+        pipelineLayoutInfo.pSetLayouts = bindlessHeap ? &setLayout : nullptr;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-        if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        if (vkCreatePipelineLayout(lveDevice->device(), &pipelineLayoutInfo, lveDevice->getAllocator(), &pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create pipeline layout");
         } 
     }
 
-    void FirstApp::createPipeline() {
+    RenderTargetInfo FirstApp::getRenderTarget() {
+        RenderTargetInfo target{};
+        if (dynamicRendering) {
+            // Same choices the swap chain makes, so this works before it exists
+            target.colorFormat = LveSwapChain::chooseSwapSurfaceFormat(lveDevice->getSwapChainSupport().formats).format;
+            target.depthFormat = LveSwapChain::findDepthFormat(*lveDevice);
+        } else {
+            target.renderPass = lveSwapChain->getRenderPass();
+            target.colorFormat = lveSwapChain->getSwapChainImageFormat();
+            target.depthFormat = lveSwapChain->findDepthFormat();
+        }
+        return target;
+    }
+
+    void FirstApp::createPipeline(const std::vector<char> &vertCode, const std::vector<char> &fragCode) {
         std::cout << "Creating Pipeline...\n";
-        auto pipelineConfig = 
-            LvePipeline::defaultPipelineConfigInfo(lveSwapChain.width(), lveSwapChain.height());
-        pipelineConfig.renderPass = lveSwapChain.getRenderPass();
+        // Counted on this thread only, as other startup tasks allocate concurrently
+        auto hostBefore = lveDevice->getHostAllocator().getThreadStats();
+        // Viewport and scissor are set when recording, so no extent is needed here
+        auto pipelineConfig = LvePipeline::defaultPipelineConfigInfo(WIDTH, HEIGHT);
+        pipelineConfig.dynamicStateEnables = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        pipelineConfig.setRenderTarget(getRenderTarget());
         pipelineConfig.pipelineLayout = pipelineLayout;
+        pipelineConfig.setTopology(lveModel->getTopology(), lveModel->usesPrimitiveRestart());
+        if (config.procedural) {
+            // sierpinski.vert pulls nothing from vertex buffers
+            pipelineConfig.bindingDescriptions.clear();
+            pipelineConfig.attributeDescriptions.clear();
+        }
         lvePipeline = std::make_unique<LvePipeline>(
-            lveDevice,
-            "shaders/simple_shader.vert.spv",
-            "shaders/simple_shader.frag.spv",
+            *lveDevice,
+            vertCode,
+            fragCode,
             pipelineConfig
         );
-
+        if (lveDevice->tracksHostAllocations()) {
+            auto hostAfter = lveDevice->getHostAllocator().getThreadStats();
+            std::cout << "Pipeline host allocations: " << hostAfter.calls - hostBefore.calls << " calls, "
+                      << (hostAfter.bytes - hostBefore.bytes) / 1024.0 << " KB, "
+                      << (hostAfter.nanoseconds - hostBefore.nanoseconds) / 1000.0 << " us in the allocator\n";
+        }
         std::cout << "End Create Pipeline...\n";
     }
 
+    void FirstApp::createRenderSystems() {
+        const RenderTargetInfo renderTarget = getRenderTarget();
+        if (meshPool) {
+            sceneRenderSystem = std::make_unique<SceneRenderSystem>(
+                *lveDevice,
+                renderTarget,
+                lveSwapChain->getSwapChainExtent(),
+                config.sceneObjects,
+                LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+        }
+
+        if (config.chaosMillionPoints > 0) {
+            chaosRenderSystem = std::make_unique<ChaosRenderSystem>(
+                *lveDevice,
+                renderTarget,
+                lveSwapChain->getSwapChainExtent(),
+                uint64_t{config.chaosMillionPoints} * 1000000,
+                LveSwapChain::MAX_FRAMES_IN_FLIGHT,
+                bindlessHeap.get());
+            std::cout << "Chaos game: " << chaosRenderSystem->getPointsPerFrame() << " points per frame\n";
+        }
+
+        if (!config.texturePaths.empty()) {
+            if (!bindlessHeap) {
+                throw std::runtime_error("--texture needs descriptor indexing for the bindless heap");
+            }
+            textureStreamer = std::make_unique<LveTextureStreamer>(
+                *lveDevice,
+                jobSystem,
+                *bindlessHeap,
+                LveSwapChain::MAX_FRAMES_IN_FLIGHT,
+                VkDeviceSize{config.textureBudgetMb} << 20);
+            // Decoding starts here and overlaps the rest of startup
+            for (const auto &path : config.texturePaths) {
+                streamedTextures.push_back(textureStreamer->load(path));
+            }
+            textureRenderSystem = std::make_unique<TextureRenderSystem>(
+                *lveDevice,
+                renderTarget,
+                lveSwapChain->getSwapChainExtent(),
+                *bindlessHeap);
+        }
+    }
+
     void FirstApp::createCommandBuffers() {
         std::cout << "Creating Command Buffer...\n";
-        commandBuffers.resize(lveSwapChain.imageCount());
+        // Recorded every frame, so one per frame in flight rather than per swap chain image
+        commandBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
 
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = lveDevice.getCommandPool();
+        allocInfo.commandPool = lveDevice->getCommandPool();
         allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
 
-        if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+        if (vkAllocateCommandBuffers(lveDevice->device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
             throw std::runtime_error("Failed to allocate command buffers");
         }
+    }
+
+    void FirstApp::createRenderGraph() {
+        renderGraph = std::make_unique<LveRenderGraph>(*lveDevice, dynamicRendering);
+        const VkExtent2D extent = lveSwapChain->getSwapChainExtent();
 
-        for (int i = 0; i < commandBuffers.size(); i++) {
-            VkCommandBufferBeginInfo beginInfo{};
-            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        // The acquire semaphore is waited on at colour output, so the first transition chains after it
+        backbuffer = renderGraph->importImage(
+            "backbuffer",
+            {lveSwapChain->getSwapChainImageFormat(), extent},
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        auto depth = renderGraph->createImage("depth", {lveSwapChain->findDepthFormat(), extent});
+
+        if (gpuCuller) {
+            cullDrawBuffer = renderGraph->importBuffer("cull draws");
+            cullCountBuffer = renderGraph->importBuffer("cull count");
+            renderGraph->addComputePass("cull", [this](VkCommandBuffer commandBuffer) {
+                auto transform = camera.getTransform(fractal->getAnchor());
+                LveGpuCuller::CullParams cullParams{};
+                cullParams.scale = transform.scale;
+                cullParams.offset = transform.offset;
+                cullParams.viewportSize = {
+                    static_cast<float>(lveSwapChain->width()),
+                    static_cast<float>(lveSwapChain->height())};
+                gpuCuller->recordCull(commandBuffer, recordingFrameIndex, cullParams);
+            })
+                .writeBuffer(cullDrawBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT)
+                .writeBuffer(
+                    cullCountBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        }
 
-            if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to begin recording command buffer: " + i);
+        if (chaosRenderSystem) {
+            chaosHistogram = renderGraph->importBuffer("chaos histogram");
+            renderGraph->setImportedBuffer(chaosHistogram, chaosRenderSystem->getHistogramBuffer());
+            renderGraph->addComputePass("chaos accumulate", [this](VkCommandBuffer commandBuffer) {
+                chaosRenderSystem->recordAccumulate(commandBuffer, recordingFrameIndex, camera);
+            })
+                .writeBuffer(
+                    chaosHistogram,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        }
+
+        if (!config.dumpDirectory.empty()) {
+            if (!lveSwapChain->supportsTransferSource()) {
+                throw std::runtime_error("swap chain images cannot be copied from, so frames cannot be dumped");
             }
+            frameReadback = std::make_unique<LveFrameReadback>(
+                *lveDevice,
+                extent,
+                lveSwapChain->getSwapChainImageFormat(),
+                LveSwapChain::MAX_FRAMES_IN_FLIGHT,
+                config.dumpDirectory);
+        }
+
+        if (config.queryStats) {
+            queryStats = std::make_unique<LveQueryStats>(*lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+        }
+
+        auto mainPass = renderGraph->addGraphicsPass("main", [this](VkCommandBuffer commandBuffer) {
+            recordMainPass(commandBuffer, recordingFrameIndex);
+        });
+        mainPass.writeColor(backbuffer, VkClearColorValue{{0.1f, 0.1f, 0.1f, 1.0f}})
+            .writeDepth(depth, VkClearDepthStencilValue{1.0f, 0});
+        if (gpuCuller) {
+            mainPass.readBuffer(cullDrawBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+                .readBuffer(cullCountBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+        }
+        if (chaosRenderSystem) {
+            mainPass.readBuffer(chaosHistogram, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+
+        if (frameReadback) {
+            // Declared after the main pass so it copies the finished frame
+            renderGraph->addTransferPass("readback", [this](VkCommandBuffer commandBuffer) {
+                frameReadback->recordCopy(commandBuffer, recordingFrameIndex, recordingImage);
+            })
+                .copySource(backbuffer)
+                .sideEffect();
+        }
 
-            // Render Pass Init
-            VkRenderPassBeginInfo renderPassInfo{};
-            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassInfo.renderPass = lveSwapChain.getRenderPass();
-            renderPassInfo.framebuffer = lveSwapChain.getFrameBuffer(i);
+        renderGraph->compile();
+        renderGraph->printReport();
+    }
 
-            renderPassInfo.renderArea.offset = {0, 0};
-            renderPassInfo.renderArea.extent = lveSwapChain.getSwapChainExtent();
+    void FirstApp::recordMainPass(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+        auto transform = camera.getTransform(fractal ? fractal->getAnchor() : glm::dvec2{0.0, 0.0});
 
-            std::array<VkClearValue, 2> clearValues{};
-            clearValues[0].color = {0.1f, 0.1f, 0.1f, 1.0f};
-            clearValues[1].depthStencil = {1.0f, 0};
-            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-            renderPassInfo.pClearValues = clearValues.data();
+        if (queryStats) {
+            queryStats->begin(commandBuffer, frameIndex);
+        }
+        lvePipeline->bind(commandBuffer);
+        if (bindlessHeap) {
+            // Once for every draw below that uses pipelineLayout
+            bindlessHeap->bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout);
+        }
 
-            vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        VkViewport viewport{};
+        viewport.width = static_cast<float>(lveSwapChain->width());
+        viewport.height = static_cast<float>(lveSwapChain->height());
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        VkRect2D scissor{{0, 0}, lveSwapChain->getSwapChainExtent()};
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-            lvePipeline->bind(commandBuffers[i]);
-            lveModel->bind(commandBuffers[i]);
-            lveModel->draw(commandBuffers[i]);
+        if (lveModel->isProcedural()) {
+            // Same root triangle as LveFractal
+            ProceduralPushConstantData push{};
+            push.scale = transform.scale;
+            push.offset = transform.offset;
+            push.origin = {-1.0f, 1.0f};
+            push.length = 2.0f;
+            push.depth = lveModel->getProceduralDepth();
+            vkCmdPushConstants(
+                commandBuffer,
+                pipelineLayout,
+                VK_SHADER_STAGE_VERTEX_BIT,
+                0,
+                sizeof(ProceduralPushConstantData),
+                &push);
+            lveModel->draw(commandBuffer);
+        } else {
+            SimplePushConstantData push{};
+            push.scale = transform.scale;
+            push.offset = transform.offset;
+            vkCmdPushConstants(
+                commandBuffer,
+                pipelineLayout,
+                VK_SHADER_STAGE_VERTEX_BIT,
+                0,
+                sizeof(SimplePushConstantData),
+                &push);
 
-            vkCmdEndRenderPass(commandBuffers[i]);
-            if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to record command buffer");
+            if (gpuCuller) {
+                lveModel->bind(commandBuffer, frameIndex);
+                gpuCuller->recordDraw(commandBuffer, frameIndex);
+            } else {
+                // Imported model, drawn whole from its static buffers
+                lveModel->bind(commandBuffer);
+                lveModel->draw(commandBuffer);
             }
         }
+
+        if (sceneRenderSystem) {
+            sceneRenderSystem->render(commandBuffer, frameIndex, scene, *meshPool, camera);
+        }
+        if (chaosRenderSystem) {
+            chaosRenderSystem->render(commandBuffer);
+        }
+        if (textureRenderSystem) {
+            textureRenderSystem->render(commandBuffer, *textureStreamer, streamedTextures);
+        }
+        if (queryStats) {
+            queryStats->end(commandBuffer, frameIndex);
+        }
+    }
+
+    void FirstApp::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex) {
+        VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin recording command buffer");
+        }
+
+        recordingFrameIndex = frameIndex;
+        recordingImage = lveSwapChain->getImage(imageIndex);
+        renderGraph->setImportedImage(backbuffer, lveSwapChain->getImage(imageIndex), lveSwapChain->getImageView(imageIndex));
+        if (gpuCuller) {
+            renderGraph->setImportedBuffer(cullDrawBuffer, gpuCuller->getDrawBuffer(frameIndex));
+            renderGraph->setImportedBuffer(cullCountBuffer, gpuCuller->getCountBuffer(frameIndex));
+        }
+        if (queryStats) {
+            // Resets are not allowed inside the main pass's render pass instance
+            queryStats->recordReset(commandBuffer, frameIndex);
+        }
+        if (textureStreamer) {
+            // Uploads and mip blits are transfers, so they go ahead of the graph's render passes
+            textureStreamer->update(commandBuffer, frameIndex);
+        }
+        renderGraph->execute(commandBuffer);
+
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record command buffer");
+        }
     }
 
     void FirstApp::drawFrame() {
         uint32_t imageIndex;
-        auto result = lveSwapChain.acquireNextImage(&imageIndex);
+        auto result = lveSwapChain->acquireNextImage(&imageIndex);
 
         if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
             throw std::runtime_error("failed to aquire swap chain image");
         }
 
-        result = lveSwapChain.submitCommandBuffers(&commandBuffers[imageIndex], &imageIndex);
-    }
-
-    void FirstApp::seirpinskiSieve(float x, float y, float length, uint32_t iter, std::vector<LveModel::Vertex> &vertices) {
-        // Write triangle vertices when max level of recurision is reached;
-        if (iter == 8) {
-            vertices.push_back({{x, y}});
-            vertices.push_back({{x + length/2, y - glm::sin(M_PI/3) * length}});
-            vertices.push_back({{x + length, y}});
-        } else {
-            iter = iter + 1;
-            seirpinskiSieve(x, y, length/2, iter, vertices);
-            seirpinskiSieve(x + length/2, y, length/2, iter, vertices);
-            seirpinskiSieve(x + length/4, y - glm::sin(M_PI/3) * length/2, length/2, iter, vertices);
+        // acquireNextImage waited on this frame's fence, so its buffers are free to update
+        uint32_t frameIndex = static_cast<uint32_t>(lveSwapChain->getCurrentFrameIndex());
+        if (chaosRenderSystem) {
+            chaosRenderSystem->collectTimings(frameIndex);
+        }
+        if (frameReadback) {
+            frameReadback->collect(frameIndex);
         }
+        if (queryStats) {
+            queryStats->collect(frameIndex);
+        }
+        if (gpuCuller) {
+            lveModel->flush(frameIndex);
+            gpuCuller->flush(frameIndex);
+        }
+        recordCommandBuffer(frameIndex, imageIndex);
+
+        result = lveSwapChain->submitCommandBuffers(&commandBuffers[frameIndex], &imageIndex);
     }
-}
\ No newline at end of file
+}
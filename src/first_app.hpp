@@ -5,6 +5,23 @@
 #include "lve_device.hpp"
 #include "lve_swap_chain.hpp"
 #include "lve_model.hpp"
+#include "lve_gpu_culler.hpp"
+#include "lve_camera.hpp"
+#include "lve_camera_controller.hpp"
+#include "lve_fractal.hpp"
+#include "lve_config.hpp"
+#include "lve_mesh_pool.hpp"
+#include "lve_scene.hpp"
+#include "scene_render_system.hpp"
+#include "chaos_render_system.hpp"
+#include "texture_render_system.hpp"
+#include "lve_render_graph.hpp"
+#include "lve_frame_readback.hpp"
+#include "lve_bindless_heap.hpp"
+#include "lve_frame_limiter.hpp"
+#include "lve_query_stats.hpp"
+#include "lve_job_system.hpp"
+#include "lve_startup.hpp"
 
 // STD
 #include <memory>
@@ -15,8 +32,16 @@ namespace lve {
         public:
             static constexpr int WIDTH = 800;
             static constexpr int HEIGHT = 600;
+            // Upper bound on fractal triangles, independent of zoom depth
+            static constexpr uint32_t MAX_TRIANGLES = 1 << 16;
+            // Fractal triangles are subdivided until they are this small on screen
+            static constexpr float REFINE_PIXEL_SIZE = 2.0f;
+            // Longest step fed to the camera and scene, e.g. after an on-demand wait
+            static constexpr float MAX_FRAME_TIME = 0.1f;
+            // Chaos-game frames accumulated after a reset before on-demand drawing goes idle
+            static constexpr uint32_t CHAOS_SETTLE_FRAMES = 64;
 
-            FirstApp();
+            FirstApp(const LveAppConfig &config);
             ~FirstApp();
 
             FirstApp(const FirstApp &) = delete;
@@ -24,21 +49,80 @@ namespace lve {
 
             void run();
         private:
+            struct SimplePushConstantData {
+                glm::vec2 scale;
+                glm::vec2 offset;
+            };
+
+            // Matches the push block in sierpinski.vert
+            struct ProceduralPushConstantData {
+                glm::vec2 scale;
+                glm::vec2 offset;
+                glm::vec2 origin;
+                float length;
+                uint32_t depth;
+            };
+
+            void generateFractal();
             void loadModels();
+            void loadImportedModel();
+            void loadScene();
             void createPipelineLayout();
-            void createPipeline();
+            RenderTargetInfo getRenderTarget();
+            void createPipeline(const std::vector<char> &vertCode, const std::vector<char> &fragCode);
+            void createRenderSystems();
             void createCommandBuffers();
+            void createRenderGraph();
+            void recordMainPass(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+            void recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+            void updateFractal();
+            void uploadFractalChanges();
             void drawFrame();
 
-            // optional fun
-            void seirpinskiSieve(float x, float y, float length, uint32_t iter, std::vector<LveModel::Vertex> &vertices);
-
-            LveWindow lveWindow{WIDTH, HEIGHT, "Hello, Vulkan!"};
-            LveDevice lveDevice{lveWindow};
-            LveSwapChain lveSwapChain {lveDevice, lveWindow.getExtent()};
+            LveAppConfig config;
+            // Declared ahead of the members that hand it work, so it outlives them
+            LveJobSystem jobSystem;
+            LveStartupGraph::Clock::time_point startTime;
+            bool firstFrameSubmitted = false;
+            // Created by the startup graph in the constructor
+            std::unique_ptr<LveWindow> lveWindow;
+            std::unique_ptr<LveDevice> lveDevice;
+            std::unique_ptr<LveSwapChain> lveSwapChain;
+            // Resolved once the device exists: VK_KHR_dynamic_rendering unless --render-passes
+            bool dynamicRendering = false;
             std::unique_ptr<LvePipeline> lvePipeline;
-            VkPipelineLayout pipelineLayout;
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+            // Set 0 of pipelineLayout when descriptor indexing is available; outlives the render systems
+            std::unique_ptr<LveBindlessHeap> bindlessHeap;
             std::vector<VkCommandBuffer> commandBuffers;
+
+            LveCamera camera{};
+            LveCameraController cameraController{};
+            std::unique_ptr<LveFractal> fractal;
             std::unique_ptr<LveModel> lveModel;
+            std::unique_ptr<LveGpuCuller> gpuCuller;
+            std::vector<LveFractal::Span> dirtySpans;
+            std::vector<uint32_t> dirtyBlocks;
+
+            LveScene scene{};
+            std::unique_ptr<LveMeshPool> meshPool;
+            std::unique_ptr<SceneRenderSystem> sceneRenderSystem;
+            std::unique_ptr<ChaosRenderSystem> chaosRenderSystem;
+            // Only with --texture; registers its images in bindlessHeap
+            std::unique_ptr<LveTextureStreamer> textureStreamer;
+            std::vector<LveTextureStreamer::TextureId> streamedTextures;
+            std::unique_ptr<TextureRenderSystem> textureRenderSystem;
+
+            // Frame structure; pass callbacks read recordingFrameIndex/Image while the graph executes
+            std::unique_ptr<LveRenderGraph> renderGraph;
+            LveRenderGraph::ResourceId backbuffer;
+            LveRenderGraph::ResourceId cullDrawBuffer;
+            LveRenderGraph::ResourceId cullCountBuffer;
+            LveRenderGraph::ResourceId chaosHistogram;
+            uint32_t recordingFrameIndex = 0;
+            VkImage recordingImage = VK_NULL_HANDLE;
+
+            std::unique_ptr<LveFrameReadback> frameReadback;
+            std::unique_ptr<LveQueryStats> queryStats;
     };
-}
\ No newline at end of file
+}
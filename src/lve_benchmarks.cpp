@@ -0,0 +1,654 @@
+#include "lve_benchmarks.hpp"
+#include "lve_block_decoder.hpp"
+#include "lve_culling.hpp"
+#include "lve_device.hpp"
+#include "lve_job_system.hpp"
+#include "lve_ktx2.hpp"
+#include "lve_mapped_file.hpp"
+#include "lve_mesh_importer.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_scene.hpp"
+#include "lve_stripifier.hpp"
+#include "lve_window.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace lve {
+
+    // Average wall time of fn in milliseconds
+    static double timeMs(uint32_t iterations, const std::function<void()> &fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    }
+
+    // Triangle list over a size x size grid of quads, vertices in rows
+    static std::vector<uint32_t> makeGridIndices(uint32_t size) {
+        std::vector<uint32_t> indices;
+        indices.reserve(size * size * 6);
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                const uint32_t a = y * (size + 1) + x;
+                const uint32_t c = a + size + 1;
+                indices.insert(indices.end(), {a, a + 1, c + 1, a, c + 1, c});
+            }
+        }
+        return indices;
+    }
+
+    // Same triangles in random order, as a mesh exported without care might list them
+    static void shuffleTriangles(std::vector<uint32_t> &indices, uint32_t seed) {
+        std::vector<uint32_t> order(indices.size() / 3);
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937{seed});
+        std::vector<uint32_t> reordered;
+        reordered.reserve(indices.size());
+        for (uint32_t triangle : order) {
+            reordered.insert(reordered.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3);
+        }
+        indices.swap(reordered);
+    }
+
+    static void benchmarkScene() {
+        std::printf("%10s %12s %12s %12s %12s %14s\n",
+            "objects", "create ms", "update ms", "cull ms", "drawlist ms", "frame ns/obj");
+
+        for (uint32_t count : {10000u, 100000u, 1000000u}) {
+            std::mt19937 rng{42};
+            std::uniform_real_distribution<float> position{-10.0f, 10.0f};
+            std::uniform_real_distribution<float> velocity{-1.0f, 1.0f};
+
+            LveScene scene;
+            double createMs = timeMs(1, [&]() {
+                scene.reserve(count);
+                for (uint32_t i = 0; i < count; i++) {
+                    LveScene::ObjectDesc desc{};
+                    desc.position = {position(rng), position(rng)};
+                    desc.velocity = {velocity(rng), velocity(rng)};
+                    desc.angularVelocity = velocity(rng);
+                    desc.scale = 0.05f;
+                    desc.meshId = i % 8;
+                    scene.create(desc);
+                }
+            });
+            scene.setWorldBounds({-10.0f, -10.0f}, {10.0f, 10.0f});
+
+            std::vector<uint32_t> visible;
+            std::vector<LveScene::InstanceData> instances;
+            std::vector<LveScene::DrawBatch> batches;
+            const uint32_t iterations = std::max(5u, 20000000u / count);
+
+            double updateMs = timeMs(iterations, [&]() { scene.update(1.0f / 60.0f); });
+            double cullMs = timeMs(iterations, [&]() { scene.cull({-1.0f, -1.0f}, {1.0f, 1.0f}, visible); });
+            double drawListMs = timeMs(iterations, [&]() { scene.buildDrawList(visible, instances, batches); });
+
+            double nsPerObject = (updateMs + cullMs + drawListMs) * 1.0e6 / count;
+            std::printf("%10u %12.3f %12.3f %12.3f %12.3f %14.2f\n",
+                count, createMs, updateMs, cullMs, drawListMs, nsPerObject);
+        }
+    }
+
+    static void benchmarkCulling() {
+        const uint32_t count = 1000000;
+        std::mt19937 rng{7};
+        std::uniform_real_distribution<float> position{-4.0f, 4.0f};
+        std::uniform_real_distribution<float> extent{0.001f, 0.05f};
+
+        std::vector<float> minX(count), minY(count), minZ(count), maxX(count), maxY(count), maxZ(count);
+        std::vector<uint8_t> enabled(count);
+        for (uint32_t i = 0; i < count; i++) {
+            float x = position(rng), y = position(rng), z = position(rng), e = extent(rng);
+            minX[i] = x - e; maxX[i] = x + e;
+            minY[i] = y - e; maxY[i] = y + e;
+            minZ[i] = z - e; maxZ[i] = z + e;
+            enabled[i] = (i % 16) != 0;
+        }
+        std::vector<uint32_t> out(count);
+
+        // A view covering roughly a quarter of the objects
+        CullRect view{{-2.0f, -2.0f}, {2.0f, 2.0f}};
+        CullFrustum frustum{};
+        frustum.planes[0] = {1.0f, 0.0f, 0.0f, 2.0f};
+        frustum.planes[1] = {-1.0f, 0.0f, 0.0f, 2.0f};
+        frustum.planes[2] = {0.0f, 1.0f, 0.0f, 2.0f};
+        frustum.planes[3] = {0.0f, -1.0f, 0.0f, 2.0f};
+        frustum.planes[4] = {0.0f, 0.0f, 1.0f, 2.0f};
+        frustum.planes[5] = {0.0f, 0.0f, -1.0f, 2.0f};
+
+        std::printf("%u objects\n", count);
+        std::printf("%8s %10s %14s %10s %14s\n", "backend", "2D hits", "2D obj/us", "3D hits", "3D obj/us");
+        for (CullBackend backend : {CullBackend::Scalar, CullBackend::SSE2, CullBackend::AVX}) {
+            if (!isCullBackendSupported(backend)) {
+                std::printf("%8s %10s\n", cullBackendName(backend), "n/a");
+                continue;
+            }
+            uint32_t hits2D = 0, hits3D = 0;
+            double ms2D = timeMs(20, [&]() {
+                hits2D = cullRects(minX.data(), minY.data(), maxX.data(), maxY.data(),
+                    enabled.data(), count, view, out.data(), backend);
+            });
+            double ms3D = timeMs(20, [&]() {
+                hits3D = cullBoxes(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(),
+                    count, frustum, out.data(), backend);
+            });
+            std::printf("%8s %10u %14.1f %10u %14.1f\n",
+                cullBackendName(backend), hits2D, count / (ms2D * 1000.0), hits3D, count / (ms3D * 1000.0));
+        }
+    }
+
+    static void benchmarkJobs() {
+        // Empty jobs and a dependency chain measure pure scheduling cost; the sweep and the scene
+        // measure how compute-bound work scales with threads
+        const uint32_t jobCount = 200000;
+        const uint32_t chainLength = 10000;
+        const uint32_t itemCount = 1 << 22;
+        const uint32_t sceneCount = 1000000;
+
+        std::vector<float> items(itemCount, 1.0f);
+        LveScene scene;
+        std::mt19937 rng{42};
+        std::uniform_real_distribution<float> position{-10.0f, 10.0f};
+        std::uniform_real_distribution<float> velocity{-1.0f, 1.0f};
+        scene.reserve(sceneCount);
+        for (uint32_t i = 0; i < sceneCount; i++) {
+            LveScene::ObjectDesc desc{};
+            desc.position = {position(rng), position(rng)};
+            desc.velocity = {velocity(rng), velocity(rng)};
+            desc.scale = 0.05f;
+            scene.create(desc);
+        }
+        scene.setWorldBounds({-10.0f, -10.0f}, {10.0f, 10.0f});
+        std::vector<uint32_t> visible;
+
+        const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<uint32_t> threadCounts;
+        for (uint32_t threads = 1; threads < hardwareThreads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardwareThreads);
+
+        std::printf("%8s %12s %12s %10s %9s %10s %9s %9s\n",
+            "threads", "job ns", "chain ns", "sweep ms", "speedup", "scene ms", "speedup", "stolen %");
+        double serialSweepMs = 0.0;
+        double serialSceneMs = 0.0;
+        for (uint32_t threads : threadCounts) {
+            // The calling thread is the last one
+            LveJobSystem jobs{threads - 1};
+
+            double jobMs = timeMs(5, [&]() {
+                LveJobSystem::Counter counter;
+                for (uint32_t i = 0; i < jobCount; i++) {
+                    jobs.run([]() {}, &counter);
+                }
+                jobs.wait(counter);
+            });
+
+            auto links = std::make_unique<LveJobSystem::Counter[]>(chainLength);
+            double chainMs = timeMs(5, [&]() {
+                for (uint32_t i = 0; i < chainLength; i++) {
+                    jobs.run([]() {}, &links[i], i > 0 ? &links[i - 1] : nullptr);
+                }
+                jobs.wait(links[chainLength - 1]);
+            });
+
+            double sweepMs = timeMs(5, [&]() {
+                jobs.parallelFor(itemCount, 16384, [&](uint32_t begin, uint32_t end) {
+                    for (uint32_t i = begin; i < end; i++) {
+                        items[i] = std::sqrt(items[i] * 0.5f + std::sin(static_cast<float>(i)) * 0.25f + 1.0f);
+                    }
+                });
+            });
+
+            scene.setJobSystem(&jobs);
+            double sceneMs = timeMs(20, [&]() {
+                scene.update(1.0f / 60.0f);
+                scene.cull({-5.0f, -5.0f}, {5.0f, 5.0f}, visible);
+            });
+            scene.setJobSystem(nullptr);
+
+            if (threads == 1) {
+                serialSweepMs = sweepMs;
+                serialSceneMs = sceneMs;
+            }
+            auto stats = jobs.getStats();
+            std::printf("%8u %12.1f %12.1f %10.3f %9.2f %10.3f %9.2f %9.1f\n",
+                threads,
+                jobMs * 1.0e6 / jobCount,
+                chainMs * 1.0e6 / chainLength,
+                sweepMs,
+                serialSweepMs / sweepMs,
+                sceneMs,
+                serialSceneMs / sceneMs,
+                stats.executed ? 100.0 * stats.stolen / stats.executed : 0.0);
+        }
+    }
+
+    static void benchmarkStrips() {
+        std::printf("%12s %10s %12s %12s %9s %9s %12s\n",
+            "mesh", "triangles", "list idx", "strip idx", "strips", "ratio", "stripify ms");
+
+        for (uint32_t size : {16u, 256u, 1024u}) {
+            // Row order first, then random order
+            std::vector<uint32_t> list = makeGridIndices(size);
+            for (bool shuffled : {false, true}) {
+                if (shuffled) {
+                    shuffleTriangles(list, 3);
+                }
+
+                std::vector<uint32_t> strip;
+                double stripMs = timeMs(1, [&]() { strip = stripify(list); });
+                const uint32_t triangles = static_cast<uint32_t>(list.size() / 3);
+                if (countStripTriangles(strip) != triangles) {
+                    throw std::runtime_error("stripify lost triangles");
+                }
+                const auto strips = 1 + std::count(strip.begin(), strip.end(), PRIMITIVE_RESTART_INDEX);
+
+                char name[32];
+                std::snprintf(name, sizeof(name), "%ux%u%s", size, size, shuffled ? " rnd" : "");
+                std::printf("%12s %10u %12zu %12zu %9ld %9.2f %12.3f\n",
+                    name, triangles, list.size(), strip.size(), static_cast<long>(strips),
+                    static_cast<double>(list.size()) / strip.size(), stripMs);
+            }
+        }
+    }
+
+    static void benchmarkMeshOptimizer() {
+        struct Mesh {
+            const char *name;
+            std::vector<glm::vec3> positions;
+            std::vector<uint32_t> indices;
+        };
+        std::vector<Mesh> meshes;
+
+        const uint32_t gridSize = 256;
+        Mesh grid{"grid", {}, {}};
+        for (uint32_t y = 0; y <= gridSize; y++) {
+            for (uint32_t x = 0; x <= gridSize; x++) {
+                grid.positions.push_back({static_cast<float>(x), static_cast<float>(y), 0.0f});
+            }
+        }
+        grid.indices = makeGridIndices(gridSize);
+        meshes.push_back(grid);
+
+        // A closed surface, where the overdraw pass has something to sort
+        const uint32_t rings = 128, segments = 256;
+        Mesh sphere{"sphere", {}, {}};
+        for (uint32_t ring = 0; ring <= rings; ring++) {
+            for (uint32_t segment = 0; segment <= segments; segment++) {
+                const float theta = static_cast<float>(M_PI) * ring / rings;
+                const float phi = 2.0f * static_cast<float>(M_PI) * segment / segments;
+                sphere.positions.push_back(
+                    {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)});
+            }
+        }
+        for (uint32_t ring = 0; ring < rings; ring++) {
+            for (uint32_t segment = 0; segment < segments; segment++) {
+                const uint32_t a = ring * (segments + 1) + segment;
+                const uint32_t c = a + segments + 1;
+                sphere.indices.insert(sphere.indices.end(), {a, c, a + 1, a + 1, c, c + 1});
+            }
+        }
+        meshes.push_back(sphere);
+
+        std::printf("%12s %10s %15s %15s %9s %12s\n",
+            "mesh", "triangles", "ACMR", "ATVR", "clusters", "optimize ms");
+        for (auto &mesh : meshes) {
+            for (bool shuffled : {false, true}) {
+                std::vector<uint32_t> indices = mesh.indices;
+                if (shuffled) {
+                    shuffleTriangles(indices, 11);
+                }
+                std::vector<glm::vec3> positions = mesh.positions;
+                MeshOptimizeReport report{};
+                double optimizeMs = timeMs(1, [&]() { report = optimizeMesh(positions, indices, mesh.positions); });
+
+                char name[32];
+                std::snprintf(name, sizeof(name), "%s%s", mesh.name, shuffled ? " rnd" : "");
+                std::printf("%12s %10zu %6.3f -> %5.3f %6.3f -> %5.3f %9u %12.3f\n",
+                    name, indices.size() / 3,
+                    report.before.acmr, report.after.acmr,
+                    report.before.atvr, report.after.atvr,
+                    report.clusterCount, optimizeMs);
+            }
+        }
+    }
+
+    // Writes a size x size grid of quads as OBJ text and as glTF binary, about 80 and 36 bytes
+    // per quad
+    static void writeImportFiles(uint32_t size, const std::string &objPath, const std::string &glbPath) {
+        std::vector<float> positions;
+        positions.reserve(static_cast<size_t>(size + 1) * (size + 1) * 3);
+        for (uint32_t y = 0; y <= size; y++) {
+            for (uint32_t x = 0; x <= size; x++) {
+                const float u = static_cast<float>(x) / size;
+                const float v = static_cast<float>(y) / size;
+                positions.insert(positions.end(), {u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.1f * std::sin(12.0f * u) * std::cos(9.0f * v)});
+            }
+        }
+        std::vector<uint32_t> indices = makeGridIndices(size);
+
+        std::FILE *obj = std::fopen(objPath.c_str(), "wb");
+        if (!obj) {
+            throw std::runtime_error("failed to create " + objPath);
+        }
+        std::string text;
+        text.reserve(1 << 20);
+        char line[96];
+        auto append = [&](int length) {
+            text.append(line, static_cast<size_t>(length));
+            if (text.size() >= (1 << 20) - sizeof(line)) {
+                std::fwrite(text.data(), 1, text.size(), obj);
+                text.clear();
+            }
+        };
+        append(std::snprintf(line, sizeof(line), "# %u x %u grid\n", size, size));
+        for (size_t i = 0; i < positions.size(); i += 3) {
+            append(std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", positions[i], positions[i + 1], positions[i + 2]));
+        }
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            append(std::snprintf(line, sizeof(line), "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1));
+        }
+        std::fwrite(text.data(), 1, text.size(), obj);
+        std::fclose(obj);
+
+        const uint32_t positionBytes = static_cast<uint32_t>(positions.size() * sizeof(float));
+        const uint32_t indexBytes = static_cast<uint32_t>(indices.size() * sizeof(uint32_t));
+        std::string json = "{\"asset\":{\"version\":\"2.0\"},"
+            "\"buffers\":[{\"byteLength\":" + std::to_string(positionBytes + indexBytes) + "}],"
+            "\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(positionBytes) + "},"
+            "{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes) +
+            ",\"byteLength\":" + std::to_string(indexBytes) + "}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" +
+            std::to_string(positions.size() / 3) + ",\"type\":\"VEC3\"},"
+            "{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(indices.size()) +
+            ",\"type\":\"SCALAR\"}],"
+            "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}]}";
+        json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+        std::FILE *glb = std::fopen(glbPath.c_str(), "wb");
+        if (!glb) {
+            throw std::runtime_error("failed to create " + glbPath);
+        }
+        const uint32_t jsonBytes = static_cast<uint32_t>(json.size());
+        const uint32_t header[] = {
+            0x46546C67, 2, 12 + 8 + jsonBytes + 8 + positionBytes + indexBytes, jsonBytes, 0x4E4F534A};
+        std::fwrite(header, sizeof(header), 1, glb);
+        std::fwrite(json.data(), 1, json.size(), glb);
+        const uint32_t binHeader[] = {positionBytes + indexBytes, 0x004E4942};
+        std::fwrite(binHeader, sizeof(binHeader), 1, glb);
+        std::fwrite(positions.data(), 1, positionBytes, glb);
+        std::fwrite(indices.data(), 1, indexBytes, glb);
+        std::fclose(glb);
+    }
+
+    // With no arguments, imports a generated OBJ of about 200 MB and the same mesh as .glb;
+    // otherwise the given files
+    static void benchmarkImport(const std::vector<std::string> &args) {
+        std::vector<std::string> paths = args;
+        std::vector<std::string> generated;
+        if (paths.empty()) {
+            auto directory = std::filesystem::temp_directory_path();
+            generated = {(directory / "lve_import_bench.obj").string(), (directory / "lve_import_bench.glb").string()};
+            std::printf("writing %s and %s...\n", generated[0].c_str(), generated[1].c_str());
+            writeImportFiles(1600, generated[0], generated[1]);
+            paths = generated;
+        }
+
+        const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<uint32_t> threadCounts{1};
+        if (hardwareThreads > 1) {
+            threadCounts.push_back(hardwareThreads);
+        }
+
+        std::printf("%-28s %10s %8s %10s %10s %12s\n", "file", "MB", "threads", "ms", "MB/s", "triangles");
+        for (const auto &path : paths) {
+            double megabytes = static_cast<double>(LveMappedFile{path}.size()) / (1024.0 * 1024.0);
+            for (uint32_t threads : threadCounts) {
+                LveJobSystem jobs{threads - 1};
+                LveMeshImporter importer{jobs};
+                size_t triangles = 0;
+                // The first pass also pulls the file into the page cache
+                importer.load(path);
+                double importMs = timeMs(3, [&]() { triangles = importer.load(path).indices.size() / 3; });
+                std::printf("%-28s %10.1f %8u %10.1f %10.1f %12zu\n",
+                    std::filesystem::path{path}.filename().string().c_str(),
+                    megabytes, threads, importMs, megabytes * 1000.0 / importMs, triangles);
+            }
+        }
+
+        for (const auto &path : generated) {
+            std::remove(path.c_str());
+        }
+    }
+
+    // Full mip chain of random blocks; enough to measure sizes and throughput, not to look at
+    static LveKtx2Image makeRandomKtx2(VkFormat format, uint32_t size, std::mt19937 &random) {
+        LveKtx2Image image{};
+        image.format = format;
+        image.width = size;
+        image.height = size;
+        for (uint32_t level = 0; size >> level; level++) {
+            std::vector<uint8_t> bytes(getLevelBytes(format, size >> level, size >> level));
+            for (auto &byte : bytes) {
+                byte = static_cast<uint8_t>(random());
+            }
+            image.levels.push_back(std::move(bytes));
+        }
+        return image;
+    }
+
+    // Creates a sampled image with every level, copies them in from a staging buffer and waits.
+    // Returns the image's memory size and the average upload time.
+    static void measureUpload(
+        LveDevice &device,
+        VkFormat format,
+        uint32_t width,
+        uint32_t height,
+        const std::vector<std::vector<uint8_t>> &levels,
+        VkDeviceSize &imageBytes,
+        double &uploadMs) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = {width, height, 1};
+        imageInfo.mipLevels = static_cast<uint32_t>(levels.size());
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImage image;
+        VkDeviceMemory imageMemory;
+        device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device.device(), image, &requirements);
+        imageBytes = requirements.size;
+
+        // Each level starts on a whole block and a multiple of 4
+        std::vector<VkBufferImageCopy> regions(levels.size());
+        VkDeviceSize stagingBytes = 0;
+        for (uint32_t level = 0; level < levels.size(); level++) {
+            stagingBytes = (stagingBytes + 15) & ~VkDeviceSize{15};
+            regions[level].bufferOffset = stagingBytes;
+            regions[level].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            regions[level].imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+            stagingBytes += levels[level].size();
+        }
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingMemory;
+        device.createBuffer(
+            stagingBytes,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer,
+            stagingMemory);
+        void *mapped = nullptr;
+        vkMapMemory(device.device(), stagingMemory, 0, stagingBytes, 0, &mapped);
+
+        uploadMs = timeMs(3, [&]() {
+            for (uint32_t level = 0; level < levels.size(); level++) {
+                std::memcpy(
+                    static_cast<uint8_t *>(mapped) + regions[level].bufferOffset,
+                    levels[level].data(),
+                    levels[level].size());
+            }
+            VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = image;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, imageInfo.mipLevels, 0, 1};
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0,
+                nullptr,
+                0,
+                nullptr,
+                1,
+                &barrier);
+            vkCmdCopyBufferToImage(
+                commandBuffer,
+                stagingBuffer,
+                image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<uint32_t>(regions.size()),
+                regions.data());
+            device.endSingleTimeCommands(commandBuffer);
+        });
+
+        vkUnmapMemory(device.device(), stagingMemory);
+        vkDestroyBuffer(device.device(), stagingBuffer, device.getAllocator());
+        vkFreeMemory(device.device(), stagingMemory, device.getAllocator());
+        vkDestroyImage(device.device(), image, device.getAllocator());
+        vkFreeMemory(device.device(), imageMemory, device.getAllocator());
+    }
+
+    // Compares each KTX2 texture uploaded as stored, where the device samples its format, with
+    // the same texture transcoded to RGBA8 on the CPU. With no arguments, uses generated 2048 x
+    // 2048 textures in the common block formats and an RGBA8 baseline.
+    static void benchmarkKtx2(const LveAppConfig &config) {
+        std::vector<std::pair<std::string, LveKtx2Image>> inputs;
+        if (config.benchmarkArgs.empty()) {
+            std::mt19937 random{7};
+            const std::pair<const char *, VkFormat> formats[] = {
+                {"BC1", VK_FORMAT_BC1_RGB_SRGB_BLOCK},
+                {"BC3", VK_FORMAT_BC3_SRGB_BLOCK},
+                {"BC7", VK_FORMAT_BC7_SRGB_BLOCK},
+                {"ETC2 RGB8", VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK},
+                {"ASTC 4x4", VK_FORMAT_ASTC_4x4_SRGB_BLOCK},
+                {"ASTC 8x8", VK_FORMAT_ASTC_8x8_SRGB_BLOCK},
+                {"RGBA8", VK_FORMAT_R8G8B8A8_SRGB},
+            };
+            for (const auto &format : formats) {
+                inputs.emplace_back(format.first, makeRandomKtx2(format.second, 2048, random));
+            }
+        } else {
+            for (const auto &path : config.benchmarkArgs) {
+                inputs.emplace_back(std::filesystem::path{path}.filename().string(), loadKtx2(path));
+            }
+        }
+
+        // Offscreen only; the window just provides a surface for device selection
+        LveWindow window{320, 240, "lve ktx2 benchmark"};
+        LveDevice device{window, config.device};
+        LveJobSystem jobs{std::max(1u, std::thread::hardware_concurrency()) - 1};
+        const VkFormatFeatureFlags sampled =
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+        std::printf("%-24s %-10s %8s %10s %14s %10s %10s\n",
+            "texture", "path", "levels", "image MB", "transcode ms", "upload ms", "MB/s");
+        for (const auto &input : inputs) {
+            const std::string &name = input.first;
+            const LveKtx2Image &image = input.second;
+            const uint32_t levelCount = static_cast<uint32_t>(image.levels.size());
+            const bool rgba8 = image.format == VK_FORMAT_R8G8B8A8_UNORM || image.format == VK_FORMAT_R8G8B8A8_SRGB;
+            bool measured = false;
+            auto report = [&](const char *path, const std::vector<std::vector<uint8_t>> &levels, VkFormat format, double transcodeMs) {
+                VkDeviceSize imageBytes = 0;
+                double uploadMs = 0.0;
+                measureUpload(device, format, image.width, image.height, levels, imageBytes, uploadMs);
+                size_t uploadBytes = 0;
+                for (const auto &level : levels) {
+                    uploadBytes += level.size();
+                }
+                char transcode[16] = "-";
+                if (transcodeMs > 0.0) {
+                    std::snprintf(transcode, sizeof(transcode), "%.1f", transcodeMs);
+                }
+                std::printf("%-24s %-10s %8u %10.1f %14s %10.1f %10.1f\n",
+                    name.c_str(), path, levelCount, imageBytes / 1048576.0, transcode, uploadMs,
+                    uploadBytes / 1048576.0 * 1000.0 / uploadMs);
+                measured = true;
+            };
+
+            if (device.supportsFormat(image.format, VK_IMAGE_TILING_OPTIMAL, sampled)) {
+                report(rgba8 ? "rgba8" : "direct", image.levels, image.format, 0.0);
+            }
+            if (!rgba8 && canDecodeBlocks(image.format)) {
+                std::vector<std::vector<uint8_t>> transcoded(levelCount);
+                const double transcodeMs = timeMs(1, [&]() {
+                    for (uint32_t level = 0; level < levelCount; level++) {
+                        transcoded[level] = decodeBlocks(
+                            image.format,
+                            image.levels[level].data(),
+                            std::max(image.width >> level, 1u),
+                            std::max(image.height >> level, 1u),
+                            jobs).rgba;
+                    }
+                });
+                const VkFormat format = isSrgbFormat(image.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+                report("transcoded", transcoded, format, transcodeMs);
+            }
+            if (!measured) {
+                std::printf("%-24s %-10s\n", name.c_str(), "unsupported");
+            }
+        }
+    }
+
+    void runBenchmark(const LveAppConfig &config) {
+        if (config.benchmark == "scene") {
+            benchmarkScene();
+        } else if (config.benchmark == "cull") {
+            benchmarkCulling();
+        } else if (config.benchmark == "jobs") {
+            benchmarkJobs();
+        } else if (config.benchmark == "strip") {
+            benchmarkStrips();
+        } else if (config.benchmark == "mesh") {
+            benchmarkMeshOptimizer();
+        } else if (config.benchmark == "import") {
+            benchmarkImport(config.benchmarkArgs);
+        } else if (config.benchmark == "ktx2") {
+            benchmarkKtx2(config);
+        } else {
+            throw std::runtime_error("unknown benchmark: " + config.benchmark);
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "lve_config.hpp"
+
+namespace lve {
+    // Runs config.benchmark and prints its results; throws on unknown names
+    void runBenchmark(const LveAppConfig &config);
+}
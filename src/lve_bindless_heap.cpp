@@ -0,0 +1,168 @@
+#include "lve_bindless_heap.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+namespace lve {
+
+    LveBindlessHeap::LveBindlessHeap(LveDevice &device, uint32_t maxBuffers, uint32_t maxImages)
+        : lveDevice{device},
+          bufferSlots{std::make_shared<Slots>()},
+          imageSlots{std::make_shared<Slots>()} {
+        if (!lveDevice.supportsDescriptorIndexing()) {
+            throw std::runtime_error("bindless heap needs VK_EXT_descriptor_indexing");
+        }
+
+        // Every stage sees the whole set, so the per-stage limits apply as well as the set limits
+        const auto &limits = lveDevice.getDescriptorIndexingProperties();
+        bufferCapacity = std::min({
+            maxBuffers,
+            limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+            limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+        imageCapacity = std::min({
+            maxImages,
+            limits.maxDescriptorSetUpdateAfterBindSampledImages,
+            limits.maxDescriptorSetUpdateAfterBindSamplers,
+            limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            limits.maxPerStageDescriptorUpdateAfterBindSamplers});
+        const uint32_t resources = limits.maxPerStageUpdateAfterBindResources;
+        if (uint64_t{bufferCapacity} + imageCapacity > resources) {
+            bufferCapacity = std::min(bufferCapacity, resources / 2);
+            imageCapacity = std::min(imageCapacity, resources - bufferCapacity);
+        }
+        bufferSlots->capacity = bufferCapacity;
+        imageSlots->capacity = imageCapacity;
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding = BUFFER_BINDING;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[0].descriptorCount = bufferCapacity;
+        bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+        bindings[1].binding = IMAGE_BINDING;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[1].descriptorCount = imageCapacity;
+        bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+
+        // Unregistered slots stay unwritten, and registering never touches a slot a pending frame reads
+        const VkDescriptorBindingFlagsEXT flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                  VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                  VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags{flags, flags};
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext = &bindingFlagsInfo;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if (vkCreateDescriptorSetLayout(lveDevice.device(), &layoutInfo, lveDevice.getAllocator(), &setLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless descriptor set layout");
+        }
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[0].descriptorCount = bufferCapacity;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[1].descriptorCount = imageCapacity;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        if (vkCreateDescriptorPool(lveDevice.device(), &poolInfo, lveDevice.getAllocator(), &descriptorPool) != VK_SUCCESS) {
+            vkDestroyDescriptorSetLayout(lveDevice.device(), setLayout, lveDevice.getAllocator());
+            throw std::runtime_error("Failed to create bindless descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &setLayout;
+
+        if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+            vkDestroyDescriptorPool(lveDevice.device(), descriptorPool, lveDevice.getAllocator());
+            vkDestroyDescriptorSetLayout(lveDevice.device(), setLayout, lveDevice.getAllocator());
+            throw std::runtime_error("Failed to allocate bindless descriptor set");
+        }
+    }
+
+    LveBindlessHeap::~LveBindlessHeap() {
+        vkDestroyDescriptorPool(lveDevice.device(), descriptorPool, lveDevice.getAllocator());
+        vkDestroyDescriptorSetLayout(lveDevice.device(), setLayout, lveDevice.getAllocator());
+    }
+
+    uint32_t LveBindlessHeap::allocate(Slots &slots, const char *kind) {
+        std::lock_guard<std::mutex> lock{slots.mutex};
+        if (!slots.freed.empty()) {
+            uint32_t index = slots.freed.back();
+            slots.freed.pop_back();
+            return index;
+        }
+        if (slots.next == slots.capacity) {
+            throw std::runtime_error(
+                std::string{"bindless heap is out of "} + kind + " slots (" + std::to_string(slots.capacity) + ")");
+        }
+        return slots.next++;
+    }
+
+    void LveBindlessHeap::release(const std::shared_ptr<Slots> &slots, uint32_t index) {
+        assert(index < slots->capacity && "Bindless index out of range");
+        lveDevice.deferDestroy([slots, index]() {
+            std::lock_guard<std::mutex> lock{slots->mutex};
+            slots->freed.push_back(index);
+        });
+    }
+
+    uint32_t LveBindlessHeap::registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        const uint32_t index = allocate(*bufferSlots, "buffer");
+
+        VkDescriptorBufferInfo bufferInfo{buffer, offset, range};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = descriptorSet;
+        write.dstBinding = BUFFER_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &bufferInfo;
+        vkUpdateDescriptorSets(lveDevice.device(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    uint32_t LveBindlessHeap::registerImage(VkImageView imageView, VkSampler sampler, VkImageLayout layout) {
+        const uint32_t index = allocate(*imageSlots, "image");
+
+        VkDescriptorImageInfo imageInfo{sampler, imageView, layout};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = descriptorSet;
+        write.dstBinding = IMAGE_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+        vkUpdateDescriptorSets(lveDevice.device(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    void LveBindlessHeap::releaseBuffer(uint32_t index) { release(bufferSlots, index); }
+
+    void LveBindlessHeap::releaseImage(uint32_t index) { release(imageSlots, index); }
+
+    void LveBindlessHeap::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const {
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+    // One descriptor set holding every storage buffer and sampled image the renderer uses, as
+    // partially bound, update-after-bind arrays. Resources register once and keep their index,
+    // which shaders read from a push constant, so the set is bound once per pipeline layout per
+    // command buffer instead of once per draw. Needs LveDevice::supportsDescriptorIndexing().
+    //
+    // Shaders declare the arrays at set 0 (with GL_EXT_nonuniform_qualifier):
+    //     layout(set = 0, binding = 0) buffer Buffers { ... } buffers[];
+    //     layout(set = 0, binding = 1) uniform sampler2D images[];
+    class LveBindlessHeap {
+        public:
+            static constexpr uint32_t BUFFER_BINDING = 0;
+            static constexpr uint32_t IMAGE_BINDING = 1;
+            // Requested capacities, lowered to what the device allows
+            static constexpr uint32_t MAX_BUFFERS = 1 << 16;
+            static constexpr uint32_t MAX_IMAGES = 1 << 16;
+
+            LveBindlessHeap(LveDevice &device, uint32_t maxBuffers = MAX_BUFFERS, uint32_t maxImages = MAX_IMAGES);
+            ~LveBindlessHeap();
+
+            LveBindlessHeap(const LveBindlessHeap &) = delete;
+            LveBindlessHeap &operator=(const LveBindlessHeap &) = delete;
+
+            // Writes the descriptor and returns its index. Safe while the set is bound in
+            // recording or pending command buffers, as the slot is unused by them.
+            uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+            uint32_t registerImage(
+                VkImageView imageView,
+                VkSampler sampler,
+                VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            // The index is handed out again only after the frames that may read it have completed
+            void releaseBuffer(uint32_t index);
+            void releaseImage(uint32_t index);
+
+            VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+            VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+            uint32_t getBufferCapacity() const { return bufferCapacity; }
+            uint32_t getImageCapacity() const { return imageCapacity; }
+
+            // pipelineLayout must have getSetLayout() at set 0
+            void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const;
+
+        private:
+            // Indices never handed out sit above next; released ones return to freed. Shared
+            // with deferred deleters, which may run after the heap is gone.
+            struct Slots {
+                std::mutex mutex;
+                uint32_t capacity = 0;
+                uint32_t next = 0;
+                std::vector<uint32_t> freed;
+            };
+
+            uint32_t allocate(Slots &slots, const char *kind);
+            void release(const std::shared_ptr<Slots> &slots, uint32_t index);
+
+            LveDevice &lveDevice;
+            uint32_t bufferCapacity;
+            uint32_t imageCapacity;
+            VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+            VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            std::shared_ptr<Slots> bufferSlots;
+            std::shared_ptr<Slots> imageSlots;
+    };
+}
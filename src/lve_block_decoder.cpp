@@ -0,0 +1,635 @@
+#include "lve_block_decoder.hpp"
+
+#include "lve_ktx2.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace lve {
+
+    namespace {
+        // One decoded 4x4 block, row by row
+        using Texels = uint8_t[16][4];
+
+        // Replicates the top bits into the low ones, so 0 and the maximum map to 0 and 255
+        uint8_t expandBits(uint32_t value, uint32_t bits) {
+            value <<= 8 - bits;
+            return static_cast<uint8_t>(value | (value >> bits));
+        }
+
+        uint8_t clampByte(int value) { return static_cast<uint8_t>(std::clamp(value, 0, 255)); }
+
+        uint32_t readLittleEndian32(const uint8_t *bytes) {
+            return uint32_t{bytes[0]} | (uint32_t{bytes[1]} << 8) | (uint32_t{bytes[2]} << 16) | (uint32_t{bytes[3]} << 24);
+        }
+
+        uint64_t readLittleEndian64(const uint8_t *bytes) {
+            return uint64_t{readLittleEndian32(bytes)} | (uint64_t{readLittleEndian32(bytes + 4)} << 32);
+        }
+
+        uint64_t readBigEndian64(const uint8_t *bytes) {
+            uint64_t value = 0;
+            for (int i = 0; i < 8; i++) {
+                value = (value << 8) | bytes[i];
+            }
+            return value;
+        }
+
+        // BC1 colour endpoints and indices; BC2 and BC3 always use the four-colour palette
+        void decodeBc1Colors(const uint8_t *block, bool fourColors, bool transparentBlack, Texels &out) {
+            const uint32_t color0 = block[0] | (uint32_t{block[1]} << 8);
+            const uint32_t color1 = block[2] | (uint32_t{block[3]} << 8);
+            const uint32_t indices = readLittleEndian32(block + 4);
+
+            int palette[4][4];
+            for (int i = 0; i < 2; i++) {
+                const uint32_t color = i == 0 ? color0 : color1;
+                palette[i][0] = expandBits(color >> 11, 5);
+                palette[i][1] = expandBits((color >> 5) & 63, 6);
+                palette[i][2] = expandBits(color & 31, 5);
+                palette[i][3] = 255;
+            }
+            for (int c = 0; c < 3; c++) {
+                if (fourColors || color0 > color1) {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                } else {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+            palette[2][3] = 255;
+            palette[3][3] = !fourColors && color0 <= color1 && transparentBlack ? 0 : 255;
+
+            for (int i = 0; i < 16; i++) {
+                const int *color = palette[(indices >> (2 * i)) & 3];
+                for (int c = 0; c < 4; c++) {
+                    out[i][c] = static_cast<uint8_t>(color[c]);
+                }
+            }
+        }
+
+        // BC3 alpha, BC4 and BC5: two endpoints and 3-bit indices into six or eight values
+        void decodeBc4Channel(const uint8_t *block, int channel, Texels &out) {
+            const int value0 = block[0];
+            const int value1 = block[1];
+            int values[8] = {value0, value1};
+            if (value0 > value1) {
+                for (int i = 2; i < 8; i++) {
+                    values[i] = ((8 - i) * value0 + (i - 1) * value1 + 3) / 7;
+                }
+            } else {
+                for (int i = 2; i < 6; i++) {
+                    values[i] = ((6 - i) * value0 + (i - 1) * value1 + 2) / 5;
+                }
+                values[6] = 0;
+                values[7] = 255;
+            }
+            const uint64_t indices = readLittleEndian64(block) >> 16;
+            for (int i = 0; i < 16; i++) {
+                out[i][channel] = static_cast<uint8_t>(values[(indices >> (3 * i)) & 7]);
+            }
+        }
+
+        // BC7: modes 0-7 as in the Khronos Data Format Specification
+        struct Bc7Mode {
+            uint8_t subsets;
+            uint8_t partitionBits;
+            uint8_t rotationBits;
+            uint8_t indexSelectionBits;
+            uint8_t colorBits;
+            uint8_t alphaBits;
+            // One p-bit per endpoint, or one shared by both endpoints of a subset
+            uint8_t endpointPBits;
+            uint8_t sharedPBits;
+            uint8_t indexBits;
+            uint8_t secondaryIndexBits;
+        };
+
+        const Bc7Mode BC7_MODES[8] = {
+            {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+            {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+            {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+            {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+            {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+            {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+            {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+            {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+        };
+
+        // Bit i is the subset of texel i
+        const uint16_t BC7_PARTITIONS_2[64] = {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+            0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+            0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+            0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+            0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+            0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+            0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+            0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+        };
+
+        // Bits 2i and 2i + 1 are the subset of texel i
+        const uint32_t BC7_PARTITIONS_3[64] = {
+            0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+            0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+            0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+            0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+            0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+            0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+            0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+            0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+        };
+
+        // Texel whose index drops its top bit, for every subset but the first (always texel 0)
+        const uint8_t BC7_ANCHORS_2[64] = {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+            15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+            6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+        };
+        const uint8_t BC7_ANCHORS_3_SECOND[64] = {
+            3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+            3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+            8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+            3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+        };
+        const uint8_t BC7_ANCHORS_3_THIRD[64] = {
+            15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+            15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+            15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+            15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+        };
+
+        const uint8_t BC7_WEIGHTS_2[4] = {0, 21, 43, 64};
+        const uint8_t BC7_WEIGHTS_3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+        const uint8_t BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        // Reads the 128-bit block from its least significant bit up
+        class BitReader {
+            public:
+                explicit BitReader(const uint8_t *block)
+                    : low{readLittleEndian64(block)}, high{readLittleEndian64(block + 8)} {}
+
+                uint32_t read(uint32_t count) {
+                    if (count == 0) {
+                        return 0;
+                    }
+                    const uint32_t value = static_cast<uint32_t>(low & ((uint64_t{1} << count) - 1));
+                    low = (low >> count) | (high << (64 - count));
+                    high >>= count;
+                    return value;
+                }
+
+            private:
+                uint64_t low;
+                uint64_t high;
+        };
+
+        uint8_t interpolateBc7(uint8_t endpoint0, uint8_t endpoint1, uint32_t index, uint32_t indexBits) {
+            const uint8_t *weights = indexBits == 2 ? BC7_WEIGHTS_2 : indexBits == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4;
+            const uint32_t weight = weights[index];
+            return static_cast<uint8_t>(((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6);
+        }
+
+        void decodeBc7(const uint8_t *block, Texels &out) {
+            BitReader reader{block};
+            uint32_t modeIndex = 0;
+            while (modeIndex < 8 && reader.read(1) == 0) {
+                modeIndex++;
+            }
+            if (modeIndex == 8) {
+                // Reserved mode
+                std::memset(out, 0, sizeof(Texels));
+                return;
+            }
+            const Bc7Mode &mode = BC7_MODES[modeIndex];
+            const uint32_t partition = reader.read(mode.partitionBits);
+            const uint32_t rotation = reader.read(mode.rotationBits);
+            const uint32_t indexSelection = reader.read(mode.indexSelectionBits);
+
+            // [subset][endpoint][channel]
+            uint8_t endpoints[3][2][4] = {};
+            for (int c = 0; c < 3; c++) {
+                for (int s = 0; s < mode.subsets; s++) {
+                    endpoints[s][0][c] = static_cast<uint8_t>(reader.read(mode.colorBits));
+                    endpoints[s][1][c] = static_cast<uint8_t>(reader.read(mode.colorBits));
+                }
+            }
+            if (mode.alphaBits > 0) {
+                for (int s = 0; s < mode.subsets; s++) {
+                    endpoints[s][0][3] = static_cast<uint8_t>(reader.read(mode.alphaBits));
+                    endpoints[s][1][3] = static_cast<uint8_t>(reader.read(mode.alphaBits));
+                }
+            }
+
+            const int channels = mode.alphaBits > 0 ? 4 : 3;
+            const bool hasPBits = mode.endpointPBits || mode.sharedPBits;
+            for (int s = 0; s < mode.subsets && hasPBits; s++) {
+                const uint32_t shared = mode.sharedPBits ? reader.read(1) : 0;
+                for (int e = 0; e < 2; e++) {
+                    const uint32_t pBit = mode.endpointPBits ? reader.read(1) : shared;
+                    for (int c = 0; c < channels; c++) {
+                        endpoints[s][e][c] = static_cast<uint8_t>((endpoints[s][e][c] << 1) | pBit);
+                    }
+                }
+            }
+            for (int s = 0; s < mode.subsets; s++) {
+                for (int e = 0; e < 2; e++) {
+                    for (int c = 0; c < 3; c++) {
+                        endpoints[s][e][c] = expandBits(endpoints[s][e][c], mode.colorBits + (hasPBits ? 1 : 0));
+                    }
+                    endpoints[s][e][3] = mode.alphaBits > 0
+                        ? expandBits(endpoints[s][e][3], mode.alphaBits + (hasPBits ? 1 : 0))
+                        : 255;
+                }
+            }
+
+            auto subsetOf = [&](uint32_t texel) -> uint32_t {
+                if (mode.subsets == 2) {
+                    return (BC7_PARTITIONS_2[partition] >> texel) & 1;
+                }
+                if (mode.subsets == 3) {
+                    return (BC7_PARTITIONS_3[partition] >> (2 * texel)) & 3;
+                }
+                return 0;
+            };
+            auto isAnchor = [&](uint32_t texel) {
+                if (texel == 0) {
+                    return true;
+                }
+                if (mode.subsets == 2) {
+                    return texel == BC7_ANCHORS_2[partition];
+                }
+                if (mode.subsets == 3) {
+                    return texel == BC7_ANCHORS_3_SECOND[partition] || texel == BC7_ANCHORS_3_THIRD[partition];
+                }
+                return false;
+            };
+
+            uint32_t primary[16];
+            uint32_t secondary[16] = {};
+            for (uint32_t i = 0; i < 16; i++) {
+                primary[i] = reader.read(mode.indexBits - (isAnchor(i) ? 1 : 0));
+            }
+            if (mode.secondaryIndexBits > 0) {
+                for (uint32_t i = 0; i < 16; i++) {
+                    secondary[i] = reader.read(mode.secondaryIndexBits - (i == 0 ? 1 : 0));
+                }
+            }
+
+            for (uint32_t i = 0; i < 16; i++) {
+                const uint8_t (*endpoint)[4] = endpoints[subsetOf(i)];
+                uint32_t colorIndex = primary[i];
+                uint32_t colorBits = mode.indexBits;
+                uint32_t alphaIndex = primary[i];
+                uint32_t alphaBits = mode.indexBits;
+                if (mode.secondaryIndexBits > 0) {
+                    // Modes 4 and 5 index colour and alpha separately; the selection bit swaps them
+                    alphaIndex = secondary[i];
+                    alphaBits = mode.secondaryIndexBits;
+                    if (indexSelection) {
+                        std::swap(colorIndex, alphaIndex);
+                        std::swap(colorBits, alphaBits);
+                    }
+                }
+                for (int c = 0; c < 3; c++) {
+                    out[i][c] = interpolateBc7(endpoint[0][c], endpoint[1][c], colorIndex, colorBits);
+                }
+                out[i][3] = interpolateBc7(endpoint[0][3], endpoint[1][3], alphaIndex, alphaBits);
+                if (rotation > 0) {
+                    std::swap(out[i][3], out[i][rotation - 1]);
+                }
+            }
+        }
+
+        // ETC1/ETC2 intensity modifiers by table codeword, indexed by the texel's 2-bit index
+        const int ETC_MODIFIERS[8][4] = {
+            {2, 8, -2, -8},
+            {5, 17, -5, -17},
+            {9, 29, -9, -29},
+            {13, 42, -13, -42},
+            {18, 60, -18, -60},
+            {24, 80, -24, -80},
+            {33, 106, -33, -106},
+            {47, 183, -47, -183},
+        };
+        // Distance between the paint colours of the T and H modes
+        const int ETC_DISTANCES[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+        // EAC modifiers by table index, indexed by the texel's 3-bit index
+        const int EAC_MODIFIERS[16][8] = {
+            {-3, -6, -9, -15, 2, 5, 8, 14},
+            {-3, -7, -10, -13, 2, 6, 9, 12},
+            {-2, -5, -8, -13, 1, 4, 7, 12},
+            {-2, -4, -6, -13, 1, 3, 5, 12},
+            {-3, -6, -8, -12, 2, 5, 7, 11},
+            {-3, -7, -9, -11, 2, 6, 8, 10},
+            {-4, -7, -8, -11, 3, 6, 7, 10},
+            {-3, -5, -8, -11, 2, 4, 7, 10},
+            {-2, -6, -8, -10, 1, 5, 7, 9},
+            {-2, -5, -8, -10, 1, 4, 7, 9},
+            {-2, -4, -8, -10, 1, 3, 7, 9},
+            {-2, -5, -7, -10, 1, 4, 6, 9},
+            {-3, -4, -7, -10, 2, 3, 6, 9},
+            {-1, -2, -3, -10, 0, 1, 2, 9},
+            {-4, -6, -8, -9, 3, 5, 7, 8},
+            {-3, -5, -7, -9, 2, 4, 6, 8},
+        };
+
+        int signExtend3(uint64_t value) { return value & 4 ? static_cast<int>(value) - 8 : static_cast<int>(value); }
+
+        // ETC2 RGB with its individual, differential, T, H and planar modes. With punch-through
+        // alpha the differential bit becomes an opaque bit and index 2 is transparent black.
+        void decodeEtc2Color(const uint8_t *block, bool punchThrough, Texels &out) {
+            const uint64_t bits = readBigEndian64(block);
+            const bool opaque = !punchThrough || ((bits >> 33) & 1);
+            const bool differential = punchThrough || ((bits >> 33) & 1);
+            // Texel indices are stored column by column
+            auto texelIndex = [&](int x, int y) {
+                const int bit = x * 4 + y;
+                return static_cast<int>(((bits >> (16 + bit)) & 1) << 1 | ((bits >> bit) & 1));
+            };
+            auto writeTexel = [&](int x, int y, const int color[3], bool transparent) {
+                uint8_t *texel = out[y * 4 + x];
+                for (int c = 0; c < 3; c++) {
+                    texel[c] = transparent ? 0 : clampByte(color[c]);
+                }
+                texel[3] = transparent ? 0 : 255;
+            };
+
+            const int red = static_cast<int>((bits >> 59) & 31);
+            const int green = static_cast<int>((bits >> 51) & 31);
+            const int blue = static_cast<int>((bits >> 43) & 31);
+            const int redDelta = signExtend3((bits >> 56) & 7);
+            const int greenDelta = signExtend3((bits >> 48) & 7);
+            const int blueDelta = signExtend3((bits >> 40) & 7);
+
+            if (differential && (red + redDelta < 0 || red + redDelta > 31)) {
+                // T mode: one colour and a second one spread by the distance
+                const int color1[3] = {
+                    expandBits(static_cast<uint32_t>(((bits >> 59) & 3) << 2 | ((bits >> 56) & 3)), 4),
+                    expandBits((bits >> 52) & 15, 4),
+                    expandBits((bits >> 48) & 15, 4)};
+                const int color2[3] = {
+                    expandBits((bits >> 44) & 15, 4), expandBits((bits >> 40) & 15, 4), expandBits((bits >> 36) & 15, 4)};
+                const int distance = ETC_DISTANCES[((bits >> 34) & 3) << 1 | ((bits >> 32) & 1)];
+                int paint[4][3];
+                for (int c = 0; c < 3; c++) {
+                    paint[0][c] = color1[c];
+                    paint[1][c] = color2[c] + distance;
+                    paint[2][c] = color2[c];
+                    paint[3][c] = color2[c] - distance;
+                }
+                for (int y = 0; y < 4; y++) {
+                    for (int x = 0; x < 4; x++) {
+                        const int index = texelIndex(x, y);
+                        writeTexel(x, y, paint[index], !opaque && index == 2);
+                    }
+                }
+                return;
+            }
+            if (differential && (green + greenDelta < 0 || green + greenDelta > 31)) {
+                // H mode: two colours, each spread by the distance
+                const uint32_t r1 = (bits >> 59) & 15;
+                const uint32_t g1 = ((bits >> 56) & 7) << 1 | ((bits >> 52) & 1);
+                const uint32_t b1 = ((bits >> 51) & 1) << 3 | ((bits >> 47) & 7);
+                const uint32_t r2 = (bits >> 43) & 15;
+                const uint32_t g2 = (bits >> 39) & 15;
+                const uint32_t b2 = (bits >> 35) & 15;
+                const uint32_t order = ((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2) ? 1 : 0;
+                const int distance = ETC_DISTANCES[((bits >> 34) & 1) << 2 | ((bits >> 32) & 1) << 1 | order];
+                const int color1[3] = {expandBits(r1, 4), expandBits(g1, 4), expandBits(b1, 4)};
+                const int color2[3] = {expandBits(r2, 4), expandBits(g2, 4), expandBits(b2, 4)};
+                int paint[4][3];
+                for (int c = 0; c < 3; c++) {
+                    paint[0][c] = color1[c] + distance;
+                    paint[1][c] = color1[c] - distance;
+                    paint[2][c] = color2[c] + distance;
+                    paint[3][c] = color2[c] - distance;
+                }
+                for (int y = 0; y < 4; y++) {
+                    for (int x = 0; x < 4; x++) {
+                        const int index = texelIndex(x, y);
+                        writeTexel(x, y, paint[index], !opaque && index == 2);
+                    }
+                }
+                return;
+            }
+            if (differential && (blue + blueDelta < 0 || blue + blueDelta > 31)) {
+                // Planar mode: a colour gradient from an origin, a horizontal and a vertical colour
+                const int origin[3] = {
+                    expandBits((bits >> 57) & 63, 6),
+                    expandBits(static_cast<uint32_t>(((bits >> 56) & 1) << 6 | ((bits >> 49) & 63)), 7),
+                    expandBits(static_cast<uint32_t>(((bits >> 48) & 1) << 5 | ((bits >> 43) & 3) << 3 | ((bits >> 39) & 7)), 6)};
+                const int horizontal[3] = {
+                    expandBits(static_cast<uint32_t>(((bits >> 34) & 31) << 1 | ((bits >> 32) & 1)), 6),
+                    expandBits((bits >> 25) & 127, 7),
+                    expandBits((bits >> 19) & 63, 6)};
+                const int vertical[3] = {
+                    expandBits((bits >> 13) & 63, 6), expandBits((bits >> 6) & 127, 7), expandBits(bits & 63, 6)};
+                for (int y = 0; y < 4; y++) {
+                    for (int x = 0; x < 4; x++) {
+                        int color[3];
+                        for (int c = 0; c < 3; c++) {
+                            color[c] = (x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+                        }
+                        writeTexel(x, y, color, false);
+                    }
+                }
+                return;
+            }
+
+            // Individual or differential mode: two subblocks, each a base colour and a modifier table
+            int bases[2][3];
+            if (differential) {
+                const int first[3] = {red, green, blue};
+                const int deltas[3] = {redDelta, greenDelta, blueDelta};
+                for (int c = 0; c < 3; c++) {
+                    bases[0][c] = expandBits(static_cast<uint32_t>(first[c]), 5);
+                    bases[1][c] = expandBits(static_cast<uint32_t>(first[c] + deltas[c]), 5);
+                }
+            } else {
+                for (int c = 0; c < 3; c++) {
+                    bases[0][c] = expandBits((bits >> (60 - 8 * c)) & 15, 4);
+                    bases[1][c] = expandBits((bits >> (56 - 8 * c)) & 15, 4);
+                }
+            }
+            const int tables[2] = {static_cast<int>((bits >> 37) & 7), static_cast<int>((bits >> 34) & 7)};
+            const bool flip = (bits >> 32) & 1;
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    const int subblock = flip ? y / 2 : x / 2;
+                    const int index = texelIndex(x, y);
+                    // Without the opaque bit, index 0 keeps the base colour and index 2 is transparent
+                    const int modifier = !opaque && index == 0 ? 0 : ETC_MODIFIERS[tables[subblock]][index];
+                    int color[3];
+                    for (int c = 0; c < 3; c++) {
+                        color[c] = bases[subblock][c] + modifier;
+                    }
+                    writeTexel(x, y, color, !opaque && index == 2);
+                }
+            }
+        }
+
+        // EAC: 8-bit alpha of ETC2 RGBA, or an 11-bit unsigned channel of R11/RG11
+        void decodeEacChannel(const uint8_t *block, bool elevenBit, int channel, Texels &out) {
+            const uint64_t bits = readBigEndian64(block);
+            const int base = static_cast<int>(bits >> 56);
+            const int multiplier = static_cast<int>((bits >> 52) & 15);
+            const int *modifiers = EAC_MODIFIERS[(bits >> 48) & 15];
+            for (int i = 0; i < 16; i++) {
+                // Column by column, first texel in the top bits
+                const int modifier = modifiers[(bits >> (45 - 3 * i)) & 7];
+                uint8_t value;
+                if (elevenBit) {
+                    const int scaled = std::clamp(base * 8 + 4 + modifier * (multiplier > 0 ? multiplier * 8 : 1), 0, 2047);
+                    value = static_cast<uint8_t>((scaled * 255 + 1023) / 2047);
+                } else {
+                    value = clampByte(base + modifier * multiplier);
+                }
+                out[(i % 4) * 4 + i / 4][channel] = value;
+            }
+        }
+
+        void decodeBlock(VkFormat format, const uint8_t *block, Texels &out) {
+            switch (format) {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    decodeBc1Colors(block, false, false, out);
+                    break;
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                    decodeBc1Colors(block, false, true, out);
+                    break;
+                case VK_FORMAT_BC2_UNORM_BLOCK:
+                case VK_FORMAT_BC2_SRGB_BLOCK: {
+                    decodeBc1Colors(block + 8, true, false, out);
+                    const uint64_t alpha = readLittleEndian64(block);
+                    for (int i = 0; i < 16; i++) {
+                        out[i][3] = static_cast<uint8_t>(((alpha >> (4 * i)) & 15) * 17);
+                    }
+                    break;
+                }
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    decodeBc1Colors(block + 8, true, false, out);
+                    decodeBc4Channel(block, 3, out);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    // Missing channels read as 0, alpha as 1, as when sampling the real format
+                    for (auto &texel : out) {
+                        texel[0] = texel[1] = texel[2] = 0;
+                        texel[3] = 255;
+                    }
+                    decodeBc4Channel(block, 0, out);
+                    if (format == VK_FORMAT_BC5_UNORM_BLOCK) {
+                        decodeBc4Channel(block + 8, 1, out);
+                    }
+                    break;
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                case VK_FORMAT_BC7_SRGB_BLOCK:
+                    decodeBc7(block, out);
+                    break;
+                case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+                case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+                    decodeEtc2Color(block, false, out);
+                    break;
+                case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+                case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+                    decodeEtc2Color(block, true, out);
+                    break;
+                case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+                case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+                    decodeEtc2Color(block + 8, false, out);
+                    decodeEacChannel(block, false, 3, out);
+                    break;
+                case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+                case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+                    for (auto &texel : out) {
+                        texel[0] = texel[1] = texel[2] = 0;
+                        texel[3] = 255;
+                    }
+                    decodeEacChannel(block, true, 0, out);
+                    if (format == VK_FORMAT_EAC_R11G11_UNORM_BLOCK) {
+                        decodeEacChannel(block + 8, true, 1, out);
+                    }
+                    break;
+                default:
+                    throw std::runtime_error("no CPU decoder for format " + std::to_string(format));
+            }
+        }
+    }
+
+    bool canDecodeBlocks(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+            case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void decodeBlockRows(
+        VkFormat format,
+        const uint8_t *blocks,
+        uint32_t width,
+        uint32_t height,
+        uint32_t beginRow,
+        uint32_t endRow,
+        uint8_t *rgba) {
+        const uint32_t blockBytes = getTexelBlock(format).bytes;
+        const uint32_t blocksWide = (width + 3) / 4;
+        Texels texels;
+        for (uint32_t row = beginRow; row < endRow; row++) {
+            for (uint32_t column = 0; column < blocksWide; column++) {
+                decodeBlock(format, blocks + (size_t{row} * blocksWide + column) * blockBytes, texels);
+                // Edge blocks are cut to the level's size
+                const uint32_t x0 = column * 4;
+                const uint32_t y0 = row * 4;
+                const uint32_t columns = std::min(4u, width - x0);
+                for (uint32_t y = 0; y < 4 && y0 + y < height; y++) {
+                    std::memcpy(rgba + (size_t{y0 + y} * width + x0) * 4, texels[y * 4], columns * 4);
+                }
+            }
+        }
+    }
+
+    LveImage decodeBlocks(VkFormat format, const uint8_t *blocks, uint32_t width, uint32_t height, LveJobSystem &jobSystem) {
+        if (!canDecodeBlocks(format)) {
+            throw std::runtime_error("no CPU decoder for format " + std::to_string(format));
+        }
+        LveImage image{};
+        image.width = width;
+        image.height = height;
+        image.rgba.resize(size_t{width} * height * 4);
+        const uint32_t blockRows = (height + 3) / 4;
+        jobSystem.parallelFor(blockRows, 16, [&](uint32_t begin, uint32_t end) {
+            decodeBlockRows(format, blocks, width, height, begin, end, image.rgba.data());
+        });
+        return image;
+    }
+}
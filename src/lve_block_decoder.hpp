@@ -0,0 +1,30 @@
+#pragma once
+
+#include "lve_image_decoder.hpp"
+#include "lve_job_system.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+
+namespace lve {
+
+    // CPU fallback for block-compressed textures the device cannot sample: BC1-5, BC7, ETC2 and
+    // unsigned EAC. BC6H is HDR and ASTC needs a full decoder, so neither has a fallback.
+    bool canDecodeBlocks(VkFormat format);
+
+    // Decodes block rows [beginRow, endRow) of a width x height level into rgba, which holds the
+    // whole level as RGBA8. Colour values are copied as stored, so sRGB data stays sRGB.
+    void decodeBlockRows(
+        VkFormat format,
+        const uint8_t *blocks,
+        uint32_t width,
+        uint32_t height,
+        uint32_t beginRow,
+        uint32_t endRow,
+        uint8_t *rgba);
+    // Whole level, split over the job system by block rows
+    LveImage decodeBlocks(VkFormat format, const uint8_t *blocks, uint32_t width, uint32_t height, LveJobSystem &jobSystem);
+}
@@ -0,0 +1,39 @@
+#include "lve_camera.hpp"
+
+// std
+#include <algorithm>
+
+namespace lve {
+
+    void LveCamera::reset() {
+        center = {0.0, 0.0};
+        zoom = 1.0;
+    }
+
+    void LveCamera::pan(const glm::dvec2 &ndcDelta) {
+        center -= ndcDelta / zoom;
+    }
+
+    void LveCamera::zoomAt(double factor, const glm::dvec2 &ndcPoint) {
+        glm::dvec2 worldPoint = center + ndcPoint / zoom;
+        zoom = std::clamp(zoom * factor, MIN_ZOOM, MAX_ZOOM);
+        center = worldPoint - ndcPoint / zoom;
+    }
+
+    void LveCamera::setView(const glm::dvec2 &newCenter, double newZoom) {
+        center = newCenter;
+        zoom = std::clamp(newZoom, MIN_ZOOM, MAX_ZOOM);
+    }
+
+    LveCamera::Transform LveCamera::getTransform(const glm::dvec2 &anchor) const {
+        Transform transform{};
+        transform.scale = glm::vec2{static_cast<float>(zoom)};
+        transform.offset = glm::vec2{(anchor - center) * zoom};
+        return transform;
+    }
+
+    void LveCamera::getViewBounds(glm::dvec2 &minBounds, glm::dvec2 &maxBounds) const {
+        minBounds = center - glm::dvec2{1.0 / zoom};
+        maxBounds = center + glm::dvec2{1.0 / zoom};
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+namespace lve {
+
+    // 2D orthographic camera. Kept in double precision so deep zooms into the
+    // fractal don't run out of mantissa; geometry is uploaded relative to an
+    // anchor close to the camera and only the final transform is narrowed to float.
+    class LveCamera {
+        public:
+            static constexpr double MIN_ZOOM = 0.25;
+            static constexpr double MAX_ZOOM = 1.0e10;
+
+            struct Transform {
+                glm::vec2 scale;
+                glm::vec2 offset;
+            };
+
+            void reset();
+            // Moves the view by a delta given in normalized device coordinates
+            void pan(const glm::dvec2 &ndcDelta);
+            // Scales the view by factor while keeping the point under ndcPoint fixed
+            void zoomAt(double factor, const glm::dvec2 &ndcPoint);
+            void setView(const glm::dvec2 &newCenter, double newZoom);
+
+            // World -> NDC transform for positions stored relative to anchor
+            Transform getTransform(const glm::dvec2 &anchor) const;
+            void getViewBounds(glm::dvec2 &minBounds, glm::dvec2 &maxBounds) const;
+
+            const glm::dvec2 &getCenter() const { return center; }
+            double getZoom() const { return zoom; }
+
+        private:
+            glm::dvec2 center{0.0, 0.0};
+            double zoom = 1.0;
+    };
+}
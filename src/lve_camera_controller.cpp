@@ -0,0 +1,67 @@
+#include "lve_camera_controller.hpp"
+
+// std
+#include <cmath>
+
+namespace lve {
+
+    bool LveCameraController::update(LveWindow &window, LveCamera &camera, float dt) {
+        GLFWwindow *glfwWindow = window.getGLFWwindow();
+        bool changed = false;
+
+        if (glfwGetKey(glfwWindow, keys.reset) == GLFW_PRESS) {
+            camera.reset();
+            changed = true;
+        }
+
+        double cursorX, cursorY;
+        glfwGetCursorPos(glfwWindow, &cursorX, &cursorY);
+        glm::dvec2 cursorNdc = cursorToNdc(window, cursorX, cursorY);
+
+        // Left mouse drag pans
+        if (glfwGetMouseButton(glfwWindow, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+            if (dragging && cursorNdc != lastCursorNdc) {
+                camera.pan(cursorNdc - lastCursorNdc);
+                changed = true;
+            }
+            dragging = true;
+        } else {
+            dragging = false;
+        }
+        lastCursorNdc = cursorNdc;
+
+        // Scroll zooms around the cursor
+        double scroll = window.takeScrollOffset();
+        if (scroll != 0.0) {
+            camera.zoomAt(std::pow(scrollZoomStep, scroll), cursorNdc);
+            changed = true;
+        }
+
+        glm::dvec2 panDir{0.0};
+        if (glfwGetKey(glfwWindow, keys.panLeft) == GLFW_PRESS) panDir.x += 1.0;
+        if (glfwGetKey(glfwWindow, keys.panRight) == GLFW_PRESS) panDir.x -= 1.0;
+        if (glfwGetKey(glfwWindow, keys.panUp) == GLFW_PRESS) panDir.y += 1.0;
+        if (glfwGetKey(glfwWindow, keys.panDown) == GLFW_PRESS) panDir.y -= 1.0;
+        if (panDir != glm::dvec2{0.0}) {
+            camera.pan(panDir * static_cast<double>(panSpeed * dt));
+            changed = true;
+        }
+
+        double zoomDir = 0.0;
+        if (glfwGetKey(glfwWindow, keys.zoomIn) == GLFW_PRESS) zoomDir += 1.0;
+        if (glfwGetKey(glfwWindow, keys.zoomOut) == GLFW_PRESS) zoomDir -= 1.0;
+        if (zoomDir != 0.0) {
+            camera.zoomAt(std::pow(static_cast<double>(zoomSpeed), zoomDir * dt), glm::dvec2{0.0});
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    glm::dvec2 LveCameraController::cursorToNdc(LveWindow &window, double x, double y) {
+        VkExtent2D extent = window.getExtent();
+        return {
+            2.0 * x / static_cast<double>(extent.width) - 1.0,
+            2.0 * y / static_cast<double>(extent.height) - 1.0};
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "lve_camera.hpp"
+#include "lve_window.hpp"
+
+namespace lve {
+    class LveCameraController {
+        public:
+            struct KeyMappings {
+                int panLeft = GLFW_KEY_A;
+                int panRight = GLFW_KEY_D;
+                int panUp = GLFW_KEY_W;
+                int panDown = GLFW_KEY_S;
+                int zoomIn = GLFW_KEY_E;
+                int zoomOut = GLFW_KEY_Q;
+                int reset = GLFW_KEY_R;
+            };
+
+            // Returns true when the camera changed
+            bool update(LveWindow &window, LveCamera &camera, float dt);
+
+            KeyMappings keys{};
+            float panSpeed = 1.0f;       // NDC units per second
+            float zoomSpeed = 2.0f;      // zoom factor per second
+            float scrollZoomStep = 1.2f; // zoom factor per scroll notch
+
+        private:
+            glm::dvec2 cursorToNdc(LveWindow &window, double x, double y);
+
+            bool dragging = false;
+            glm::dvec2 lastCursorNdc{0.0};
+    };
+}
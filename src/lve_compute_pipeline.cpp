@@ -0,0 +1,58 @@
+#include "lve_compute_pipeline.hpp"
+#include "lve_pipeline.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+
+namespace lve {
+
+    LveComputePipeline::LveComputePipeline(
+                LveDevice& device,
+                const std::string& compFilePath,
+                VkPipelineLayout pipelineLayout) : lveDevice{device} {
+        createComputePipeline(compFilePath, pipelineLayout);
+    }
+
+    LveComputePipeline::~LveComputePipeline() {
+        vkDestroyShaderModule(lveDevice.device(), compShaderModule, lveDevice.getAllocator());
+        vkDestroyPipeline(lveDevice.device(), computePipeline, lveDevice.getAllocator());
+    }
+
+    void LveComputePipeline::createComputePipeline(const std::string& compFilePath, VkPipelineLayout pipelineLayout) {
+        assert(pipelineLayout != VK_NULL_HANDLE
+            && "Cannot create compute pipeline: no pipelineLayout provided");
+
+        auto compCode = LvePipeline::readFile(compFilePath);
+
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = compCode.size();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compCode.data());
+
+        if (vkCreateShaderModule(lveDevice.device(), &moduleInfo, lveDevice.getAllocator(), &compShaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute shader module");
+        }
+
+        VkPipelineShaderStageCreateInfo shaderStage{};
+        shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        shaderStage.module = compShaderModule;
+        shaderStage.pName = "main";
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = shaderStage;
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, lveDevice.getAllocator(), &computePipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute pipeline");
+        }
+    }
+
+    void LveComputePipeline::bind(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+    }
+}
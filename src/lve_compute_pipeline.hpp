@@ -0,0 +1,31 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    class LveComputePipeline {
+        public:
+            LveComputePipeline(
+                LveDevice& device,
+                const std::string& compFilePath,
+                VkPipelineLayout pipelineLayout);
+
+            ~LveComputePipeline();
+
+            LveComputePipeline(const LveComputePipeline&) = delete;
+            void operator=(const LveComputePipeline&) = delete;
+
+            void bind(VkCommandBuffer commandBuffer);
+
+        private:
+            void createComputePipeline(const std::string& compFilePath, VkPipelineLayout pipelineLayout);
+
+            LveDevice& lveDevice;
+            VkPipeline computePipeline;
+            VkShaderModule compShaderModule;
+    };
+}
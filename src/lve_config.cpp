@@ -0,0 +1,142 @@
+#include "lve_config.hpp"
+#include "lve_model.hpp"
+
+// std
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+
+    static uint32_t parseUint(const std::string &flag, const std::string &value) {
+        try {
+            // stoull skips spaces and accepts a sign, wrapping negative values around
+            if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0]))) {
+                throw std::invalid_argument(value);
+            }
+            size_t end = 0;
+            unsigned long long parsed = std::stoull(value, &end);
+            if (end != value.size() || parsed > UINT32_MAX) {
+                throw std::out_of_range(value);
+            }
+            return static_cast<uint32_t>(parsed);
+        } catch (const std::exception &) {
+            throw std::runtime_error("invalid value for " + flag + ": " + value);
+        }
+    }
+
+    LveAppConfig LveAppConfig::fromArgs(int argc, char **argv) {
+        LveAppConfig config{};
+        std::vector<std::string> args(argv + 1, argv + argc);
+
+        for (size_t i = 0; i < args.size(); i++) {
+            const std::string &arg = args[i];
+            auto nextValue = [&]() -> const std::string & {
+                if (i + 1 >= args.size()) {
+                    throw std::runtime_error("missing value for " + arg);
+                }
+                return args[++i];
+            };
+
+            if (arg == "--help" || arg == "-h") {
+                printUsage();
+                std::exit(EXIT_SUCCESS);
+            } else if (arg == "--objects") {
+                config.sceneObjects = parseUint(arg, nextValue());
+            } else if (arg == "--procedural") {
+                config.procedural = true;
+                config.proceduralDepth = parseUint(arg, nextValue());
+                if (config.proceduralDepth > LveModel::MAX_PROCEDURAL_DEPTH) {
+                    throw std::runtime_error(
+                        "--procedural depth must be at most " + std::to_string(LveModel::MAX_PROCEDURAL_DEPTH));
+                }
+            } else if (arg == "--model") {
+                config.modelPath = nextValue();
+            } else if (arg == "--strips") {
+                config.strips = true;
+            } else if (arg == "--texture") {
+                config.texturePaths.push_back(nextValue());
+            } else if (arg == "--texture-budget") {
+                config.textureBudgetMb = parseUint(arg, nextValue());
+            } else if (arg == "--chaos") {
+                config.chaosMillionPoints = parseUint(arg, nextValue());
+            } else if (arg == "--device") {
+                config.device = nextValue();
+            } else if (arg == "--list-devices") {
+                config.listDevices = true;
+            } else if (arg == "--render-passes") {
+                config.renderPasses = true;
+            } else if (arg == "--system-allocator") {
+                config.systemAllocator = true;
+            } else if (arg == "--no-bindless") {
+                config.noBindless = true;
+            } else if (arg == "--submit-thread") {
+                config.submitThread = true;
+            } else if (arg == "--fps") {
+                config.maxFps = parseUint(arg, nextValue());
+                if (config.maxFps == 0) {
+                    throw std::runtime_error("--fps must be at least 1");
+                }
+                if (config.renderPolicy == RenderPolicy::Continuous) {
+                    config.renderPolicy = RenderPolicy::Capped;
+                }
+            } else if (arg == "--on-demand") {
+                config.renderPolicy = RenderPolicy::OnDemand;
+            } else if (arg == "--query-stats") {
+                config.queryStats = true;
+            } else if (arg == "--dump-frames") {
+                config.dumpDirectory = nextValue();
+            } else if (arg == "--gigapixel") {
+                config.gigapixelWidth = parseUint(arg, nextValue());
+                config.gigapixelHeight = parseUint(arg, nextValue());
+                config.gigapixelPath = nextValue();
+            } else if (arg == "--tile-size") {
+                config.tileSize = parseUint(arg, nextValue());
+            } else if (arg == "--bench") {
+                config.benchmark = nextValue();
+                config.benchmarkArgs.assign(args.begin() + i + 1, args.end());
+                break;
+            } else {
+                throw std::runtime_error("unknown option: " + arg);
+            }
+        }
+        if (config.procedural && !config.modelPath.empty()) {
+            throw std::runtime_error("--model and --procedural cannot be combined");
+        }
+        if (config.strips && config.modelPath.empty()) {
+            throw std::runtime_error("--strips only applies to --model");
+        }
+        if (!config.texturePaths.empty() && config.noBindless) {
+            throw std::runtime_error("--texture needs the bindless heap and cannot be combined with --no-bindless");
+        }
+        return config;
+    }
+
+    void LveAppConfig::printUsage() {
+        std::cout << "usage: a.out [options]\n"
+                  << "  --objects <n>          draw n instanced scene objects over the fractal\n"
+                  << "  --procedural <depth>   draw a fixed-depth fractal with no vertex buffer\n"
+                  << "  --model <file>         draw an OBJ or .glb mesh instead of the fractal\n"
+                  << "  --strips               draw --model as triangle strips instead of the optimized triangle list\n"
+                  << "  --texture <file>       stream a PNG, PPM or KTX2 in and show it as a thumbnail, repeatable\n"
+                  << "  --texture-budget <MB>  device memory kept resident for --texture (default 256)\n"
+                  << "  --chaos <millions>     accumulate a chaos-game point cloud, millions of points per frame\n"
+                  << "  --device <selector>    use the GPU with this index, UUID or name substring\n"
+                  << "                         (defaults to LVE_DEVICE, then the highest score)\n"
+                  << "  --list-devices         print every GPU with its score and exit\n"
+                  << "  --render-passes        use render pass objects even if dynamic rendering is available\n"
+                  << "  --system-allocator     do not track driver host allocations\n"
+                  << "  --no-bindless          bind per-system descriptor sets instead of one bindless heap\n"
+                  << "  --submit-thread        submit and present from a dedicated thread\n"
+                  << "  --fps <n>              draw at most n frames per second\n"
+                  << "  --on-demand            draw only after input, window damage or scene changes\n"
+                  << "  --query-stats          print pipeline statistics and occlusion counts of the main pass\n"
+                  << "  --dump-frames <dir>    read back every frame and write it to dir as PPM\n"
+                  << "  --gigapixel <w> <h> <file.png>\n"
+                  << "                         render a w x h image in tiles and stream it to a PNG\n"
+                  << "  --tile-size <n>        tile edge for --gigapixel (default 256)\n"
+                  << "  --bench <name> [args]  run a benchmark and exit (scene, cull, jobs, strip,\n"
+                  << "                         mesh, import [file], ktx2 [files])\n";
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // When the app draws: every loop iteration, at most maxFps per second, or only when something changed
+    enum class RenderPolicy { Continuous, Capped, OnDemand };
+
+    // Command line options shared by the app and the benchmarks
+    struct LveAppConfig {
+        // Number of instanced scene objects drawn over the fractal
+        uint32_t sceneObjects = 0;
+
+        // Draw a fixed-depth Sierpinski triangle from gl_VertexIndex instead of the adaptive fractal
+        bool procedural = false;
+        uint32_t proceduralDepth = 0;
+
+        // OBJ or glTF binary mesh drawn instead of the fractal
+        std::string modelPath;
+        // Draw the mesh as triangle strips joined by primitive restart instead of the optimized list
+        bool strips = false;
+
+        // PNG, binary PPM/PGM or KTX2 images streamed in and shown as thumbnails; needs the bindless heap
+        std::vector<std::string> texturePaths;
+        // Device memory the streamed textures may keep resident, in MB
+        uint32_t textureBudgetMb = 256;
+
+        // Millions of chaos-game points accumulated per frame, 0 disables the point cloud
+        uint32_t chaosMillionPoints = 0;
+
+        // GPU index, UUID or name substring; overrides LVE_DEVICE and the device score
+        std::string device;
+        // Print every GPU with its score and exit
+        bool listDevices = false;
+        // Use VkRenderPass/VkFramebuffer objects even when dynamic rendering is available
+        bool renderPasses = false;
+        // Let the driver allocate host memory itself instead of through LveHostAllocator
+        bool systemAllocator = false;
+        // Keep per-system descriptor sets even when descriptor indexing allows a bindless heap
+        bool noBindless = false;
+        // Submit and present from a dedicated thread so the main thread never blocks in present
+        bool submitThread = false;
+
+        RenderPolicy renderPolicy = RenderPolicy::Continuous;
+        // Frame rate cap for Capped, and for OnDemand while something is changing; 0 is uncapped
+        uint32_t maxFps = 0;
+
+        // Count vertices, shader invocations and passing samples of the main pass every frame
+        bool queryStats = false;
+
+        // Write every presented frame as a PPM into this directory, empty disables readback
+        std::string dumpDirectory;
+
+        // Render one gigapixelWidth x gigapixelHeight PNG in tiles instead of opening the app
+        std::string gigapixelPath;
+        uint32_t gigapixelWidth = 0;
+        uint32_t gigapixelHeight = 0;
+        uint32_t tileSize = 256;
+
+        // --bench <name> [args...] runs a benchmark instead of the app
+        std::string benchmark;
+        std::vector<std::string> benchmarkArgs;
+
+        static LveAppConfig fromArgs(int argc, char **argv);
+        static void printUsage();
+    };
+}
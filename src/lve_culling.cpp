@@ -0,0 +1,248 @@
+#include "lve_culling.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LVE_CULL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace lve {
+
+    static uint32_t cullRectsScalar(
+        const float *minX, const float *minY, const float *maxX, const float *maxY,
+        const uint8_t *enabled, uint32_t begin, uint32_t count,
+        const CullRect &view, uint32_t *out) {
+        uint32_t written = 0;
+        for (uint32_t i = begin; i < count; i++) {
+            const bool hit = (enabled == nullptr || enabled[i] != 0) &&
+                             minX[i] <= view.maxBounds.x && maxX[i] >= view.minBounds.x &&
+                             minY[i] <= view.maxBounds.y && maxY[i] >= view.minBounds.y;
+            out[written] = i;
+            written += hit ? 1 : 0;
+        }
+        return written;
+    }
+
+    static uint32_t cullBoxesScalar(
+        const float *minX, const float *minY, const float *minZ,
+        const float *maxX, const float *maxY, const float *maxZ,
+        uint32_t begin, uint32_t count, const CullFrustum &frustum, uint32_t *out) {
+        uint32_t written = 0;
+        for (uint32_t i = begin; i < count; i++) {
+            bool inside = true;
+            for (const auto &plane : frustum.planes) {
+                // Distance of the box corner furthest along the plane normal
+                const float d = (plane.x > 0.0f ? plane.x * maxX[i] : plane.x * minX[i]) +
+                                (plane.y > 0.0f ? plane.y * maxY[i] : plane.y * minY[i]) +
+                                (plane.z > 0.0f ? plane.z * maxZ[i] : plane.z * minZ[i]) + plane.w;
+                inside = inside && d >= 0.0f;
+            }
+            out[written] = i;
+            written += inside ? 1 : 0;
+        }
+        return written;
+    }
+
+#ifdef LVE_CULL_X86
+    // Writes the index of every set bit of mask, offset by base
+    static inline uint32_t emitMask(uint32_t mask, uint32_t base, uint32_t *out) {
+        uint32_t written = 0;
+        while (mask != 0) {
+            out[written++] = base + static_cast<uint32_t>(__builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+        return written;
+    }
+
+    // One bit per object that is enabled
+    static inline uint32_t enabledMask4(const uint8_t *enabled, uint32_t i) {
+        if (enabled == nullptr) return 0xF;
+        int32_t bytes;
+        __builtin_memcpy(&bytes, enabled + i, sizeof(bytes));
+        __m128i zero = _mm_cmpeq_epi8(_mm_cvtsi32_si128(bytes), _mm_setzero_si128());
+        return ~static_cast<uint32_t>(_mm_movemask_epi8(zero)) & 0xF;
+    }
+
+    static inline uint32_t enabledMask8(const uint8_t *enabled, uint32_t i) {
+        if (enabled == nullptr) return 0xFF;
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(enabled + i));
+        __m128i zero = _mm_cmpeq_epi8(bytes, _mm_setzero_si128());
+        return ~static_cast<uint32_t>(_mm_movemask_epi8(zero)) & 0xFF;
+    }
+
+    static uint32_t cullRectsSSE2(
+        const float *minX, const float *minY, const float *maxX, const float *maxY,
+        const uint8_t *enabled, uint32_t count, const CullRect &view, uint32_t *out) {
+        const __m128 viewMinX = _mm_set1_ps(view.minBounds.x);
+        const __m128 viewMinY = _mm_set1_ps(view.minBounds.y);
+        const __m128 viewMaxX = _mm_set1_ps(view.maxBounds.x);
+        const __m128 viewMaxY = _mm_set1_ps(view.maxBounds.y);
+
+        uint32_t written = 0;
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 hit = _mm_and_ps(
+                _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minX + i), viewMaxX), _mm_cmpge_ps(_mm_loadu_ps(maxX + i), viewMinX)),
+                _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minY + i), viewMaxY), _mm_cmpge_ps(_mm_loadu_ps(maxY + i), viewMinY)));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(hit)) & enabledMask4(enabled, i);
+            written += emitMask(mask, i, out + written);
+        }
+        return written + cullRectsScalar(minX, minY, maxX, maxY, enabled, i, count, view, out + written);
+    }
+
+    static uint32_t cullBoxesSSE2(
+        const float *minX, const float *minY, const float *minZ,
+        const float *maxX, const float *maxY, const float *maxZ,
+        uint32_t count, const CullFrustum &frustum, uint32_t *out) {
+        uint32_t written = 0;
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x0 = _mm_loadu_ps(minX + i), x1 = _mm_loadu_ps(maxX + i);
+            const __m128 y0 = _mm_loadu_ps(minY + i), y1 = _mm_loadu_ps(maxY + i);
+            const __m128 z0 = _mm_loadu_ps(minZ + i), z1 = _mm_loadu_ps(maxZ + i);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const auto &plane : frustum.planes) {
+                const __m128 a = _mm_set1_ps(plane.x), b = _mm_set1_ps(plane.y), c = _mm_set1_ps(plane.z);
+                __m128 d = _mm_add_ps(
+                    _mm_add_ps(_mm_max_ps(_mm_mul_ps(a, x0), _mm_mul_ps(a, x1)), _mm_max_ps(_mm_mul_ps(b, y0), _mm_mul_ps(b, y1))),
+                    _mm_add_ps(_mm_max_ps(_mm_mul_ps(c, z0), _mm_mul_ps(c, z1)), _mm_set1_ps(plane.w)));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+            }
+            written += emitMask(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, out + written);
+        }
+        return written + cullBoxesScalar(minX, minY, minZ, maxX, maxY, maxZ, i, count, frustum, out + written);
+    }
+
+    __attribute__((target("avx")))
+    static uint32_t cullRectsAVX(
+        const float *minX, const float *minY, const float *maxX, const float *maxY,
+        const uint8_t *enabled, uint32_t count, const CullRect &view, uint32_t *out) {
+        const __m256 viewMinX = _mm256_set1_ps(view.minBounds.x);
+        const __m256 viewMinY = _mm256_set1_ps(view.minBounds.y);
+        const __m256 viewMaxX = _mm256_set1_ps(view.maxBounds.x);
+        const __m256 viewMaxY = _mm256_set1_ps(view.maxBounds.y);
+
+        uint32_t written = 0;
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 hit = _mm256_and_ps(
+                _mm256_and_ps(
+                    _mm256_cmp_ps(_mm256_loadu_ps(minX + i), viewMaxX, _CMP_LE_OQ),
+                    _mm256_cmp_ps(_mm256_loadu_ps(maxX + i), viewMinX, _CMP_GE_OQ)),
+                _mm256_and_ps(
+                    _mm256_cmp_ps(_mm256_loadu_ps(minY + i), viewMaxY, _CMP_LE_OQ),
+                    _mm256_cmp_ps(_mm256_loadu_ps(maxY + i), viewMinY, _CMP_GE_OQ)));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(hit)) & enabledMask8(enabled, i);
+            written += emitMask(mask, i, out + written);
+        }
+        // The compiler does not reliably clear the upper halves on leaving a target("avx") function.
+        // Left dirty, later SSE code on this thread pays a transition penalty, e.g. the next job a
+        // worker runs.
+        _mm256_zeroupper();
+        return written + cullRectsScalar(minX, minY, maxX, maxY, enabled, i, count, view, out + written);
+    }
+
+    __attribute__((target("avx")))
+    static uint32_t cullBoxesAVX(
+        const float *minX, const float *minY, const float *minZ,
+        const float *maxX, const float *maxY, const float *maxZ,
+        uint32_t count, const CullFrustum &frustum, uint32_t *out) {
+        uint32_t written = 0;
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256 x0 = _mm256_loadu_ps(minX + i), x1 = _mm256_loadu_ps(maxX + i);
+            const __m256 y0 = _mm256_loadu_ps(minY + i), y1 = _mm256_loadu_ps(maxY + i);
+            const __m256 z0 = _mm256_loadu_ps(minZ + i), z1 = _mm256_loadu_ps(maxZ + i);
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto &plane : frustum.planes) {
+                const __m256 a = _mm256_set1_ps(plane.x), b = _mm256_set1_ps(plane.y), c = _mm256_set1_ps(plane.z);
+                __m256 d = _mm256_add_ps(
+                    _mm256_add_ps(
+                        _mm256_max_ps(_mm256_mul_ps(a, x0), _mm256_mul_ps(a, x1)),
+                        _mm256_max_ps(_mm256_mul_ps(b, y0), _mm256_mul_ps(b, y1))),
+                    _mm256_add_ps(
+                        _mm256_max_ps(_mm256_mul_ps(c, z0), _mm256_mul_ps(c, z1)),
+                        _mm256_set1_ps(plane.w)));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            written += emitMask(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, out + written);
+        }
+        _mm256_zeroupper();
+        return written + cullBoxesScalar(minX, minY, minZ, maxX, maxY, maxZ, i, count, frustum, out + written);
+    }
+#endif
+
+    bool isCullBackendSupported(CullBackend backend) {
+        switch (backend) {
+            case CullBackend::Auto:
+            case CullBackend::Scalar:
+                return true;
+#ifdef LVE_CULL_X86
+            case CullBackend::SSE2:
+                return __builtin_cpu_supports("sse2");
+            case CullBackend::AVX:
+                return __builtin_cpu_supports("avx");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    const char *cullBackendName(CullBackend backend) {
+        switch (backend) {
+            case CullBackend::Auto: return "auto";
+            case CullBackend::Scalar: return "scalar";
+            case CullBackend::SSE2: return "sse2";
+            case CullBackend::AVX: return "avx";
+        }
+        return "unknown";
+    }
+
+    static CullBackend resolveBackend(CullBackend backend) {
+        if (backend != CullBackend::Auto) {
+            return isCullBackendSupported(backend) ? backend : CullBackend::Scalar;
+        }
+        static const CullBackend best =
+            isCullBackendSupported(CullBackend::AVX) ? CullBackend::AVX :
+            isCullBackendSupported(CullBackend::SSE2) ? CullBackend::SSE2 :
+            CullBackend::Scalar;
+        return best;
+    }
+
+    uint32_t cullRects(
+        const float *minX, const float *minY, const float *maxX, const float *maxY,
+        const uint8_t *enabled,
+        uint32_t count,
+        const CullRect &view,
+        uint32_t *outIndices,
+        CullBackend backend) {
+        switch (resolveBackend(backend)) {
+#ifdef LVE_CULL_X86
+            case CullBackend::AVX:
+                return cullRectsAVX(minX, minY, maxX, maxY, enabled, count, view, outIndices);
+            case CullBackend::SSE2:
+                return cullRectsSSE2(minX, minY, maxX, maxY, enabled, count, view, outIndices);
+#endif
+            default:
+                return cullRectsScalar(minX, minY, maxX, maxY, enabled, 0, count, view, outIndices);
+        }
+    }
+
+    uint32_t cullBoxes(
+        const float *minX, const float *minY, const float *minZ,
+        const float *maxX, const float *maxY, const float *maxZ,
+        uint32_t count,
+        const CullFrustum &frustum,
+        uint32_t *outIndices,
+        CullBackend backend) {
+        switch (resolveBackend(backend)) {
+#ifdef LVE_CULL_X86
+            case CullBackend::AVX:
+                return cullBoxesAVX(minX, minY, minZ, maxX, maxY, maxZ, count, frustum, outIndices);
+            case CullBackend::SSE2:
+                return cullBoxesSSE2(minX, minY, minZ, maxX, maxY, maxZ, count, frustum, outIndices);
+#endif
+            default:
+                return cullBoxesScalar(minX, minY, minZ, maxX, maxY, maxZ, 0, count, frustum, outIndices);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+
+namespace lve {
+
+    // CPU culling over structure-of-arrays bounds. Each call tests the boxes
+    // against the view and writes the indices of the survivors, in order, to
+    // outIndices (which needs room for count entries). Returns the number
+    // written. Auto picks AVX, then SSE2, then the scalar loop at runtime.
+    enum class CullBackend {
+        Auto,
+        Scalar,
+        SSE2,
+        AVX,
+    };
+
+    struct CullRect {
+        glm::vec2 minBounds;
+        glm::vec2 maxBounds;
+    };
+
+    // Planes as (normal, distance); a point p is inside when dot(normal, p) + distance >= 0
+    struct CullFrustum {
+        glm::vec4 planes[6];
+    };
+
+    // enabled may be null; otherwise objects with enabled[i] == 0 are skipped
+    uint32_t cullRects(
+        const float *minX, const float *minY, const float *maxX, const float *maxY,
+        const uint8_t *enabled,
+        uint32_t count,
+        const CullRect &view,
+        uint32_t *outIndices,
+        CullBackend backend = CullBackend::Auto);
+
+    uint32_t cullBoxes(
+        const float *minX, const float *minY, const float *minZ,
+        const float *maxX, const float *maxY, const float *maxZ,
+        uint32_t count,
+        const CullFrustum &frustum,
+        uint32_t *outIndices,
+        CullBackend backend = CullBackend::Auto);
+
+    bool isCullBackendSupported(CullBackend backend);
+    const char *cullBackendName(CullBackend backend);
+}
@@ -1,6 +1,12 @@
 #include "lve_device.hpp"
 
 // std headers
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -46,26 +52,108 @@ void DestroyDebugUtilsMessengerEXT(
   }
 }
 
+static std::string toLower(const std::string &text) {
+  std::string result = text;
+  for (char &c : result) {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  return result;
+}
+
 // class member functions
-LveDevice::LveDevice(LveWindow &window) : window{window} {
+LveDevice::LveDevice(LveWindow &window, const std::string &deviceOverride, bool trackHostAllocations)
+    : trackHostAllocations{trackHostAllocations}, deviceOverride{deviceOverride}, window{window} {
   createInstance();
   setupDebugMessenger();
   createSurface();
+  enumeratePhysicalDevices();
+  printPhysicalDevices();
   pickPhysicalDevice();
   createLogicalDevice();
   createCommandPool();
 }
 
+LveDevice::LveDevice(LveWindow &window, EnumerateOnly)
+    : trackHostAllocations{false}, window{window} {
+  createInstance();
+  setupDebugMessenger();
+  createSurface();
+  enumeratePhysicalDevices();
+}
+
 LveDevice::~LveDevice() {
-  vkDestroyCommandPool(device_, commandPool, nullptr);
-  vkDestroyDevice(device_, nullptr);
+  if (device_ != VK_NULL_HANDLE) {
+    flushDeletionQueue();
+    submitThread.reset();
+    vkDestroyCommandPool(device_, commandPool, getAllocator());
+    vkDestroyDevice(device_, getAllocator());
+  }
 
   if (enableValidationLayers) {
-    DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+    DestroyDebugUtilsMessengerEXT(instance, debugMessenger, getAllocator());
+  }
+
+  vkDestroySurfaceKHR(instance, surface_, getAllocator());
+  vkDestroyInstance(instance, getAllocator());
+}
+
+void LveDevice::retireFrames(uint64_t completedFrameNumber) {
+  std::vector<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lock{deletionMutex};
+    // Tags only grow, so everything that is ready sits at the front
+    while (!deletionQueue.empty() && deletionQueue.front().frameNumber <= completedFrameNumber) {
+      ready.push_back(std::move(deletionQueue.front().deleter));
+      deletionQueue.pop_front();
+    }
+  }
+  for (auto &deleter : ready) {
+    deleter();
+  }
+}
+
+void LveDevice::deferDestroy(std::function<void()> deleter) {
+  std::lock_guard<std::mutex> lock{deletionMutex};
+  deletionQueue.push_back({frameNumber, std::move(deleter)});
+}
+
+void LveDevice::deferDestroyBuffer(VkBuffer buffer, VkDeviceMemory memory) {
+  VkDevice device = device_;
+  const VkAllocationCallbacks *allocator = getAllocator();
+  deferDestroy([device, allocator, buffer, memory]() {
+    vkDestroyBuffer(device, buffer, allocator);
+    vkFreeMemory(device, memory, allocator);
+  });
+}
+
+void LveDevice::deferDestroyImage(VkImage image, VkImageView imageView, VkDeviceMemory memory) {
+  VkDevice device = device_;
+  const VkAllocationCallbacks *allocator = getAllocator();
+  deferDestroy([device, allocator, image, imageView, memory]() {
+    if (imageView != VK_NULL_HANDLE) {
+      vkDestroyImageView(device, imageView, allocator);
+    }
+    vkDestroyImage(device, image, allocator);
+    vkFreeMemory(device, memory, allocator);
+  });
+}
+
+void LveDevice::flushDeletionQueue() {
+  waitIdle();
+  retireFrames(UINT64_MAX);
+}
+
+void LveDevice::startSubmitThread() {
+  if (!submitThread) {
+    submitThread = std::make_unique<LveSubmitThread>(device_);
   }
+}
 
-  vkDestroySurfaceKHR(instance, surface_, nullptr);
-  vkDestroyInstance(instance, nullptr);
+void LveDevice::waitIdle() {
+  if (submitThread) {
+    submitThread->waitIdle();
+  }
+  vkDeviceWaitIdle(device_);
 }
 
 void LveDevice::createInstance() {
@@ -79,7 +167,18 @@ void LveDevice::createInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "No Engine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
+  // 1.1 when the loader has it, so device UUIDs can be queried for selection
+  auto enumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(
+      nullptr,
+      "vkEnumerateInstanceVersion");
+  if (enumerateInstanceVersion != nullptr &&
+      enumerateInstanceVersion(&instanceApiVersion) == VK_SUCCESS &&
+      instanceApiVersion >= VK_API_VERSION_1_1) {
+    instanceApiVersion = VK_API_VERSION_1_1;
+  } else {
+    instanceApiVersion = VK_API_VERSION_1_0;
+  }
+  appInfo.apiVersion = instanceApiVersion;
 
   VkInstanceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -101,36 +200,234 @@ void LveDevice::createInstance() {
     createInfo.pNext = nullptr;
   }
 
-  if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS) {
+  if (vkCreateInstance(&createInfo, getAllocator(), &instance) != VK_SUCCESS) {
     throw std::runtime_error("failed to create instance!");
   }
 
   hasGflwRequiredInstanceExtensions();
 }
 
-void LveDevice::pickPhysicalDevice() {
+void LveDevice::listPhysicalDevices(LveWindow &window) {
+  LveDevice lister{window, EnumerateOnly{}};
+  lister.printPhysicalDevices();
+}
+
+void LveDevice::enumeratePhysicalDevices() {
   uint32_t deviceCount = 0;
   vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
   if (deviceCount == 0) {
     throw std::runtime_error("failed to find GPUs with Vulkan support!");
   }
-  std::cout << "Device count: " << deviceCount << std::endl;
   std::vector<VkPhysicalDevice> devices(deviceCount);
   vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
-  for (const auto &device : devices) {
-    if (isDeviceSuitable(device)) {
-      physicalDevice = device;
-      break;
+  physicalDeviceInfos.clear();
+  for (uint32_t i = 0; i < deviceCount; i++) {
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(devices[i], &deviceProperties);
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(devices[i], &memoryProperties);
+    VkDeviceSize deviceLocalBytes = 0;
+    for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++) {
+      if (memoryProperties.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+        deviceLocalBytes = std::max(deviceLocalBytes, memoryProperties.memoryHeaps[h].size);
+      }
+    }
+
+    PhysicalDeviceInfo info{};
+    info.index = i;
+    info.device = devices[i];
+    info.name = deviceProperties.deviceName;
+    info.uuid = getDeviceUUID(devices[i]);
+    info.type = deviceProperties.deviceType;
+    info.deviceLocalBytes = deviceLocalBytes;
+    info.suitable = isDeviceSuitable(devices[i]);
+    info.score = info.suitable ? scorePhysicalDevice(devices[i]) : -1;
+    physicalDeviceInfos.push_back(info);
+  }
+}
+
+void LveDevice::pickPhysicalDevice() {
+  std::string selector = deviceOverride;
+  if (selector.empty()) {
+    const char *env = std::getenv("LVE_DEVICE");
+    selector = env != nullptr ? env : "";
+  }
+
+  // Highest score wins and ties go to the lowest index, so the choice is deterministic. A name
+  // substring may match several GPUs; unsuitable ones are skipped.
+  const PhysicalDeviceInfo *chosen = nullptr;
+  std::string unsuitableMatches;
+  for (const auto &info : physicalDeviceInfos) {
+    if (!selector.empty() && !matchesDeviceOverride(info, selector)) {
+      continue;
+    }
+    if (!info.suitable) {
+      if (!selector.empty()) {
+        unsuitableMatches += (unsuitableMatches.empty() ? "" : ", ") + info.name + " [" +
+                             std::to_string(info.index) + "]";
+      }
+      continue;
+    }
+    if (chosen == nullptr || info.score > chosen->score) {
+      chosen = &info;
     }
   }
 
-  if (physicalDevice == VK_NULL_HANDLE) {
+  if (chosen == nullptr) {
+    if (!unsuitableMatches.empty()) {
+      throw std::runtime_error(
+          "no suitable GPU matches device selector " + selector + ", unsuitable: " + unsuitableMatches);
+    }
+    if (!selector.empty()) {
+      throw std::runtime_error("no GPU matches device selector: " + selector);
+    }
     throw std::runtime_error("failed to find a suitable GPU!");
   }
 
+  physicalDevice = chosen->device;
   vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-  std::cout << "physical device: " << properties.deviceName << std::endl;
+  std::cout << "physical device: " << properties.deviceName << " [" << chosen->index << "]"
+            << std::endl;
+}
+
+void LveDevice::printPhysicalDevices() {
+  auto typeName = [](VkPhysicalDeviceType type) {
+    switch (type) {
+      case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        return "discrete";
+      case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        return "integrated";
+      case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        return "virtual";
+      case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        return "cpu";
+      default:
+        return "other";
+    }
+  };
+
+  std::printf("%-5s %-10s %9s %8s  %-32s  %s\n", "index", "type", "VRAM MiB", "score", "uuid", "name");
+  for (const auto &info : physicalDeviceInfos) {
+    std::string score = info.suitable ? std::to_string(info.score) : "n/a";
+    std::printf(
+        "%-5u %-10s %9llu %8s  %-32s  %s\n",
+        info.index,
+        typeName(info.type),
+        static_cast<unsigned long long>(info.deviceLocalBytes >> 20),
+        score.c_str(),
+        info.uuid.c_str(),
+        info.name.c_str());
+  }
+}
+
+int64_t LveDevice::scorePhysicalDevice(VkPhysicalDevice device) {
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+  // Device type dominates; the remaining terms only order devices of the same type
+  int64_t score = 0;
+  switch (deviceProperties.deviceType) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+      score += 100000;
+      break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+      score += 50000;
+      break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+      score += 20000;
+      break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+      score += 1000;
+      break;
+    default:
+      break;
+  }
+
+  // One point per 16 MiB of the largest device-local heap, capped at 64 GiB
+  VkPhysicalDeviceMemoryProperties memoryProperties;
+  vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+  VkDeviceSize deviceLocalBytes = 0;
+  for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+    if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+      deviceLocalBytes = std::max(deviceLocalBytes, memoryProperties.memoryHeaps[i].size);
+    }
+  }
+  score += static_cast<int64_t>(std::min<VkDeviceSize>(deviceLocalBytes >> 24, 4096));
+
+  // Dedicated compute and transfer families allow async work alongside graphics
+  uint32_t queueFamilyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+  bool dedicatedCompute = false;
+  bool dedicatedTransfer = false;
+  for (const auto &queueFamily : queueFamilies) {
+    bool graphics = queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+    bool compute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
+    bool transfer = queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT;
+    dedicatedCompute |= compute && !graphics;
+    dedicatedTransfer |= transfer && !graphics && !compute;
+  }
+  score += dedicatedCompute ? 500 : 0;
+  score += dedicatedTransfer ? 250 : 0;
+
+  QueueFamilyIndices indices = findQueueFamilies(device);
+  score += indices.graphicsFamily == indices.presentFamily ? 250 : 0;
+
+  const VkPhysicalDeviceLimits &limits = deviceProperties.limits;
+  score += limits.maxImageDimension2D / 256;
+  score += limits.maxComputeSharedMemorySize / 1024;
+  score += limits.maxDrawIndirectCount > 1 ? 200 : 0;
+  return score;
+}
+
+std::string LveDevice::getDeviceUUID(VkPhysicalDevice device) {
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+  // deviceUUID needs 1.1; older drivers only expose the pipeline cache UUID
+  const uint8_t *uuid = deviceProperties.pipelineCacheUUID;
+  VkPhysicalDeviceIDProperties idProperties{};
+  idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+  if (instanceApiVersion >= VK_API_VERSION_1_1 && deviceProperties.apiVersion >= VK_API_VERSION_1_1) {
+    auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(
+        instance,
+        "vkGetPhysicalDeviceProperties2");
+    if (getProperties2 != nullptr) {
+      VkPhysicalDeviceProperties2 properties2{};
+      properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+      properties2.pNext = &idProperties;
+      getProperties2(device, &properties2);
+      uuid = idProperties.deviceUUID;
+    }
+  }
+
+  static const char hex[] = "0123456789abcdef";
+  std::string result;
+  for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+    result.push_back(hex[uuid[i] >> 4]);
+    result.push_back(hex[uuid[i] & 0xf]);
+  }
+  return result;
+}
+
+bool LveDevice::matchesDeviceOverride(
+    const PhysicalDeviceInfo &info, const std::string &deviceOverride) {
+  auto isDigit = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; };
+  if (std::all_of(deviceOverride.begin(), deviceOverride.end(), isDigit)) {
+    return std::to_string(info.index) == deviceOverride;
+  }
+
+  // UUIDs compare as lowercase hex with any dashes removed
+  std::string lowered = toLower(deviceOverride);
+  std::string uuid = lowered;
+  uuid.erase(std::remove(uuid.begin(), uuid.end(), '-'), uuid.end());
+  if (uuid == info.uuid) {
+    return true;
+  }
+  return toLower(info.name).find(lowered) != std::string::npos;
 }
 
 void LveDevice::createLogicalDevice() {
@@ -149,18 +446,71 @@ void LveDevice::createLogicalDevice() {
     queueCreateInfos.push_back(queueCreateInfo);
   }
 
-  VkPhysicalDeviceFeatures deviceFeatures = {};
-  deviceFeatures.samplerAnisotropy = VK_TRUE;
+  VkPhysicalDeviceFeatures supportedFeatures;
+  vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+  enabledFeatures = {};
+  enabledFeatures.samplerAnisotropy = VK_TRUE;
+  enabledFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+  enabledFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+  enabledFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+  enabledFeatures.occlusionQueryPrecise = supportedFeatures.occlusionQueryPrecise;
+  enabledFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+  enabledFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+  enabledFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+
+  enabledExtensions = deviceExtensions;
+  for (const char *extension : getSupportedOptionalExtensions(physicalDevice)) {
+    enabledExtensions.push_back(extension);
+  }
+
+  VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+  dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+  const bool dynamicRendering = checkDynamicRenderingSupport(physicalDevice);
+  if (dynamicRendering) {
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+    enabledExtensions.insert(
+        enabledExtensions.end(),
+        dynamicRenderingExtensions.begin(),
+        dynamicRenderingExtensions.end());
+  }
+
+  // Only the bits a bindless heap needs; non-uniform indexing is left to the shaders that want it
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+  descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+  descriptorIndexing = checkDescriptorIndexingSupport(physicalDevice);
+  if (descriptorIndexing) {
+    descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    enabledExtensions.insert(
+        enabledExtensions.end(),
+        descriptorIndexingExtensions.begin(),
+        descriptorIndexingExtensions.end());
+  }
+
+  void *featureChain = nullptr;
+  if (dynamicRendering) {
+    dynamicRenderingFeatures.pNext = featureChain;
+    featureChain = &dynamicRenderingFeatures;
+  }
+  if (descriptorIndexing) {
+    descriptorIndexingFeatures.pNext = featureChain;
+    featureChain = &descriptorIndexingFeatures;
+  }
 
   VkDeviceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  createInfo.pNext = featureChain;
 
   createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-  createInfo.pEnabledFeatures = &deviceFeatures;
-  createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-  createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+  createInfo.pEnabledFeatures = &enabledFeatures;
+  createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+  createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
   // might not really be necessary anymore because device specific validation layers
   // have been deprecated
@@ -171,12 +521,36 @@ void LveDevice::createLogicalDevice() {
     createInfo.enabledLayerCount = 0;
   }
 
-  if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device_) != VK_SUCCESS) {
+  if (vkCreateDevice(physicalDevice, &createInfo, getAllocator(), &device_) != VK_SUCCESS) {
     throw std::runtime_error("failed to create logical device!");
   }
 
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
   vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+
+  if (isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+    cmdDrawIndirectCount = (PFN_vkCmdDrawIndirectCountKHR)vkGetDeviceProcAddr(
+        device_,
+        "vkCmdDrawIndirectCountKHR");
+  }
+  if (dynamicRendering) {
+    cmdBeginRendering =
+        (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(device_, "vkCmdBeginRenderingKHR");
+    cmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(device_, "vkCmdEndRenderingKHR");
+    if (cmdBeginRendering == nullptr || cmdEndRendering == nullptr) {
+      cmdBeginRendering = nullptr;
+      cmdEndRendering = nullptr;
+    }
+  }
+  std::cout << "multiDrawIndirect: " << (supportsMultiDrawIndirect() ? "yes" : "no")
+            << ", drawIndirectCount: " << (supportsDrawIndirectCount() ? "yes" : "no")
+            << ", dynamicRendering: " << (supportsDynamicRendering() ? "yes" : "no")
+            << ", descriptorIndexing: " << (supportsDescriptorIndexing() ? "yes" : "no")
+            << ", pipelineStatisticsQuery: " << (supportsPipelineStatistics() ? "yes" : "no")
+            << ", textureCompressionBC: " << (supportsTextureCompressionBC() ? "yes" : "no")
+            << ", textureCompressionETC2: " << (supportsTextureCompressionETC2() ? "yes" : "no")
+            << ", textureCompressionASTC_LDR: " << (supportsTextureCompressionASTC() ? "yes" : "no")
+            << std::endl;
 }
 
 void LveDevice::createCommandPool() {
@@ -188,12 +562,12 @@ void LveDevice::createCommandPool() {
   poolInfo.flags =
       VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-  if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+  if (vkCreateCommandPool(device_, &poolInfo, getAllocator(), &commandPool) != VK_SUCCESS) {
     throw std::runtime_error("failed to create command pool!");
   }
 }
 
-void LveDevice::createSurface() { window.createWindowSurface(instance, &surface_); }
+void LveDevice::createSurface() { window.createWindowSurface(instance, &surface_, getAllocator()); }
 
 bool LveDevice::isDeviceSuitable(VkPhysicalDevice device) {
   QueueFamilyIndices indices = findQueueFamilies(device);
@@ -230,7 +604,7 @@ void LveDevice::setupDebugMessenger() {
   if (!enableValidationLayers) return;
   VkDebugUtilsMessengerCreateInfoEXT createInfo;
   populateDebugMessengerCreateInfo(createInfo);
-  if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+  if (CreateDebugUtilsMessengerEXT(instance, &createInfo, getAllocator(), &debugMessenger) != VK_SUCCESS) {
     throw std::runtime_error("failed to set up debug messenger!");
   }
 }
@@ -317,6 +691,157 @@ bool LveDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
   return requiredExtensions.empty();
 }
 
+std::vector<const char *> LveDevice::getSupportedOptionalExtensions(VkPhysicalDevice device) {
+  uint32_t extensionCount;
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+  vkEnumerateDeviceExtensionProperties(
+      device,
+      nullptr,
+      &extensionCount,
+      availableExtensions.data());
+
+  std::vector<const char *> supported;
+  for (const char *optional : optionalDeviceExtensions) {
+    for (const auto &extension : availableExtensions) {
+      if (strcmp(optional, extension.extensionName) == 0) {
+        supported.push_back(optional);
+        break;
+      }
+    }
+  }
+  return supported;
+}
+
+bool LveDevice::checkDynamicRenderingSupport(VkPhysicalDevice device) {
+  // The feature query and the extension's 1.1 dependencies need 1.1 on both sides
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(device, &deviceProperties);
+  if (instanceApiVersion < VK_API_VERSION_1_1 || deviceProperties.apiVersion < VK_API_VERSION_1_1) {
+    return false;
+  }
+
+  if (!hasDeviceExtensions(device, dynamicRenderingExtensions)) {
+    return false;
+  }
+
+  auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(
+      instance,
+      "vkGetPhysicalDeviceFeatures2");
+  if (getFeatures2 == nullptr) {
+    return false;
+  }
+  VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+  dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+  VkPhysicalDeviceFeatures2 features2{};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &dynamicRenderingFeatures;
+  getFeatures2(device, &features2);
+  return dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+}
+
+bool LveDevice::hasDeviceExtensions(
+    VkPhysicalDevice device, const std::vector<const char *> &extensions) {
+  uint32_t extensionCount;
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+  vkEnumerateDeviceExtensionProperties(
+      device,
+      nullptr,
+      &extensionCount,
+      availableExtensions.data());
+
+  std::set<std::string> missing(extensions.begin(), extensions.end());
+  for (const auto &extension : availableExtensions) {
+    missing.erase(extension.extensionName);
+  }
+  return missing.empty();
+}
+
+bool LveDevice::checkDescriptorIndexingSupport(VkPhysicalDevice device) {
+  // Like dynamic rendering, the feature and property queries need 1.1 on both sides
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(device, &deviceProperties);
+  if (instanceApiVersion < VK_API_VERSION_1_1 || deviceProperties.apiVersion < VK_API_VERSION_1_1) {
+    return false;
+  }
+  if (!hasDeviceExtensions(device, descriptorIndexingExtensions)) {
+    return false;
+  }
+
+  auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(
+      instance,
+      "vkGetPhysicalDeviceFeatures2");
+  auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(
+      instance,
+      "vkGetPhysicalDeviceProperties2");
+  if (getFeatures2 == nullptr || getProperties2 == nullptr) {
+    return false;
+  }
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+  indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+  VkPhysicalDeviceFeatures2 features2{};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &indexingFeatures;
+  getFeatures2(device, &features2);
+  if (indexingFeatures.runtimeDescriptorArray != VK_TRUE ||
+      indexingFeatures.descriptorBindingPartiallyBound != VK_TRUE ||
+      indexingFeatures.descriptorBindingUpdateUnusedWhilePending != VK_TRUE ||
+      indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind != VK_TRUE ||
+      indexingFeatures.descriptorBindingSampledImageUpdateAfterBind != VK_TRUE) {
+    return false;
+  }
+
+  descriptorIndexingProperties = {};
+  descriptorIndexingProperties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+  VkPhysicalDeviceProperties2 properties2{};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &descriptorIndexingProperties;
+  getProperties2(device, &properties2);
+  return true;
+}
+
+bool LveDevice::isExtensionEnabled(const char *extensionName) {
+  for (const char *extension : enabledExtensions) {
+    if (strcmp(extension, extensionName) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void LveDevice::cmdDrawIndirectCountKHR(
+    VkCommandBuffer commandBuffer,
+    VkBuffer buffer,
+    VkDeviceSize offset,
+    VkBuffer countBuffer,
+    VkDeviceSize countBufferOffset,
+    uint32_t maxDrawCount,
+    uint32_t stride) {
+  assert(cmdDrawIndirectCount != nullptr && "VK_KHR_draw_indirect_count is not enabled");
+  cmdDrawIndirectCount(
+      commandBuffer,
+      buffer,
+      offset,
+      countBuffer,
+      countBufferOffset,
+      maxDrawCount,
+      stride);
+}
+
+void LveDevice::cmdBeginRenderingKHR(
+    VkCommandBuffer commandBuffer, const VkRenderingInfoKHR *renderingInfo) {
+  assert(cmdBeginRendering != nullptr && "VK_KHR_dynamic_rendering is not enabled");
+  cmdBeginRendering(commandBuffer, renderingInfo);
+}
+
+void LveDevice::cmdEndRenderingKHR(VkCommandBuffer commandBuffer) {
+  assert(cmdEndRendering != nullptr && "VK_KHR_dynamic_rendering is not enabled");
+  cmdEndRendering(commandBuffer);
+}
+
 QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
   QueueFamilyIndices indices;
 
@@ -374,16 +899,20 @@ SwapChainSupportDetails LveDevice::querySwapChainSupport(VkPhysicalDevice device
   return details;
 }
 
+bool LveDevice::supportsFormat(
+    VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) {
+  VkFormatProperties props;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+  if (tiling == VK_IMAGE_TILING_LINEAR) {
+    return (props.linearTilingFeatures & features) == features;
+  }
+  return tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features;
+}
+
 VkFormat LveDevice::findSupportedFormat(
     const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
   for (VkFormat format : candidates) {
-    VkFormatProperties props;
-    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
-
-    if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features) {
-      return format;
-    } else if (
-        tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features) {
+    if (supportsFormat(format, tiling, features)) {
       return format;
     }
   }
@@ -415,7 +944,7 @@ void LveDevice::createBuffer(
   bufferInfo.usage = usage;
   bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-  if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+  if (vkCreateBuffer(device_, &bufferInfo, getAllocator(), &buffer) != VK_SUCCESS) {
     throw std::runtime_error("failed to create vertex buffer!");
   }
 
@@ -427,7 +956,7 @@ void LveDevice::createBuffer(
   allocInfo.allocationSize = memRequirements.size;
   allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+  if (vkAllocateMemory(device_, &allocInfo, getAllocator(), &bufferMemory) != VK_SUCCESS) {
     throw std::runtime_error("failed to allocate vertex buffer memory!");
   }
 
@@ -460,8 +989,21 @@ void LveDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &commandBuffer;
 
-  vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphicsQueue_);
+  if (submitThread) {
+    // The queue belongs to the submit thread, so wait on a fence instead of the queue
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(device_, &fenceInfo, getAllocator(), &fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create single time command fence!");
+    }
+    submitThread->submit({graphicsQueue_, commandBuffer, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, fence});
+    vkWaitForFences(device_, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(device_, fence, getAllocator());
+  } else {
+    vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphicsQueue_);
+  }
 
   vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
 }
@@ -510,7 +1052,7 @@ void LveDevice::createImageWithInfo(
     VkMemoryPropertyFlags properties,
     VkImage &image,
     VkDeviceMemory &imageMemory) {
-  if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+  if (vkCreateImage(device_, &imageInfo, getAllocator(), &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
 
@@ -522,7 +1064,7 @@ void LveDevice::createImageWithInfo(
   allocInfo.allocationSize = memRequirements.size;
   allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
+  if (vkAllocateMemory(device_, &allocInfo, getAllocator(), &imageMemory) != VK_SUCCESS) {
     throw std::runtime_error("failed to allocate image memory!");
   }
 
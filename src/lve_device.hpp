@@ -1,8 +1,14 @@
 #pragma once
 
+#include "lve_host_allocator.hpp"
+#include "lve_submit_thread.hpp"
 #include "lve_window.hpp"
 
 // std lib headers
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -22,6 +28,18 @@ struct QueueFamilyIndices {
   bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
 };
 
+// A physical device as seen by enumeratePhysicalDevices
+struct PhysicalDeviceInfo {
+  uint32_t index;
+  VkPhysicalDevice device;
+  std::string name;
+  std::string uuid;
+  VkPhysicalDeviceType type;
+  VkDeviceSize deviceLocalBytes;
+  bool suitable;
+  int64_t score;
+};
+
 class LveDevice {
  public:
 #ifdef NDEBUG
@@ -30,7 +48,10 @@ class LveDevice {
   const bool enableValidationLayers = true;
 #endif
 
-  LveDevice(LveWindow &window);
+  // deviceOverride selects a GPU by index, UUID or name substring; when empty the
+  // LVE_DEVICE environment variable is used, and otherwise the highest score wins.
+  // With trackHostAllocations every Vulkan object is created through hostAllocator.
+  LveDevice(LveWindow &window, const std::string &deviceOverride = "", bool trackHostAllocations = true);
   ~LveDevice();
 
   // Not copyable or movable
@@ -44,10 +65,60 @@ class LveDevice {
   VkSurfaceKHR surface() { return surface_; }
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
+  VkPhysicalDevice getPhysicalDevice() { return physicalDevice; }
+  // Pass to every vkCreate*/vkDestroy*/vkAllocateMemory/vkFreeMemory on this device;
+  // null when host allocations are not tracked
+  const VkAllocationCallbacks *getAllocator() const {
+    return trackHostAllocations ? hostAllocator.getCallbacks() : nullptr;
+  }
+  LveHostAllocator &getHostAllocator() { return hostAllocator; }
+  bool tracksHostAllocations() const { return trackHostAllocations; }
+  // Every enumerated device with its score, in enumeration order
+  const std::vector<PhysicalDeviceInfo> &getPhysicalDeviceInfos() { return physicalDeviceInfos; }
+  void printPhysicalDevices();
+  // Scores and prints every GPU against window's surface without creating a logical device.
+  // The device override and LVE_DEVICE are ignored.
+  static void listPhysicalDevices(LveWindow &window);
+
+  // Optional capabilities, resolved in createLogicalDevice
+  bool supportsMultiDrawIndirect() { return enabledFeatures.multiDrawIndirect == VK_TRUE; }
+  bool supportsDrawIndirectFirstInstance() {
+    return enabledFeatures.drawIndirectFirstInstance == VK_TRUE;
+  }
+  bool supportsDrawIndirectCount() { return cmdDrawIndirectCount != nullptr; }
+  bool supportsPipelineStatistics() { return enabledFeatures.pipelineStatisticsQuery == VK_TRUE; }
+  // Occlusion queries count exact samples rather than only zero or non-zero
+  bool supportsPreciseOcclusion() { return enabledFeatures.occlusionQueryPrecise == VK_TRUE; }
+  // Block-compressed texture families; individual formats still go through supportsFormat()
+  bool supportsTextureCompressionBC() { return enabledFeatures.textureCompressionBC == VK_TRUE; }
+  bool supportsTextureCompressionETC2() { return enabledFeatures.textureCompressionETC2 == VK_TRUE; }
+  bool supportsTextureCompressionASTC() {
+    return enabledFeatures.textureCompressionASTC_LDR == VK_TRUE;
+  }
+  // VK_KHR_dynamic_rendering: render without VkRenderPass or VkFramebuffer objects
+  bool supportsDynamicRendering() { return cmdBeginRendering != nullptr; }
+  // VK_EXT_descriptor_indexing: partially bound, update-after-bind runtime descriptor arrays
+  bool supportsDescriptorIndexing() { return descriptorIndexing; }
+  // Valid when supportsDescriptorIndexing()
+  const VkPhysicalDeviceDescriptorIndexingPropertiesEXT &getDescriptorIndexingProperties() {
+    return descriptorIndexingProperties;
+  }
+  bool isExtensionEnabled(const char *extensionName);
+  void cmdDrawIndirectCountKHR(
+      VkCommandBuffer commandBuffer,
+      VkBuffer buffer,
+      VkDeviceSize offset,
+      VkBuffer countBuffer,
+      VkDeviceSize countBufferOffset,
+      uint32_t maxDrawCount,
+      uint32_t stride);
+  void cmdBeginRenderingKHR(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR *renderingInfo);
+  void cmdEndRenderingKHR(VkCommandBuffer commandBuffer);
 
   SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
   QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
+  bool supportsFormat(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features);
   VkFormat findSupportedFormat(
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
@@ -70,39 +141,106 @@ class LveDevice {
       VkImage &image,
       VkDeviceMemory &imageMemory);
 
+  // Deferred destruction: resources are tagged with the frame that may still use
+  // them and released once that frame's fence has signalled
+  uint64_t currentFrameNumber() { return frameNumber; }
+  void advanceFrame() { frameNumber++; }
+  void retireFrames(uint64_t completedFrameNumber);
+  void deferDestroy(std::function<void()> deleter);
+  void deferDestroyBuffer(VkBuffer buffer, VkDeviceMemory memory);
+  void deferDestroyImage(VkImage image, VkImageView imageView, VkDeviceMemory memory);
+  // Waits for the device and runs every pending deleter
+  void flushDeletionQueue();
+
+  // From here on every graphics and present queue operation goes through a dedicated thread,
+  // including the single time commands above
+  void startSubmitThread();
+  // Null unless startSubmitThread() was called
+  LveSubmitThread *getSubmitThread() { return submitThread.get(); }
+  // Drains the submit thread first, as vkDeviceWaitIdle needs every queue to itself
+  void waitIdle();
+
   VkPhysicalDeviceProperties properties;
 
  private:
+  struct EnumerateOnly {};
+  // Instance, surface and physicalDeviceInfos only, for listPhysicalDevices
+  LveDevice(LveWindow &window, EnumerateOnly);
+
+  struct PendingDeletion {
+    uint64_t frameNumber;
+    std::function<void()> deleter;
+  };
+
   void createInstance();
   void setupDebugMessenger();
   void createSurface();
+  void enumeratePhysicalDevices();
   void pickPhysicalDevice();
   void createLogicalDevice();
   void createCommandPool();
 
   // helper functions
   bool isDeviceSuitable(VkPhysicalDevice device);
+  int64_t scorePhysicalDevice(VkPhysicalDevice device);
+  std::string getDeviceUUID(VkPhysicalDevice device);
+  bool matchesDeviceOverride(const PhysicalDeviceInfo &info, const std::string &deviceOverride);
   std::vector<const char *> getRequiredExtensions();
   bool checkValidationLayerSupport();
   QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
   void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
   void hasGflwRequiredInstanceExtensions();
   bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+  std::vector<const char *> getSupportedOptionalExtensions(VkPhysicalDevice device);
+  bool hasDeviceExtensions(VkPhysicalDevice device, const std::vector<const char *> &extensions);
+  bool checkDynamicRenderingSupport(VkPhysicalDevice device);
+  bool checkDescriptorIndexingSupport(VkPhysicalDevice device);
   SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
+  // Outlives every object below, as members are destroyed after the destructor body
+  LveHostAllocator hostAllocator;
+  bool trackHostAllocations;
   VkInstance instance;
   VkDebugUtilsMessengerEXT debugMessenger;
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+  std::vector<PhysicalDeviceInfo> physicalDeviceInfos;
+  std::string deviceOverride;
+  uint32_t instanceApiVersion = VK_API_VERSION_1_0;
   LveWindow &window;
   VkCommandPool commandPool;
+  std::unique_ptr<LveSubmitThread> submitThread;
 
-  VkDevice device_;
+  VkDevice device_ = VK_NULL_HANDLE;
   VkSurfaceKHR surface_;
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
 
+  VkPhysicalDeviceFeatures enabledFeatures{};
+  std::vector<const char *> enabledExtensions;
+  PFN_vkCmdDrawIndirectCountKHR cmdDrawIndirectCount = nullptr;
+  PFN_vkCmdBeginRenderingKHR cmdBeginRendering = nullptr;
+  PFN_vkCmdEndRenderingKHR cmdEndRendering = nullptr;
+  bool descriptorIndexing = false;
+  VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties{};
+
+  uint64_t frameNumber = 1;
+  std::mutex deletionMutex;
+  std::deque<PendingDeletion> deletionQueue;
+
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
   const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  const std::vector<const char *> optionalDeviceExtensions = {
+      VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME};
+  // Enabled together, and only when the feature bit is set; the first two are what
+  // dynamic rendering requires below Vulkan 1.2
+  const std::vector<const char *> dynamicRenderingExtensions = {
+      VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+      VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+      VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
+  // Same rules; maintenance3 is required by descriptor indexing below Vulkan 1.2
+  const std::vector<const char *> descriptorIndexingExtensions = {
+      VK_KHR_MAINTENANCE_3_EXTENSION_NAME,
+      VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
 };
 
 }  // namespace lve
\ No newline at end of file
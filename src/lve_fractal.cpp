@@ -0,0 +1,218 @@
+#include "lve_fractal.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#define _USE_MATH_DEFINES
+#include<cmath>
+
+namespace lve {
+
+    LveFractal::LveFractal(uint32_t maxTriangles, float refinePixelSize)
+        : maxTriangles{maxTriangles}, refinePixelSize{refinePixelSize} {
+        assert(maxTriangles > 0 && "Fractal needs a triangle budget");
+        vertices.resize(maxTriangles * 3, LveModel::Vertex{{0.0f, 0.0f}});
+        slotNodes.resize(maxTriangles);
+        slotStamps.resize(maxTriangles, 0);
+        slotLive.resize(maxTriangles, false);
+        slotDirty.resize(maxTriangles, false);
+        blocks.resize((maxTriangles + SLOTS_PER_BLOCK - 1) / SLOTS_PER_BLOCK, Block{});
+        for (uint32_t slot = 0; slot < maxTriangles; slot++) {
+            freeSlots.push(slot);
+        }
+    }
+
+    double LveFractal::triangleHeight(double length) {
+        return std::sin(M_PI / 3) * length;
+    }
+
+    bool LveFractal::update(const LveCamera &camera, float viewportWidth) {
+        stats = {};
+        glm::dvec2 viewMin, viewMax;
+        camera.getViewBounds(viewMin, viewMax);
+
+        // Keep float vertex positions small relative to the view
+        glm::dvec2 toCamera = (camera.getCenter() - anchor) * camera.getZoom();
+        if (std::max(std::abs(toCamera.x), std::abs(toCamera.y)) > REBASE_DISTANCE) {
+            rebase(camera.getCenter());
+        }
+
+        const double pixelsPerUnit = camera.getZoom() * 0.5 * viewportWidth;
+        auto overlapsView = [&](const Node &node) {
+            return node.x <= viewMax.x && node.x + node.length >= viewMin.x &&
+                   node.y - triangleHeight(node.length) <= viewMax.y && node.y >= viewMin.y;
+        };
+
+        stamp++;
+        level.clear();
+        nextLevel.clear();
+        newLeaves.clear();
+
+        Node root{-1.0, 1.0, 2.0, 0, 0};
+        if (overlapsView(root)) {
+            level.push_back(root);
+        }
+
+        // Breadth first: every node on a level has the same size, so the budget
+        // is always spent on the largest on-screen triangles first
+        uint32_t leafCount = 0;
+        auto emitLeaf = [&](const Node &node) {
+            leafCount++;
+            auto found = leafSlots.find(makeKey(node));
+            if (found != leafSlots.end()) {
+                slotStamps[found->second] = stamp;
+            } else {
+                newLeaves.push_back(node);
+            }
+        };
+
+        while (!level.empty()) {
+            stats.visitedNodes += static_cast<uint32_t>(level.size());
+            const double length = level[0].length;
+            const bool wantSplit =
+                length * pixelsPerUnit > refinePixelSize && level[0].depth < MAX_DEPTH;
+
+            for (size_t i = 0; i < level.size(); i++) {
+                const Node &node = level[i];
+                // Every node still waiting needs at least one slot of its own
+                size_t reserved = leafCount + nextLevel.size() + (level.size() - i - 1);
+                if (!wantSplit || reserved + 3 > maxTriangles) {
+                    emitLeaf(node);
+                    continue;
+                }
+
+                const double half = node.length / 2;
+                Node children[3] = {
+                    {node.x, node.y, half, node.path * 3, node.depth + 1},
+                    {node.x + half, node.y, half, node.path * 3 + 1, node.depth + 1},
+                    {node.x + half / 2, node.y - triangleHeight(half), half, node.path * 3 + 2, node.depth + 1},
+                };
+                for (const Node &child : children) {
+                    if (overlapsView(child)) {
+                        nextLevel.push_back(child);
+                    }
+                }
+            }
+            std::swap(level, nextLevel);
+            nextLevel.clear();
+        }
+
+        // Collapse leaves that were not reached this time
+        for (uint32_t slot = 0; slot < highWaterSlot; slot++) {
+            if (slotLive[slot] && slotStamps[slot] != stamp) {
+                freeSlot(slot);
+                stats.removedLeaves++;
+            }
+        }
+
+        for (const Node &node : newLeaves) {
+            uint32_t slot = allocateSlot();
+            leafSlots[makeKey(node)] = slot;
+            slotStamps[slot] = stamp;
+            writeSlot(slot, node);
+        }
+        stats.addedLeaves = static_cast<uint32_t>(newLeaves.size());
+        stats.leafCount = leafCount;
+
+        return !dirtySlots.empty();
+    }
+
+    void LveFractal::rebase(const glm::dvec2 &newAnchor) {
+        anchor = newAnchor;
+        for (uint32_t slot = 0; slot < highWaterSlot; slot++) {
+            if (slotLive[slot]) {
+                writeSlot(slot, slotNodes[slot]);
+            }
+        }
+        stats.rebased = true;
+    }
+
+    uint32_t LveFractal::allocateSlot() {
+        assert(!freeSlots.empty() && "Fractal triangle budget exceeded");
+        uint32_t slot = freeSlots.top();
+        freeSlots.pop();
+        slotLive[slot] = true;
+        highWaterSlot = std::max(highWaterSlot, slot + 1);
+        return slot;
+    }
+
+    void LveFractal::freeSlot(uint32_t slot) {
+        leafSlots.erase(makeKey(slotNodes[slot]));
+        slotLive[slot] = false;
+        clearSlot(slot);
+        freeSlots.push(slot);
+        while (highWaterSlot > 0 && !slotLive[highWaterSlot - 1]) {
+            highWaterSlot--;
+        }
+    }
+
+    void LveFractal::writeSlot(uint32_t slot, const Node &node) {
+        slotNodes[slot] = node;
+        const double x = node.x - anchor.x;
+        const double y = node.y - anchor.y;
+        const double length = node.length;
+        LveModel::Vertex *triangle = &vertices[slot * 3];
+        triangle[0].position = {static_cast<float>(x), static_cast<float>(y)};
+        triangle[1].position = {static_cast<float>(x + length / 2), static_cast<float>(y - triangleHeight(length))};
+        triangle[2].position = {static_cast<float>(x + length), static_cast<float>(y)};
+        markDirty(slot);
+    }
+
+    void LveFractal::clearSlot(uint32_t slot) {
+        LveModel::Vertex *triangle = &vertices[slot * 3];
+        triangle[0].position = triangle[1].position = triangle[2].position = {0.0f, 0.0f};
+        markDirty(slot);
+    }
+
+    void LveFractal::markDirty(uint32_t slot) {
+        if (!slotDirty[slot]) {
+            slotDirty[slot] = true;
+            dirtySlots.push_back(slot);
+        }
+    }
+
+    void LveFractal::takeChanges(std::vector<Span> &spans, std::vector<uint32_t> &dirtyBlocks) {
+        spans.clear();
+        dirtyBlocks.clear();
+        std::sort(dirtySlots.begin(), dirtySlots.end());
+        for (uint32_t slot : dirtySlots) {
+            if (!spans.empty() && spans.back().firstVertex + spans.back().vertexCount == slot * 3) {
+                spans.back().vertexCount += 3;
+            } else {
+                spans.push_back({slot * 3, 3});
+            }
+
+            uint32_t block = slot / SLOTS_PER_BLOCK;
+            if (dirtyBlocks.empty() || dirtyBlocks.back() != block) {
+                dirtyBlocks.push_back(block);
+                updateBlock(block);
+            }
+            slotDirty[slot] = false;
+        }
+        dirtySlots.clear();
+    }
+
+    void LveFractal::updateBlock(uint32_t blockIndex) {
+        Block &block = blocks[blockIndex];
+        const uint32_t firstSlot = blockIndex * SLOTS_PER_BLOCK;
+        const uint32_t endSlot = std::min(firstSlot + SLOTS_PER_BLOCK, maxTriangles);
+
+        block = {};
+        block.firstVertex = firstSlot * 3;
+        bool empty = true;
+        for (uint32_t slot = firstSlot; slot < endSlot; slot++) {
+            if (!slotLive[slot]) {
+                continue;
+            }
+            for (uint32_t v = slot * 3; v < slot * 3 + 3; v++) {
+                if (empty) {
+                    block.minBounds = block.maxBounds = vertices[v].position;
+                    empty = false;
+                }
+                block.minBounds = glm::min(block.minBounds, vertices[v].position);
+                block.maxBounds = glm::max(block.maxBounds, vertices[v].position);
+            }
+            block.vertexCount = (slot + 1 - firstSlot) * 3;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "lve_camera.hpp"
+#include "lve_model.hpp"
+
+// std
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+    // View-dependent Sierpinski subdivision. Each update walks the tree
+    // breadth-first, descending only into nodes that overlap the view and are
+    // still larger than refinePixelSize on screen, until the triangle budget is
+    // spent. The resulting leaves live in fixed slots of a vertex array; only
+    // slots whose leaf changed are reported as dirty so callers can re-upload
+    // just those spans.
+    class LveFractal {
+        public:
+            // Leaf keys pack depth into the top 6 bits and the base-3 path into the rest
+            static constexpr uint32_t MAX_DEPTH = 36;
+            static constexpr uint32_t SLOTS_PER_BLOCK = 64;
+            // Rebase vertex positions once the camera is this many view half-widths away from the anchor
+            static constexpr double REBASE_DISTANCE = 16.0;
+
+            struct Block {
+                glm::vec2 minBounds;
+                glm::vec2 maxBounds;
+                uint32_t firstVertex;
+                uint32_t vertexCount;
+            };
+
+            struct Span {
+                uint32_t firstVertex;
+                uint32_t vertexCount;
+            };
+
+            struct Stats {
+                uint32_t leafCount = 0;
+                uint32_t addedLeaves = 0;
+                uint32_t removedLeaves = 0;
+                uint32_t visitedNodes = 0;
+                bool rebased = false;
+            };
+
+            LveFractal(uint32_t maxTriangles, float refinePixelSize = 2.0f);
+
+            LveFractal(const LveFractal &) = delete;
+            LveFractal &operator=(const LveFractal &) = delete;
+
+            // Returns true when any slot changed
+            bool update(const LveCamera &camera, float viewportWidth);
+
+            const std::vector<LveModel::Vertex> &getVertices() const { return vertices; }
+            // Vertex spans and cull blocks touched since the last call
+            void takeChanges(std::vector<Span> &spans, std::vector<uint32_t> &dirtyBlocks);
+            const Block &getBlock(uint32_t index) const { return blocks[index]; }
+
+            // Vertices up to the highest live slot; everything past it is degenerate
+            uint32_t getVertexCount() const { return highWaterSlot * 3; }
+            uint32_t getBlockCount() const { return (highWaterSlot + SLOTS_PER_BLOCK - 1) / SLOTS_PER_BLOCK; }
+            uint32_t getMaxBlockCount() const { return static_cast<uint32_t>(blocks.size()); }
+            uint32_t getMaxTriangles() const { return maxTriangles; }
+            const glm::dvec2 &getAnchor() const { return anchor; }
+            const Stats &getStats() const { return stats; }
+
+        private:
+            struct Node {
+                double x;
+                double y;
+                double length;
+                uint64_t path;
+                uint32_t depth;
+            };
+
+            static uint64_t makeKey(const Node &node) {
+                return (static_cast<uint64_t>(node.depth) << 58) | node.path;
+            }
+            static double triangleHeight(double length);
+
+            void rebase(const glm::dvec2 &newAnchor);
+            uint32_t allocateSlot();
+            void freeSlot(uint32_t slot);
+            void writeSlot(uint32_t slot, const Node &node);
+            void clearSlot(uint32_t slot);
+            void markDirty(uint32_t slot);
+            void updateBlock(uint32_t block);
+
+            uint32_t maxTriangles;
+            float refinePixelSize;
+            glm::dvec2 anchor{0.0, 0.0};
+
+            std::vector<LveModel::Vertex> vertices;
+            std::vector<Node> slotNodes;
+            std::vector<uint32_t> slotStamps;
+            std::vector<bool> slotLive;
+            std::unordered_map<uint64_t, uint32_t> leafSlots;
+            std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> freeSlots;
+            uint32_t highWaterSlot = 0;
+            uint32_t stamp = 0;
+
+            std::vector<uint32_t> dirtySlots;
+            std::vector<bool> slotDirty;
+            std::vector<Block> blocks;
+
+            std::vector<Node> level;
+            std::vector<Node> nextLevel;
+            std::vector<Node> newLeaves;
+            Stats stats{};
+    };
+}
@@ -0,0 +1,56 @@
+#include "lve_frame_limiter.hpp"
+
+// std
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace lve {
+
+    // Older samples stop counting so the estimate follows changes in system load
+    static constexpr uint64_t MAX_SAMPLES = 1000;
+
+    LveFrameLimiter::LveFrameLimiter(double framesPerSecond) {
+        if (!(framesPerSecond > 0.0)) {
+            throw std::runtime_error("frame limit must be positive");
+        }
+        period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+    }
+
+    void LveFrameLimiter::wait() {
+        auto now = Clock::now();
+        if (!started || now > nextFrame + period) {
+            nextFrame = now;
+            started = true;
+        } else {
+            preciseSleep(nextFrame);
+        }
+        nextFrame += period;
+    }
+
+    void LveFrameLimiter::preciseSleep(Clock::time_point deadline) {
+        auto sleepStart = Clock::now();
+        while (std::chrono::duration<double>(deadline - Clock::now()).count() > estimate) {
+            auto start = Clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            double observed = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (samples < MAX_SAMPLES) {
+                samples++;
+            } else {
+                m2 *= static_cast<double>(MAX_SAMPLES - 1) / MAX_SAMPLES;
+            }
+            double delta = observed - mean;
+            mean += delta / samples;
+            m2 += delta * (observed - mean);
+            estimate = mean + std::sqrt(m2 / (samples - 1));
+        }
+
+        auto spinStart = Clock::now();
+        while (Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        sleepSeconds += std::chrono::duration<double>(spinStart - sleepStart).count();
+        spinSeconds += std::chrono::duration<double>(Clock::now() - spinStart).count();
+    }
+}
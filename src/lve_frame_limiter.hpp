@@ -0,0 +1,41 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <cstdint>
+
+namespace lve {
+
+    // Paces frames to a fixed rate. OS sleeps overshoot by anything from tens of microseconds to
+    // a few milliseconds, so wait() sleeps in short steps only while the time left exceeds the
+    // overshoot it has measured so far, then spins the remainder.
+    class LveFrameLimiter {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            explicit LveFrameLimiter(double framesPerSecond);
+
+            // Blocks until the next frame is due. A frame that starts more than a whole period
+            // late restarts the schedule instead of rushing to catch up.
+            void wait();
+
+            double getSleepSeconds() const { return sleepSeconds; }
+            double getSpinSeconds() const { return spinSeconds; }
+
+        private:
+            void preciseSleep(Clock::time_point deadline);
+
+            Clock::duration period;
+            Clock::time_point nextFrame{};
+            bool started = false;
+
+            // Running mean and variance of how long a 1 ms sleep really takes
+            double estimate = 5.0e-3;
+            double mean = 5.0e-3;
+            double m2 = 0.0;
+            uint64_t samples = 1;
+
+            double sleepSeconds = 0.0;
+            double spinSeconds = 0.0;
+    };
+}
@@ -0,0 +1,318 @@
+#include "lve_frame_readback.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace lve {
+
+    static bool isBgr(VkFormat format) {
+        return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+    }
+
+    LveFrameReadback::LveFrameReadback(
+        LveDevice &device,
+        VkExtent2D extent,
+        VkFormat format,
+        uint32_t slotCount,
+        const std::string &outputDirectory,
+        uint32_t writerCount)
+        : LveFrameReadback{
+              device,
+              extent,
+              format,
+              slotCount,
+              [outputDirectory](const Frame &frame) {
+                  char name[32];
+                  std::snprintf(name, sizeof(name), "frame_%06llu.ppm", static_cast<unsigned long long>(frame.number));
+                  writePpm((std::filesystem::path{outputDirectory} / name).string(), frame);
+              },
+              writerCount} {
+        std::filesystem::create_directories(outputDirectory);
+    }
+
+    LveFrameReadback::LveFrameReadback(
+        LveDevice &device,
+        VkExtent2D extent,
+        VkFormat format,
+        uint32_t slotCount,
+        FrameSink sink,
+        uint32_t writerCount)
+        : lveDevice{device}, extent{extent}, format{format}, sink{std::move(sink)} {
+        if (!isFormatSupported(format)) {
+            throw std::runtime_error("frame readback supports 8-bit RGBA and BGRA formats only");
+        }
+        frameSize = VkDeviceSize{extent.width} * extent.height * 4;
+
+        slots.resize(slotCount);
+        for (auto &slot : slots) {
+            createSlot(slot);
+        }
+        for (uint32_t i = 0; i < std::max(writerCount, 1u); i++) {
+            writers.emplace_back(&LveFrameReadback::writerLoop, this);
+        }
+    }
+
+    LveFrameReadback::~LveFrameReadback() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        for (auto &writer : writers) {
+            writer.join();
+        }
+
+        for (auto &slot : slots) {
+            vkUnmapMemory(lveDevice.device(), slot.memory);
+            lveDevice.deferDestroyBuffer(slot.buffer, slot.memory);
+        }
+    }
+
+    bool LveFrameReadback::isFormatSupported(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void LveFrameReadback::createSlot(Slot &slot) {
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = frameSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(lveDevice.device(), &bufferInfo, lveDevice.getAllocator(), &slot.buffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create readback buffer");
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(lveDevice.device(), slot.buffer, &requirements);
+
+        // Cached memory makes the CPU-side copy several times faster than write-combined memory
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(lveDevice.getPhysicalDevice(), &memoryProperties);
+        const VkMemoryPropertyFlags preferred[] = {
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+        uint32_t memoryType = UINT32_MAX;
+        for (VkMemoryPropertyFlags flags : preferred) {
+            for (uint32_t i = 0; i < memoryProperties.memoryTypeCount && memoryType == UINT32_MAX; i++) {
+                if ((requirements.memoryTypeBits & (1u << i)) &&
+                    (memoryProperties.memoryTypes[i].propertyFlags & flags) == flags) {
+                    memoryType = i;
+                }
+            }
+            if (memoryType != UINT32_MAX) {
+                break;
+            }
+        }
+        if (memoryType == UINT32_MAX) {
+            throw std::runtime_error("no host-visible memory for frame readback");
+        }
+        slot.coherent = memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = memoryType;
+        if (vkAllocateMemory(lveDevice.device(), &allocInfo, lveDevice.getAllocator(), &slot.memory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate readback memory");
+        }
+        vkBindBufferMemory(lveDevice.device(), slot.buffer, slot.memory, 0);
+        vkMapMemory(lveDevice.device(), slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped);
+    }
+
+    void LveFrameReadback::recordCopy(VkCommandBuffer commandBuffer, uint32_t slot, VkImage image) {
+        Slot &target = slots[slot];
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {extent.width, extent.height, 1};
+        vkCmdCopyImageToBuffer(
+            commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target.buffer, 1, &region);
+
+        // The fence wait alone does not make transfer writes visible to the host
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = target.buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        target.pending = true;
+        target.frameNumber = nextFrameNumber++;
+    }
+
+    void LveFrameReadback::collect(uint32_t slot) {
+        rethrowWriterError();
+        Slot &source = slots[slot];
+        if (!source.pending) {
+            return;
+        }
+        source.pending = false;
+
+        if (!source.coherent) {
+            VkMappedMemoryRange range{};
+            range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = source.memory;
+            range.offset = 0;
+            range.size = VK_WHOLE_SIZE;
+            vkInvalidateMappedMemoryRanges(lveDevice.device(), 1, &range);
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+        if (queue.size() >= MAX_QUEUED_FRAMES) {
+            // Writers fell behind; wait rather than drop frames from a capture
+            auto stallStart = std::chrono::steady_clock::now();
+            queueChanged.wait(lock, [this]() { return queue.size() < MAX_QUEUED_FRAMES || writerError; });
+            stalls++;
+            stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stallStart).count();
+        }
+
+        PendingFrame frame{};
+        frame.number = source.frameNumber;
+        if (!freeBuffers.empty()) {
+            frame.pixels = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+        lock.unlock();
+
+        // Copy out so the slot can be reused by the frame about to be recorded
+        frame.pixels.resize(frameSize);
+        std::memcpy(frame.pixels.data(), source.mapped, frameSize);
+
+        lock.lock();
+        queue.push_back(std::move(frame));
+        lock.unlock();
+        queueChanged.notify_one();
+    }
+
+    void LveFrameReadback::collectAll() {
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < slots.size(); i++) {
+            if (slots[i].pending) {
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return slots[a].frameNumber < slots[b].frameNumber;
+        });
+        for (uint32_t slot : order) {
+            collect(slot);
+        }
+    }
+
+    void LveFrameReadback::writerLoop() {
+        const bool swapRedBlue = isBgr(format);
+        Frame frame{};
+        frame.width = extent.width;
+        frame.height = extent.height;
+
+        while (true) {
+            PendingFrame pending;
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                pending = std::move(queue.front());
+                queue.pop_front();
+                busyWriters++;
+            }
+            queueChanged.notify_all();
+
+            auto writeStart = std::chrono::steady_clock::now();
+            std::exception_ptr error;
+            try {
+                const size_t pixelCount = size_t{extent.width} * extent.height;
+                frame.number = pending.number;
+                frame.rgb.resize(pixelCount * 3);
+                const uint8_t *src = pending.pixels.data();
+                uint8_t *dst = frame.rgb.data();
+                for (size_t i = 0; i < pixelCount; i++, src += 4, dst += 3) {
+                    dst[0] = swapRedBlue ? src[2] : src[0];
+                    dst[1] = src[1];
+                    dst[2] = swapRedBlue ? src[0] : src[2];
+                }
+                sink(frame);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                busyWriters--;
+                freeBuffers.push_back(std::move(pending.pixels));
+                if (error) {
+                    if (!writerError) {
+                        writerError = error;
+                    }
+                } else {
+                    framesWritten++;
+                    writeSeconds += seconds;
+                }
+            }
+            queueChanged.notify_all();
+        }
+    }
+
+    void LveFrameReadback::rethrowWriterError() {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (writerError) {
+            std::exception_ptr error = writerError;
+            writerError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void LveFrameReadback::writePpm(const std::string &path, const Frame &frame) {
+        std::ofstream file{path, std::ios::binary};
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open " + path);
+        }
+        file << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+        file.write(reinterpret_cast<const char *>(frame.rgb.data()), static_cast<std::streamsize>(frame.rgb.size()));
+        if (!file) {
+            throw std::runtime_error("failed to write " + path);
+        }
+    }
+
+    void LveFrameReadback::printReport() {
+        // Only called between frames, but the writers may still be draining the queue
+        std::unique_lock<std::mutex> lock{mutex};
+        queueChanged.wait(lock, [this]() { return (queue.empty() && busyWriters == 0) || writerError; });
+        std::printf("readback: %llu frames, %.2f ms per frame per writer, %llu stalls (%.1f ms)\n",
+            static_cast<unsigned long long>(framesWritten),
+            framesWritten > 0 ? writeSeconds * 1000.0 / framesWritten : 0.0,
+            static_cast<unsigned long long>(stalls),
+            stallSeconds * 1000.0);
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lve {
+
+    // Copies finished frames into a ring of host-visible buffers, one per frame in flight, and
+    // hands them to writer threads once that slot's fence has signalled. Nothing ever waits on
+    // the frame being recorded; each frame comes back slotCount frames after it was drawn.
+    class LveFrameReadback {
+        public:
+            // Frames waiting for a writer; when full, collect() blocks so no frame is dropped
+            static constexpr size_t MAX_QUEUED_FRAMES = 16;
+
+            struct Frame {
+                uint64_t number;
+                uint32_t width;
+                uint32_t height;
+                // Tightly packed RGB8, top row first
+                std::vector<uint8_t> rgb;
+            };
+            // Runs on a writer thread; several may run at once for different frames
+            using FrameSink = std::function<void(const Frame &)>;
+
+            // Writes frame_NNNNNN.ppm files into outputDirectory
+            LveFrameReadback(
+                LveDevice &device,
+                VkExtent2D extent,
+                VkFormat format,
+                uint32_t slotCount,
+                const std::string &outputDirectory,
+                uint32_t writerCount = 2);
+            LveFrameReadback(
+                LveDevice &device,
+                VkExtent2D extent,
+                VkFormat format,
+                uint32_t slotCount,
+                FrameSink sink,
+                uint32_t writerCount = 2);
+            // Writes every queued frame before returning
+            ~LveFrameReadback();
+
+            LveFrameReadback(const LveFrameReadback &) = delete;
+            LveFrameReadback &operator=(const LveFrameReadback &) = delete;
+
+            static bool isFormatSupported(VkFormat format);
+
+            // image must be in TRANSFER_SRC_OPTIMAL with earlier writes visible to transfer reads
+            void recordCopy(VkCommandBuffer commandBuffer, uint32_t slot, VkImage image);
+            // Call once the slot's fence has signalled: queues the frame it last copied
+            void collect(uint32_t slot);
+            // Call after the device is idle: queues every outstanding frame in order
+            void collectAll();
+
+            static void writePpm(const std::string &path, const Frame &frame);
+            void printReport();
+
+        private:
+            struct Slot {
+                VkBuffer buffer = VK_NULL_HANDLE;
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                void *mapped = nullptr;
+                bool coherent = false;
+                // Holds a copied frame that has not been collected yet
+                bool pending = false;
+                uint64_t frameNumber = 0;
+            };
+
+            // Raw copy of a slot, converted to RGB on the writer thread
+            struct PendingFrame {
+                uint64_t number;
+                std::vector<uint8_t> pixels;
+            };
+
+            void createSlot(Slot &slot);
+            void writerLoop();
+            void rethrowWriterError();
+
+            LveDevice &lveDevice;
+            VkExtent2D extent;
+            VkFormat format;
+            VkDeviceSize frameSize;
+            FrameSink sink;
+            std::vector<Slot> slots;
+            uint64_t nextFrameNumber = 0;
+
+            std::mutex mutex;
+            std::condition_variable queueChanged;
+            std::deque<PendingFrame> queue;
+            // Pixel buffers handed back by the writers so steady state allocates nothing
+            std::vector<std::vector<uint8_t>> freeBuffers;
+            std::vector<std::thread> writers;
+            size_t busyWriters = 0;
+            bool stopping = false;
+            std::exception_ptr writerError;
+
+            uint64_t framesWritten = 0;
+            uint64_t stalls = 0;
+            double stallSeconds = 0.0;
+            double writeSeconds = 0.0;
+    };
+}
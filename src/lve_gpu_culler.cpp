@@ -0,0 +1,273 @@
+#include "lve_gpu_culler.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
+    LveGpuCuller::LveGpuCuller(LveDevice &device, uint32_t maxObjects, uint32_t frameCount)
+        : lveDevice{device}, maxObjects{maxObjects} {
+        assert(maxObjects > 0 && "GPU culler needs room for at least one object");
+        assert(frameCount > 0 && "GPU culler needs at least one frame");
+
+        // Compacting the survivors only pays off when the draw count can come from the GPU
+        compactDraws = lveDevice.supportsDrawIndirectCount();
+
+        objects.resize(maxObjects, ObjectBounds{});
+        frames.resize(frameCount);
+        for (auto &frame : frames) {
+            createBuffers(frame);
+        }
+        createDescriptors();
+        createPipelineLayout();
+        cullPipeline = std::make_unique<LveComputePipeline>(
+            lveDevice,
+            "shaders/cull.comp.spv",
+            pipelineLayout);
+    }
+
+    LveGpuCuller::~LveGpuCuller() {
+        cullPipeline.reset();
+        vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, lveDevice.getAllocator());
+        vkDestroyDescriptorPool(lveDevice.device(), descriptorPool, lveDevice.getAllocator());
+        vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, lveDevice.getAllocator());
+
+        for (auto &frame : frames) {
+            vkUnmapMemory(lveDevice.device(), frame.objectBufferMemory);
+            vkDestroyBuffer(lveDevice.device(), frame.objectBuffer, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), frame.objectBufferMemory, lveDevice.getAllocator());
+            vkDestroyBuffer(lveDevice.device(), frame.drawBuffer, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), frame.drawBufferMemory, lveDevice.getAllocator());
+            vkDestroyBuffer(lveDevice.device(), frame.countBuffer, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), frame.countBufferMemory, lveDevice.getAllocator());
+        }
+    }
+
+    void LveGpuCuller::createBuffers(FrameResources &frame) {
+        lveDevice.createBuffer(
+            sizeof(ObjectBounds) * maxObjects,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.objectBuffer,
+            frame.objectBufferMemory
+        );
+        void *data;
+        vkMapMemory(lveDevice.device(), frame.objectBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
+        frame.mappedObjects = static_cast<ObjectBounds *>(data);
+
+        lveDevice.createBuffer(
+            sizeof(VkDrawIndirectCommand) * maxObjects,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            frame.drawBuffer,
+            frame.drawBufferMemory
+        );
+
+        lveDevice.createBuffer(
+            sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            frame.countBuffer,
+            frame.countBufferMemory
+        );
+    }
+
+    void LveGpuCuller::createDescriptors() {
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+        for (uint32_t i = 0; i < bindings.size(); i++) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if (vkCreateDescriptorSetLayout(lveDevice.device(), &layoutInfo, lveDevice.getAllocator(), &descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cull descriptor set layout");
+        }
+
+        const uint32_t frameCount = static_cast<uint32_t>(frames.size());
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = static_cast<uint32_t>(bindings.size()) * frameCount;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = frameCount;
+
+        if (vkCreateDescriptorPool(lveDevice.device(), &poolInfo, lveDevice.getAllocator(), &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cull descriptor pool");
+        }
+
+        for (auto &frame : frames) {
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = descriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &descriptorSetLayout;
+
+            if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate cull descriptor set");
+            }
+
+            std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+            bufferInfos[0] = {frame.objectBuffer, 0, VK_WHOLE_SIZE};
+            bufferInfos[1] = {frame.drawBuffer, 0, VK_WHOLE_SIZE};
+            bufferInfos[2] = {frame.countBuffer, 0, VK_WHOLE_SIZE};
+
+            std::array<VkWriteDescriptorSet, 3> writes{};
+            for (uint32_t i = 0; i < writes.size(); i++) {
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = frame.descriptorSet;
+                writes[i].dstBinding = i;
+                writes[i].descriptorCount = 1;
+                writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].pBufferInfo = &bufferInfos[i];
+            }
+            vkUpdateDescriptorSets(lveDevice.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+    }
+
+    void LveGpuCuller::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, lveDevice.getAllocator(), &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cull pipeline layout");
+        }
+    }
+
+    void LveGpuCuller::setObjects(const std::vector<ObjectBounds> &newObjects) {
+        assert(newObjects.size() <= maxObjects && "Too many objects for GPU culler");
+        std::copy(newObjects.begin(), newObjects.end(), objects.begin());
+        objectCount = static_cast<uint32_t>(newObjects.size());
+        markDirty(0, objectCount);
+    }
+
+    void LveGpuCuller::updateObject(uint32_t index, const ObjectBounds &object) {
+        assert(index < maxObjects && "Object index out of range");
+        objects[index] = object;
+        markDirty(index, index + 1);
+    }
+
+    void LveGpuCuller::setObjectCount(uint32_t count) {
+        assert(count <= maxObjects && "Too many objects for GPU culler");
+        objectCount = count;
+    }
+
+    void LveGpuCuller::markDirty(uint32_t begin, uint32_t end) {
+        for (auto &frame : frames) {
+            if (frame.dirtyBegin == frame.dirtyEnd) {
+                frame.dirtyBegin = begin;
+                frame.dirtyEnd = end;
+            } else {
+                frame.dirtyBegin = std::min(frame.dirtyBegin, begin);
+                frame.dirtyEnd = std::max(frame.dirtyEnd, end);
+            }
+        }
+    }
+
+    void LveGpuCuller::flush(uint32_t frameIndex) {
+        auto &frame = frames[frameIndex];
+        if (frame.dirtyBegin == frame.dirtyEnd) {
+            return;
+        }
+        memcpy(
+            &frame.mappedObjects[frame.dirtyBegin],
+            &objects[frame.dirtyBegin],
+            sizeof(ObjectBounds) * (frame.dirtyEnd - frame.dirtyBegin));
+        frame.dirtyBegin = frame.dirtyEnd = 0;
+    }
+
+    void LveGpuCuller::recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const CullParams &params) {
+        if (objectCount == 0) {
+            return;
+        }
+        auto &frame = frames[frameIndex];
+
+        if (compactDraws) {
+            vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, sizeof(uint32_t), 0);
+
+            VkBufferMemoryBarrier clearBarrier{};
+            clearBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            clearBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            clearBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            clearBarrier.buffer = frame.countBuffer;
+            clearBarrier.offset = 0;
+            clearBarrier.size = VK_WHOLE_SIZE;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 0, nullptr, 1, &clearBarrier, 0, nullptr);
+        }
+
+        PushConstants push{};
+        push.scale = params.scale;
+        push.offset = params.offset;
+        push.viewportSize = params.viewportSize;
+        push.minPixelSize = params.minPixelSize;
+        push.objectCount = objectCount;
+        push.compact = compactDraws ? 1 : 0;
+
+        cullPipeline->bind(commandBuffer);
+        vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            pipelineLayout,
+            0, 1, &frame.descriptorSet,
+            0, nullptr);
+        vkCmdPushConstants(
+            commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(PushConstants),
+            &push);
+        vkCmdDispatch(commandBuffer, (objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+    }
+
+    void LveGpuCuller::recordDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+        if (objectCount == 0) {
+            return;
+        }
+        auto &frame = frames[frameIndex];
+
+        const uint32_t stride = sizeof(VkDrawIndirectCommand);
+        if (compactDraws) {
+            lveDevice.cmdDrawIndirectCountKHR(
+                commandBuffer, frame.drawBuffer, 0, frame.countBuffer, 0, objectCount, stride);
+        } else if (lveDevice.supportsMultiDrawIndirect()) {
+            // Culled objects were written with instanceCount = 0
+            vkCmdDrawIndirect(commandBuffer, frame.drawBuffer, 0, objectCount, stride);
+        } else {
+            for (uint32_t i = 0; i < objectCount; i++) {
+                vkCmdDrawIndirect(commandBuffer, frame.drawBuffer, i * stride, 1, stride);
+            }
+        }
+    }
+}
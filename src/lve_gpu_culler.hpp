@@ -0,0 +1,102 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_compute_pipeline.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+    // Culls per-object bounds on the GPU and turns the survivors into
+    // VkDrawIndirectCommands, so the CPU records the same handful of commands
+    // no matter how many objects there are.
+    class LveGpuCuller {
+        public:
+            // Mirrors the std430 layout of ObjectBounds in cull.comp
+            struct ObjectBounds {
+                glm::vec2 minBounds;
+                glm::vec2 maxBounds;
+                uint32_t firstVertex;
+                uint32_t vertexCount;
+            };
+
+            struct CullParams {
+                glm::vec2 scale{1.0f, 1.0f};
+                glm::vec2 offset{0.0f, 0.0f};
+                glm::vec2 viewportSize{1.0f, 1.0f};
+                float minPixelSize = 1.0f;
+            };
+
+            LveGpuCuller(LveDevice &device, uint32_t maxObjects, uint32_t frameCount);
+            ~LveGpuCuller();
+
+            LveGpuCuller(const LveGpuCuller &) = delete;
+            LveGpuCuller &operator=(const LveGpuCuller &) = delete;
+
+            void setObjects(const std::vector<ObjectBounds> &objects);
+            void updateObject(uint32_t index, const ObjectBounds &object);
+            void setObjectCount(uint32_t count);
+            uint32_t getObjectCount() const { return objectCount; }
+
+            // Copies object changes into the given frame's buffer; the frame must not be in flight
+            void flush(uint32_t frameIndex);
+            // Must be recorded outside of a render pass. The caller makes the draw and count
+            // buffers visible to indirect reads before recordDraw, e.g. through the render graph.
+            void recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const CullParams &params);
+            // Must be recorded inside the render pass, after the vertex buffer is bound
+            void recordDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+            VkBuffer getDrawBuffer(uint32_t frameIndex) const { return frames[frameIndex].drawBuffer; }
+            VkBuffer getCountBuffer(uint32_t frameIndex) const { return frames[frameIndex].countBuffer; }
+
+        private:
+            struct PushConstants {
+                glm::vec2 scale;
+                glm::vec2 offset;
+                glm::vec2 viewportSize;
+                float minPixelSize;
+                uint32_t objectCount;
+                uint32_t compact;
+            };
+
+            // Each frame in flight gets its own copy so the CPU and the culling
+            // pass never touch a buffer that a previous frame is still reading
+            struct FrameResources {
+                VkBuffer objectBuffer;
+                VkDeviceMemory objectBufferMemory;
+                ObjectBounds *mappedObjects = nullptr;
+                VkBuffer drawBuffer;
+                VkDeviceMemory drawBufferMemory;
+                VkBuffer countBuffer;
+                VkDeviceMemory countBufferMemory;
+                VkDescriptorSet descriptorSet;
+                uint32_t dirtyBegin = 0;
+                uint32_t dirtyEnd = 0;
+            };
+
+            void createBuffers(FrameResources &frame);
+            void createDescriptors();
+            void createPipelineLayout();
+            void markDirty(uint32_t begin, uint32_t end);
+
+            LveDevice &lveDevice;
+            uint32_t maxObjects;
+            uint32_t objectCount = 0;
+            bool compactDraws;
+
+            std::vector<ObjectBounds> objects;
+            std::vector<FrameResources> frames;
+
+            VkDescriptorSetLayout descriptorSetLayout;
+            VkDescriptorPool descriptorPool;
+            VkPipelineLayout pipelineLayout;
+            std::unique_ptr<LveComputePipeline> cullPipeline;
+    };
+}
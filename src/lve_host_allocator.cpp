@@ -0,0 +1,318 @@
+#include "lve_host_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace lve {
+
+    // Sits in front of every allocation; 16 bytes so pooled blocks stay 16-byte aligned
+    struct alignas(16) AllocationHeader {
+        uint64_t size;
+        // Distance from the malloc'd pointer to the user pointer, malloc'd allocations only
+        uint32_t offset;
+        uint8_t sizeClass;
+        uint8_t scope;
+    };
+    static_assert(sizeof(AllocationHeader) == 16, "header must keep 16-byte alignment");
+
+    static constexpr uint8_t HEAP_CLASS = 0xff;
+    static constexpr size_t POOL_ALIGNMENT = 16;
+
+    static std::atomic<uint64_t> nextAllocatorId{1};
+
+    // The pool this thread last used, tagged with the allocator it belongs to
+    struct ThreadPoolCache {
+        uint64_t allocatorId = 0;
+        void *pool = nullptr;
+    };
+    static thread_local ThreadPoolCache threadPoolCache;
+
+    static AllocationHeader *headerOf(void *memory) {
+        return reinterpret_cast<AllocationHeader *>(static_cast<char *>(memory) - sizeof(AllocationHeader));
+    }
+
+    static uint32_t sizeClassFor(size_t blockSize) {
+        uint32_t sizeClass = 0;
+        for (size_t classSize = LveHostAllocator::MIN_BLOCK_SIZE; classSize < blockSize; classSize <<= 1) {
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    static size_t classSize(uint32_t sizeClass) {
+        return LveHostAllocator::MIN_BLOCK_SIZE << sizeClass;
+    }
+
+    static void raiseTo(std::atomic<uint64_t> &peak, uint64_t value) {
+        uint64_t seen = peak.load(std::memory_order_relaxed);
+        while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    LveHostAllocator::LveHostAllocator() : id{nextAllocatorId++} {
+        static_assert(MIN_BLOCK_SIZE << (CLASS_COUNT - 1) == MAX_BLOCK_SIZE, "size classes must cover the pooled range");
+        callbacks.pUserData = this;
+        callbacks.pfnAllocation = allocationCallback;
+        callbacks.pfnReallocation = reallocationCallback;
+        callbacks.pfnFree = freeCallback;
+        callbacks.pfnInternalAllocation = internalAllocationCallback;
+        callbacks.pfnInternalFree = internalFreeCallback;
+    }
+
+    LveHostAllocator::~LveHostAllocator() {
+        for (void *arena : arenas) {
+            std::free(arena);
+        }
+    }
+
+    void *VKAPI_PTR LveHostAllocator::allocationCallback(
+        void *userData, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+        auto *allocator = static_cast<LveHostAllocator *>(userData);
+        ThreadPool &pool = allocator->getThreadPool();
+        auto start = std::chrono::steady_clock::now();
+        void *memory = allocator->allocate(pool, size, alignment, scope);
+        pool.stats.calls++;
+        pool.stats.bytes += size;
+        pool.stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        return memory;
+    }
+
+    void *VKAPI_PTR LveHostAllocator::reallocationCallback(
+        void *userData, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+        auto *allocator = static_cast<LveHostAllocator *>(userData);
+        ThreadPool &pool = allocator->getThreadPool();
+        auto start = std::chrono::steady_clock::now();
+        void *memory = allocator->reallocate(pool, original, size, alignment, scope);
+        pool.stats.calls++;
+        pool.stats.bytes += size;
+        pool.stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        return memory;
+    }
+
+    void VKAPI_PTR LveHostAllocator::freeCallback(void *userData, void *memory) {
+        if (memory == nullptr) {
+            return;
+        }
+        auto *allocator = static_cast<LveHostAllocator *>(userData);
+        ThreadPool &pool = allocator->getThreadPool();
+        auto start = std::chrono::steady_clock::now();
+        allocator->release(pool, memory);
+        pool.stats.calls++;
+        pool.stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    void VKAPI_PTR LveHostAllocator::internalAllocationCallback(
+        void *userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+        static_cast<LveHostAllocator *>(userData)->internalBytes += size;
+    }
+
+    void VKAPI_PTR LveHostAllocator::internalFreeCallback(
+        void *userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+        static_cast<LveHostAllocator *>(userData)->internalBytes -= size;
+    }
+
+    void *LveHostAllocator::allocate(ThreadPool &pool, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+        if (size == 0) {
+            return nullptr;
+        }
+        alignment = std::max(alignment, POOL_ALIGNMENT);
+        const bool poolable = scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND || scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+
+        AllocationHeader *header = nullptr;
+        void *memory = nullptr;
+        if (poolable && alignment == POOL_ALIGNMENT && size + sizeof(AllocationHeader) <= MAX_BLOCK_SIZE) {
+            const uint32_t sizeClass = sizeClassFor(size + sizeof(AllocationHeader));
+            void *block = pool.freeLists[sizeClass];
+            if (block != nullptr) {
+                std::memcpy(&pool.freeLists[sizeClass], block, sizeof(void *));
+            } else {
+                block = carveBlock(pool, sizeClass);
+                if (block == nullptr) {
+                    return nullptr;
+                }
+            }
+            header = static_cast<AllocationHeader *>(block);
+            header->offset = 0;
+            header->sizeClass = static_cast<uint8_t>(sizeClass);
+            memory = static_cast<char *>(block) + sizeof(AllocationHeader);
+            scopes[scope].pooled.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // Room for the header and for rounding the user pointer up to the alignment
+            char *raw = static_cast<char *>(std::malloc(size + alignment + sizeof(AllocationHeader)));
+            if (raw == nullptr) {
+                return nullptr;
+            }
+            uintptr_t user = reinterpret_cast<uintptr_t>(raw) + sizeof(AllocationHeader);
+            user = (user + alignment - 1) & ~(uintptr_t{alignment} - 1);
+            memory = reinterpret_cast<void *>(user);
+            header = headerOf(memory);
+            header->offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(raw));
+            header->sizeClass = HEAP_CLASS;
+        }
+        header->size = size;
+        header->scope = static_cast<uint8_t>(scope);
+
+        scopes[scope].allocations.fetch_add(1, std::memory_order_relaxed);
+        addBytes(scope, size);
+        return memory;
+    }
+
+    void LveHostAllocator::release(ThreadPool &pool, void *memory) {
+        AllocationHeader *header = headerOf(memory);
+        const uint32_t scope = header->scope;
+        scopes[scope].frees.fetch_add(1, std::memory_order_relaxed);
+        removeBytes(scope, header->size);
+
+        if (header->sizeClass == HEAP_CLASS) {
+            std::free(reinterpret_cast<char *>(memory) - header->offset);
+            return;
+        }
+        // Blocks freed on another thread join this thread's list; every pool draws from the same arenas
+        void *block = header;
+        std::memcpy(block, &pool.freeLists[header->sizeClass], sizeof(void *));
+        pool.freeLists[header->sizeClass] = block;
+    }
+
+    void *LveHostAllocator::reallocate(
+        ThreadPool &pool, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+        if (original == nullptr) {
+            return allocate(pool, size, alignment, scope);
+        }
+        if (size == 0) {
+            release(pool, original);
+            return nullptr;
+        }
+
+        AllocationHeader *header = headerOf(original);
+        const uint32_t oldScope = header->scope;
+        const size_t capacity = header->sizeClass == HEAP_CLASS
+            ? header->size
+            : classSize(header->sizeClass) - sizeof(AllocationHeader);
+        const bool aligned = reinterpret_cast<uintptr_t>(original) % std::max(alignment, POOL_ALIGNMENT) == 0;
+        if (size <= capacity && aligned && oldScope == static_cast<uint32_t>(scope)) {
+            // Shrinking, or growing within a pooled block's slack, keeps the allocation in place
+            scopes[scope].reallocations.fetch_add(1, std::memory_order_relaxed);
+            removeBytes(scope, header->size);
+            addBytes(scope, size);
+            header->size = size;
+            return original;
+        }
+
+        void *memory = allocate(pool, size, alignment, scope);
+        if (memory == nullptr) {
+            // The original stays valid when reallocation fails
+            return nullptr;
+        }
+        std::memcpy(memory, original, std::min<size_t>(size, header->size));
+        release(pool, original);
+        // Counted as a reallocation rather than an allocation/free pair
+        scopes[scope].allocations.fetch_sub(1, std::memory_order_relaxed);
+        scopes[oldScope].frees.fetch_sub(1, std::memory_order_relaxed);
+        scopes[scope].reallocations.fetch_add(1, std::memory_order_relaxed);
+        return memory;
+    }
+
+    void *LveHostAllocator::carveBlock(ThreadPool &pool, uint32_t sizeClass) {
+        const size_t blockSize = classSize(sizeClass);
+        if (pool.arenaCursor == nullptr || static_cast<size_t>(pool.arenaEnd - pool.arenaCursor) < blockSize) {
+            // The tail of the old arena is abandoned; at most one block's worth per arena
+            char *arena = static_cast<char *>(std::malloc(ARENA_SIZE));
+            if (arena == nullptr) {
+                return nullptr;
+            }
+            {
+                std::lock_guard<std::mutex> lock{poolMutex};
+                arenas.push_back(arena);
+            }
+            arenaBytes.fetch_add(ARENA_SIZE, std::memory_order_relaxed);
+            pool.arenaCursor = arena;
+            pool.arenaEnd = arena + ARENA_SIZE;
+        }
+        void *block = pool.arenaCursor;
+        pool.arenaCursor += blockSize;
+        return block;
+    }
+
+    LveHostAllocator::ThreadPool &LveHostAllocator::getThreadPool() {
+        if (threadPoolCache.allocatorId != id) {
+            // First call from this thread: register a pool that outlives the thread
+            std::lock_guard<std::mutex> lock{poolMutex};
+            pools.push_back(std::make_unique<ThreadPool>());
+            threadPoolCache.allocatorId = id;
+            threadPoolCache.pool = pools.back().get();
+        }
+        return *static_cast<ThreadPool *>(threadPoolCache.pool);
+    }
+
+    void LveHostAllocator::addBytes(uint32_t scope, uint64_t bytes) {
+        uint64_t scopeBytes = scopes[scope].currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        raiseTo(scopes[scope].peakBytes, scopeBytes);
+        uint64_t totalBytes = currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        raiseTo(peakBytes, totalBytes);
+    }
+
+    void LveHostAllocator::removeBytes(uint32_t scope, uint64_t bytes) {
+        scopes[scope].currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    LveHostAllocator::Snapshot LveHostAllocator::getSnapshot() const {
+        Snapshot snapshot{};
+        for (uint32_t i = 0; i < SCOPE_COUNT; i++) {
+            ScopeStats &stats = snapshot.scopes[i];
+            stats.allocations = scopes[i].allocations.load(std::memory_order_relaxed);
+            stats.reallocations = scopes[i].reallocations.load(std::memory_order_relaxed);
+            stats.frees = scopes[i].frees.load(std::memory_order_relaxed);
+            stats.pooled = scopes[i].pooled.load(std::memory_order_relaxed);
+            stats.currentBytes = scopes[i].currentBytes.load(std::memory_order_relaxed);
+            stats.peakBytes = scopes[i].peakBytes.load(std::memory_order_relaxed);
+        }
+        snapshot.currentBytes = currentBytes.load(std::memory_order_relaxed);
+        snapshot.peakBytes = peakBytes.load(std::memory_order_relaxed);
+        snapshot.internalBytes = internalBytes.load(std::memory_order_relaxed);
+        snapshot.arenaBytes = arenaBytes.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    LveHostAllocator::ThreadStats LveHostAllocator::getThreadStats() {
+        return getThreadPool().stats;
+    }
+
+    void LveHostAllocator::resetPeak() {
+        for (auto &scope : scopes) {
+            scope.peakBytes.store(scope.currentBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        peakBytes.store(currentBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    void LveHostAllocator::printReport() const {
+        static const char *scopeNames[SCOPE_COUNT] = {"command", "object", "cache", "device", "instance"};
+        Snapshot snapshot = getSnapshot();
+        std::printf("host allocations: %.1f KB live, %.1f KB peak, %.1f KB internal, %.1f KB of pool arenas\n",
+            snapshot.currentBytes / 1024.0,
+            snapshot.peakBytes / 1024.0,
+            snapshot.internalBytes / 1024.0,
+            snapshot.arenaBytes / 1024.0);
+        for (uint32_t i = 0; i < SCOPE_COUNT; i++) {
+            const ScopeStats &stats = snapshot.scopes[i];
+            if (stats.allocations == 0 && stats.reallocations == 0) {
+                continue;
+            }
+            std::printf("  %-8s %8llu allocs %6llu reallocs %8llu frees %8llu pooled, %9.1f KB live, %9.1f KB peak\n",
+                scopeNames[i],
+                static_cast<unsigned long long>(stats.allocations),
+                static_cast<unsigned long long>(stats.reallocations),
+                static_cast<unsigned long long>(stats.frees),
+                static_cast<unsigned long long>(stats.pooled),
+                stats.currentBytes / 1024.0,
+                stats.peakBytes / 1024.0);
+        }
+    }
+}
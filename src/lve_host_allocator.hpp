@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+    // VkAllocationCallbacks that count every host allocation the driver makes, per
+    // VkSystemAllocationScope. COMMAND and OBJECT scope requests up to MAX_BLOCK_SIZE are served
+    // from per-thread size-class free lists carved out of arenas, so the short-lived allocations
+    // made while recording and creating objects never touch malloc or a shared lock. Everything
+    // else goes to malloc. Arenas are only returned when the allocator is destroyed.
+    class LveHostAllocator {
+        public:
+            static constexpr uint32_t SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+            // Block sizes include the 16 byte header, in powers of two
+            static constexpr size_t MIN_BLOCK_SIZE = 32;
+            static constexpr size_t MAX_BLOCK_SIZE = 4096;
+            static constexpr size_t ARENA_SIZE = 256 * 1024;
+
+            struct ScopeStats {
+                uint64_t allocations = 0;
+                uint64_t reallocations = 0;
+                uint64_t frees = 0;
+                // Served from a thread pool rather than malloc
+                uint64_t pooled = 0;
+                uint64_t currentBytes = 0;
+                uint64_t peakBytes = 0;
+            };
+
+            struct Snapshot {
+                std::array<ScopeStats, SCOPE_COUNT> scopes{};
+                uint64_t currentBytes = 0;
+                uint64_t peakBytes = 0;
+                // Reported through pfnInternalAllocation, e.g. executable memory for shaders
+                uint64_t internalBytes = 0;
+                uint64_t arenaBytes = 0;
+            };
+
+            // Calls made by one thread, for measuring a phase without other threads' noise
+            struct ThreadStats {
+                uint64_t calls = 0;
+                uint64_t bytes = 0;
+                uint64_t nanoseconds = 0;
+            };
+
+            LveHostAllocator();
+            ~LveHostAllocator();
+
+            LveHostAllocator(const LveHostAllocator &) = delete;
+            LveHostAllocator &operator=(const LveHostAllocator &) = delete;
+
+            const VkAllocationCallbacks *getCallbacks() const { return &callbacks; }
+
+            Snapshot getSnapshot() const;
+            // Calling thread's counters; differences between two calls measure the code in between
+            ThreadStats getThreadStats();
+            // Restarts peak tracking from the current usage, e.g. once startup is done
+            void resetPeak();
+            void printReport() const;
+
+        private:
+            struct AtomicScopeStats {
+                std::atomic<uint64_t> allocations{0};
+                std::atomic<uint64_t> reallocations{0};
+                std::atomic<uint64_t> frees{0};
+                std::atomic<uint64_t> pooled{0};
+                std::atomic<uint64_t> currentBytes{0};
+                std::atomic<uint64_t> peakBytes{0};
+            };
+
+            static constexpr size_t CLASS_COUNT = 8;
+
+            // One per thread that has called into the allocator; owned by the allocator so
+            // blocks stay valid after the thread exits
+            struct ThreadPool {
+                std::array<void *, CLASS_COUNT> freeLists{};
+                char *arenaCursor = nullptr;
+                char *arenaEnd = nullptr;
+                ThreadStats stats{};
+            };
+
+            static void *VKAPI_PTR allocationCallback(
+                void *userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+            static void *VKAPI_PTR reallocationCallback(
+                void *userData, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+            static void VKAPI_PTR freeCallback(void *userData, void *memory);
+            static void VKAPI_PTR internalAllocationCallback(
+                void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+            static void VKAPI_PTR internalFreeCallback(
+                void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+            void *allocate(ThreadPool &pool, size_t size, size_t alignment, VkSystemAllocationScope scope);
+            void release(ThreadPool &pool, void *memory);
+            void *reallocate(ThreadPool &pool, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+            void *carveBlock(ThreadPool &pool, uint32_t sizeClass);
+            ThreadPool &getThreadPool();
+            void addBytes(uint32_t scope, uint64_t bytes);
+            void removeBytes(uint32_t scope, uint64_t bytes);
+
+            VkAllocationCallbacks callbacks{};
+            uint64_t id;
+            std::array<AtomicScopeStats, SCOPE_COUNT> scopes;
+            std::atomic<uint64_t> currentBytes{0};
+            std::atomic<uint64_t> peakBytes{0};
+            std::atomic<uint64_t> internalBytes{0};
+            std::atomic<uint64_t> arenaBytes{0};
+
+            std::mutex poolMutex;
+            std::vector<std::unique_ptr<ThreadPool>> pools;
+            std::vector<void *> arenas;
+    };
+}
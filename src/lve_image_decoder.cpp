@@ -0,0 +1,283 @@
+#include "lve_image_decoder.hpp"
+
+#include "lve_mapped_file.hpp"
+
+// libs
+#include <zlib.h>
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    namespace {
+        const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+        uint32_t readBigEndian32(const uint8_t *bytes) {
+            return (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) | (uint32_t{bytes[2]} << 8) | bytes[3];
+        }
+
+        uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+            const int p = int{a} + b - c;
+            const int pa = std::abs(p - a);
+            const int pb = std::abs(p - b);
+            const int pc = std::abs(p - c);
+            if (pa <= pb && pa <= pc) {
+                return a;
+            }
+            return pb <= pc ? b : c;
+        }
+
+        // Undoes the per-row filters in place; each row keeps its leading filter byte
+        void unfilterRows(uint8_t *rows, uint32_t height, size_t rowBytes, size_t pixelBytes) {
+            const uint8_t *previous = nullptr;
+            for (uint32_t y = 0; y < height; y++) {
+                const uint8_t filter = rows[0];
+                uint8_t *row = rows + 1;
+                for (size_t x = 0; x < rowBytes; x++) {
+                    const uint8_t left = x >= pixelBytes ? row[x - pixelBytes] : 0;
+                    const uint8_t up = previous ? previous[x] : 0;
+                    const uint8_t upLeft = previous && x >= pixelBytes ? previous[x - pixelBytes] : 0;
+                    switch (filter) {
+                        case 0:
+                            break;
+                        case 1:
+                            row[x] = static_cast<uint8_t>(row[x] + left);
+                            break;
+                        case 2:
+                            row[x] = static_cast<uint8_t>(row[x] + up);
+                            break;
+                        case 3:
+                            row[x] = static_cast<uint8_t>(row[x] + ((left + up) >> 1));
+                            break;
+                        case 4:
+                            row[x] = static_cast<uint8_t>(row[x] + paeth(left, up, upLeft));
+                            break;
+                        default:
+                            throw std::runtime_error("invalid PNG filter type");
+                    }
+                }
+                previous = row;
+                rows += rowBytes + 1;
+            }
+        }
+
+        // Skips whitespace and # comments, then reads one decimal header field
+        uint32_t readPnmField(const uint8_t *data, size_t size, size_t &cursor) {
+            while (cursor < size) {
+                if (data[cursor] == '#') {
+                    while (cursor < size && data[cursor] != '\n') {
+                        cursor++;
+                    }
+                } else if (data[cursor] == ' ' || data[cursor] == '\t' || data[cursor] == '\r' || data[cursor] == '\n') {
+                    cursor++;
+                } else {
+                    break;
+                }
+            }
+            if (cursor == size || data[cursor] < '0' || data[cursor] > '9') {
+                throw std::runtime_error("malformed PNM header");
+            }
+            uint64_t value = 0;
+            while (cursor < size && data[cursor] >= '0' && data[cursor] <= '9') {
+                value = value * 10 + (data[cursor++] - '0');
+                if (value > UINT32_MAX) {
+                    throw std::runtime_error("malformed PNM header");
+                }
+            }
+            return static_cast<uint32_t>(value);
+        }
+    }
+
+    LveImage decodeImage(const std::string &path) {
+        LveMappedFile file{path};
+        return decodeImage(file.data(), file.size());
+    }
+
+    LveImage decodeImage(const uint8_t *data, size_t size) {
+        if (size >= sizeof(PNG_SIGNATURE) && std::memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0) {
+            return decodePng(data, size);
+        }
+        if (size >= 2 && data[0] == 'P' && (data[1] == '5' || data[1] == '6')) {
+            return decodePnm(data, size);
+        }
+        throw std::runtime_error("unsupported image format");
+    }
+
+    LveImage decodePng(const uint8_t *data, size_t size) {
+        if (size < sizeof(PNG_SIGNATURE) || std::memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0) {
+            throw std::runtime_error("not a PNG file");
+        }
+
+        LveImage image{};
+        uint8_t bitDepth = 0;
+        uint8_t colorType = 0;
+        std::vector<uint8_t> palette;
+        std::vector<uint8_t> paletteAlpha;
+        std::vector<uint8_t> compressed;
+        bool ended = false;
+        size_t cursor = sizeof(PNG_SIGNATURE);
+        while (!ended) {
+            if (size - cursor < 12) {
+                throw std::runtime_error("truncated PNG chunk");
+            }
+            const uint32_t length = readBigEndian32(data + cursor);
+            const uint8_t *type = data + cursor + 4;
+            const uint8_t *body = data + cursor + 8;
+            if (length > size - cursor - 12) {
+                throw std::runtime_error("truncated PNG chunk");
+            }
+            // CRCs are not checked; a corrupt stream still fails in inflate or the size checks
+            if (std::memcmp(type, "IHDR", 4) == 0) {
+                if (length != 13) {
+                    throw std::runtime_error("invalid PNG header");
+                }
+                image.width = readBigEndian32(body);
+                image.height = readBigEndian32(body + 4);
+                bitDepth = body[8];
+                colorType = body[9];
+                if (body[12] != 0) {
+                    throw std::runtime_error("interlaced PNGs are not supported");
+                }
+            } else if (std::memcmp(type, "PLTE", 4) == 0) {
+                palette.assign(body, body + length);
+            } else if (std::memcmp(type, "tRNS", 4) == 0) {
+                paletteAlpha.assign(body, body + length);
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                compressed.insert(compressed.end(), body, body + length);
+            } else if (std::memcmp(type, "IEND", 4) == 0) {
+                ended = true;
+            }
+            cursor += size_t{length} + 12;
+        }
+
+        uint32_t channels = 0;
+        switch (colorType) {
+            case 0: channels = 1; break;
+            case 2: channels = 3; break;
+            case 3: channels = 1; break;
+            case 4: channels = 2; break;
+            case 6: channels = 4; break;
+            default: throw std::runtime_error("invalid PNG colour type");
+        }
+        if (image.width == 0 || image.height == 0 || (bitDepth != 8 && bitDepth != 16) ||
+            (colorType == 3 && (bitDepth != 8 || palette.empty()))) {
+            throw std::runtime_error("unsupported PNG layout");
+        }
+
+        const size_t sampleBytes = bitDepth / 8;
+        const size_t pixelBytes = channels * sampleBytes;
+        const size_t rowBytes = pixelBytes * image.width;
+        std::vector<uint8_t> rows((rowBytes + 1) * image.height);
+        uLongf inflatedSize = static_cast<uLongf>(rows.size());
+        if (uncompress(rows.data(), &inflatedSize, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK ||
+            inflatedSize != rows.size()) {
+            throw std::runtime_error("corrupt PNG image data");
+        }
+        unfilterRows(rows.data(), image.height, rowBytes, pixelBytes);
+
+        // 16-bit samples keep their high byte
+        image.rgba.resize(size_t{image.width} * image.height * 4);
+        uint8_t *out = image.rgba.data();
+        for (uint32_t y = 0; y < image.height; y++) {
+            const uint8_t *row = rows.data() + y * (rowBytes + 1) + 1;
+            for (uint32_t x = 0; x < image.width; x++, out += 4) {
+                const uint8_t *pixel = row + x * pixelBytes;
+                auto sample = [&](uint32_t channel) { return pixel[channel * sampleBytes]; };
+                switch (colorType) {
+                    case 0:
+                        out[0] = out[1] = out[2] = sample(0);
+                        out[3] = 255;
+                        break;
+                    case 2:
+                        out[0] = sample(0);
+                        out[1] = sample(1);
+                        out[2] = sample(2);
+                        out[3] = 255;
+                        break;
+                    case 3: {
+                        const size_t entry = pixel[0];
+                        if (entry * 3 + 2 >= palette.size()) {
+                            throw std::runtime_error("PNG palette index out of range");
+                        }
+                        out[0] = palette[entry * 3];
+                        out[1] = palette[entry * 3 + 1];
+                        out[2] = palette[entry * 3 + 2];
+                        out[3] = entry < paletteAlpha.size() ? paletteAlpha[entry] : 255;
+                        break;
+                    }
+                    case 4:
+                        out[0] = out[1] = out[2] = sample(0);
+                        out[3] = sample(1);
+                        break;
+                    default:
+                        out[0] = sample(0);
+                        out[1] = sample(1);
+                        out[2] = sample(2);
+                        out[3] = sample(3);
+                        break;
+                }
+            }
+        }
+        return image;
+    }
+
+    LveImage decodePnm(const uint8_t *data, size_t size) {
+        if (size < 2 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) {
+            throw std::runtime_error("not a binary PGM or PPM file");
+        }
+        const uint32_t channels = data[1] == '6' ? 3 : 1;
+        size_t cursor = 2;
+        LveImage image{};
+        image.width = readPnmField(data, size, cursor);
+        image.height = readPnmField(data, size, cursor);
+        const uint32_t maxValue = readPnmField(data, size, cursor);
+        // A single whitespace byte separates the header from the samples
+        cursor++;
+        if (image.width == 0 || image.height == 0 || maxValue == 0 || maxValue > 255) {
+            throw std::runtime_error("unsupported PNM layout");
+        }
+        const size_t pixelCount = size_t{image.width} * image.height;
+        if (cursor > size || size - cursor < pixelCount * channels) {
+            throw std::runtime_error("truncated PNM image data");
+        }
+
+        image.rgba.resize(pixelCount * 4);
+        const uint8_t *in = data + cursor;
+        for (size_t i = 0; i < pixelCount; i++, in += channels) {
+            for (uint32_t c = 0; c < 3; c++) {
+                const uint32_t value = in[channels == 3 ? c : 0];
+                image.rgba[i * 4 + c] = static_cast<uint8_t>(maxValue == 255 ? value : (value * 255 + maxValue / 2) / maxValue);
+            }
+            image.rgba[i * 4 + 3] = 255;
+        }
+        return image;
+    }
+
+    LveImage halveImage(const LveImage &image) {
+        LveImage half{};
+        half.width = std::max(image.width / 2, 1u);
+        half.height = std::max(image.height / 2, 1u);
+        half.rgba.resize(size_t{half.width} * half.height * 4);
+        for (uint32_t y = 0; y < half.height; y++) {
+            const uint32_t y0 = std::min(y * 2, image.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, image.height - 1);
+            for (uint32_t x = 0; x < half.width; x++) {
+                const uint32_t x0 = std::min(x * 2, image.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, image.width - 1);
+                const uint8_t *a = &image.rgba[(size_t{y0} * image.width + x0) * 4];
+                const uint8_t *b = &image.rgba[(size_t{y0} * image.width + x1) * 4];
+                const uint8_t *c = &image.rgba[(size_t{y1} * image.width + x0) * 4];
+                const uint8_t *d = &image.rgba[(size_t{y1} * image.width + x1) * 4];
+                uint8_t *out = &half.rgba[(size_t{y} * half.width + x) * 4];
+                for (uint32_t channel = 0; channel < 4; channel++) {
+                    out[channel] = static_cast<uint8_t>((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+                }
+            }
+        }
+        return half;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Tightly packed RGBA8, top row first
+    struct LveImage {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> rgba;
+    };
+
+    // Picks the format from the file's signature. Thread safe, so decoding can run on workers.
+    LveImage decodeImage(const std::string &path);
+    LveImage decodeImage(const uint8_t *data, size_t size);
+    // 8 or 16 bits per channel, any colour type, not interlaced
+    LveImage decodePng(const uint8_t *data, size_t size);
+    // Binary PGM (P5) and PPM (P6) with a maximum value of at most 255
+    LveImage decodePnm(const uint8_t *data, size_t size);
+
+    // Next mip level: each texel averages a 2x2 block, odd edges repeat the last row or column
+    LveImage halveImage(const LveImage &image);
+}
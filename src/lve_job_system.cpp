@@ -0,0 +1,256 @@
+#include "lve_job_system.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace lve {
+
+    // Failed steal attempts a worker spins through before sleeping, and a waiting thread
+    // yields through before backing off to short sleeps
+    static constexpr uint32_t IDLE_SPINS = 64;
+
+    // Which pool, if any, the current thread works for
+    static thread_local const LveJobSystem *currentSystem = nullptr;
+    static thread_local uint32_t currentWorkerQueue = 0;
+
+    uint32_t LveJobSystem::defaultWorkerCount() {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 2 ? hardwareThreads - 1 : 1;
+    }
+
+    LveJobSystem::LveJobSystem(uint32_t workerCount) {
+        queues.reserve(workerCount + 1);
+        for (uint32_t i = 0; i <= workerCount; i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(&LveJobSystem::workerLoop, this, i + 1);
+        }
+    }
+
+    LveJobSystem::~LveJobSystem() {
+        {
+            std::lock_guard<std::mutex> lock{sleepMutex};
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+
+        // Only reached with jobs left when there are no workers
+        Task task;
+        while (tryPop(0, task)) {
+            execute(0, task);
+        }
+    }
+
+    void LveJobSystem::run(Job fn, Counter *counter, Counter *dependency) {
+        if (counter) {
+            counter->pending.fetch_add(1);
+        }
+        if (dependency) {
+            std::lock_guard<std::mutex> lock{dependency->mutex};
+            if (dependency->pending.load() != 0) {
+                dependency->continuations.push_back({std::move(fn), counter});
+                return;
+            }
+        }
+        push({std::move(fn), counter, currentQueue()});
+    }
+
+    void LveJobSystem::parallelFor(
+            uint32_t count,
+            uint32_t grainSize,
+            const std::function<void(uint32_t begin, uint32_t end)> &fn) {
+        if (count == 0) {
+            return;
+        }
+        grainSize = std::max(1u, grainSize);
+
+        Counter counter;
+        for (uint32_t begin = grainSize; begin < count; begin += grainSize) {
+            const uint32_t end = begin + std::min(grainSize, count - begin);
+            run([&fn, begin, end]() { fn(begin, end); }, &counter);
+        }
+
+        // The queued ranges reference fn and counter, so they must finish even if ours throws
+        std::exception_ptr error;
+        try {
+            fn(0, std::min(grainSize, count));
+        } catch (...) {
+            error = std::current_exception();
+        }
+        try {
+            wait(counter);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void LveJobSystem::wait(Counter &counter) {
+        uint32_t idleSpins = 0;
+        while (!counter.isDone()) {
+            if (runPendingJob()) {
+                idleSpins = 0;
+            } else if (++idleSpins < IDLE_SPINS) {
+                std::this_thread::yield();
+            } else {
+                // The remaining jobs are running elsewhere
+                std::this_thread::sleep_for(std::chrono::microseconds{50});
+            }
+        }
+
+        // finish() decrements under the lock, so once we hold it nothing touches the counter again
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock{counter.mutex};
+            std::swap(error, counter.error);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool LveJobSystem::runPendingJob() {
+        const uint32_t self = currentQueue();
+        Task task;
+        if (!tryPop(self, task)) {
+            return false;
+        }
+        execute(self, task);
+        return true;
+    }
+
+    LveJobSystem::Stats LveJobSystem::getStats() const {
+        Stats stats{};
+        for (const auto &queue : queues) {
+            stats.executed += queue->executed.load(std::memory_order_relaxed);
+            stats.stolen += queue->stolen.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void LveJobSystem::workerLoop(uint32_t queue) {
+        currentSystem = this;
+        currentWorkerQueue = queue;
+
+        uint32_t idleSpins = 0;
+        while (true) {
+            Task task;
+            if (tryPop(queue, task)) {
+                execute(queue, task);
+                idleSpins = 0;
+                continue;
+            }
+            if (++idleSpins < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // push() bumps queuedTasks before reading sleepingWorkers and we do the reverse, so
+            // either it sees us sleeping and notifies, or we see its task and stay awake
+            std::unique_lock<std::mutex> lock{sleepMutex};
+            sleepingWorkers.fetch_add(1);
+            wake.wait(lock, [this]() { return stopping || queuedTasks.load() > 0; });
+            sleepingWorkers.fetch_sub(1);
+            if (stopping && queuedTasks.load() == 0) {
+                return;
+            }
+            idleSpins = 0;
+        }
+    }
+
+    void LveJobSystem::push(Task task) {
+        // Counted before it is visible, so a pop can never take queuedTasks below zero
+        queuedTasks.fetch_add(1);
+        Queue &queue = *queues[task.queue];
+        {
+            std::lock_guard<std::mutex> lock{queue.mutex};
+            queue.tasks.push_back(std::move(task));
+        }
+        if (sleepingWorkers.load() > 0) {
+            { std::lock_guard<std::mutex> lock{sleepMutex}; }
+            wake.notify_one();
+        }
+    }
+
+    bool LveJobSystem::tryPop(uint32_t self, Task &task) {
+        {
+            Queue &own = *queues[self];
+            std::lock_guard<std::mutex> lock{own.mutex};
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queuedTasks.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Steal the oldest job and leave the victim the ones it pushed most recently
+        const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+        for (uint32_t i = 1; i < queueCount; i++) {
+            Queue &victim = *queues[(self + i) % queueCount];
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queuedTasks.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void LveJobSystem::execute(uint32_t self, Task &task) {
+        Queue &queue = *queues[self];
+        queue.executed.fetch_add(1, std::memory_order_relaxed);
+        if (task.queue != self) {
+            queue.stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::exception_ptr error;
+        try {
+            task.fn();
+        } catch (...) {
+            if (!task.counter) {
+                std::terminate();
+            }
+            error = std::current_exception();
+        }
+        // Captures go before the counter is signalled, as the waiter may free what they reference
+        task.fn = nullptr;
+        if (task.counter) {
+            finish(*task.counter, error);
+        }
+    }
+
+    void LveJobSystem::finish(Counter &counter, std::exception_ptr error) {
+        std::vector<Counter::HeldJob> released;
+        {
+            std::lock_guard<std::mutex> lock{counter.mutex};
+            if (error && !counter.error) {
+                counter.error = error;
+            }
+            if (counter.pending.fetch_sub(1) == 1) {
+                released.swap(counter.continuations);
+            }
+        }
+        const uint32_t queue = currentQueue();
+        for (auto &held : released) {
+            push({std::move(held.fn), held.counter, queue});
+        }
+    }
+
+    uint32_t LveJobSystem::currentQueue() const {
+        return currentSystem == this ? currentWorkerQueue : 0;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lve {
+
+    // One pool of worker threads shared by every subsystem. Each worker owns a deque: it pushes
+    // and pops its own jobs at the back, so freshly split work stays in its cache, and steals the
+    // oldest jobs from the front of other deques when it runs dry. Threads outside the pool share
+    // one extra deque, and any thread that waits on a Counter runs jobs instead of blocking, so
+    // the main thread contributes while it waits for work it handed out.
+    class LveJobSystem {
+        public:
+            using Job = std::function<void()>;
+
+            // Counts the jobs started with it that have not finished yet. Jobs can also be held
+            // back until a counter reaches zero, which chains phases without a thread blocking.
+            class Counter {
+                public:
+                    Counter() = default;
+
+                    Counter(const Counter &) = delete;
+                    Counter &operator=(const Counter &) = delete;
+
+                    // For polling; use LveJobSystem::wait() before destroying the counter
+                    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+                private:
+                    friend class LveJobSystem;
+
+                    struct HeldJob {
+                        Job fn;
+                        Counter *counter;
+                    };
+
+                    std::atomic<uint32_t> pending{0};
+                    // Guards the members below and orders the last finish() before wait() returns
+                    std::mutex mutex;
+                    std::vector<HeldJob> continuations;
+                    std::exception_ptr error;
+            };
+
+            struct Stats {
+                uint64_t executed = 0;
+                // Executed by a thread other than the one whose deque the job was pushed to
+                uint64_t stolen = 0;
+            };
+
+            // Hardware threads minus one, leaving a core for the thread that created the pool, but at
+            // least one
+            static uint32_t defaultWorkerCount();
+
+            // A pool without workers runs everything on threads that wait
+            explicit LveJobSystem(uint32_t workerCount = defaultWorkerCount());
+            // Runs every queued job before joining the workers
+            ~LveJobSystem();
+
+            LveJobSystem(const LveJobSystem &) = delete;
+            LveJobSystem &operator=(const LveJobSystem &) = delete;
+
+            // Queues fn. If counter is set it counts fn until it returns and keeps anything fn
+            // throws for wait(); an uncounted job must not throw. If dependency is set, fn is only
+            // queued once dependency reaches zero. Counters must outlive the jobs using them.
+            void run(Job fn, Counter *counter = nullptr, Counter *dependency = nullptr);
+
+            // Calls fn over [0, count) in ranges of at most grainSize and returns when all are done.
+            // The caller runs the first range itself and then helps with the rest.
+            void parallelFor(
+                uint32_t count,
+                uint32_t grainSize,
+                const std::function<void(uint32_t begin, uint32_t end)> &fn);
+
+            // Runs queued jobs on the calling thread until counter reaches zero, then rethrows the
+            // first exception a job counted by it threw
+            void wait(Counter &counter);
+
+            // Runs one queued job on the calling thread, e.g. from the main thread between frames.
+            // Returns false when there was nothing to run.
+            bool runPendingJob();
+
+            uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+            Stats getStats() const;
+
+        private:
+            struct Task {
+                Job fn;
+                Counter *counter = nullptr;
+                uint32_t queue = 0;
+            };
+
+            // Padded so neighbouring deques do not share a cache line
+            struct alignas(64) Queue {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+                std::atomic<uint64_t> executed{0};
+                std::atomic<uint64_t> stolen{0};
+            };
+
+            void workerLoop(uint32_t queue);
+            void push(Task task);
+            bool tryPop(uint32_t self, Task &task);
+            void execute(uint32_t self, Task &task);
+            void finish(Counter &counter, std::exception_ptr error);
+            uint32_t currentQueue() const;
+
+            // Queue 0 is shared by threads outside the pool, queue i + 1 belongs to worker i
+            std::vector<std::unique_ptr<Queue>> queues;
+            std::vector<std::thread> workers;
+            std::atomic<uint32_t> queuedTasks{0};
+
+            std::mutex sleepMutex;
+            std::condition_variable wake;
+            std::atomic<uint32_t> sleepingWorkers{0};
+            bool stopping = false;
+    };
+}
@@ -0,0 +1,231 @@
+#include "lve_ktx2.hpp"
+
+#include "lve_mapped_file.hpp"
+
+// libs
+#include <zlib.h>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    namespace {
+        const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        // Identifier, nine header fields and the data format, key/value and global data index
+        constexpr size_t HEADER_BYTES = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+        constexpr size_t LEVEL_INDEX_BYTES = 3 * 8;
+
+        constexpr uint32_t SUPERCOMPRESSION_NONE = 0;
+        constexpr uint32_t SUPERCOMPRESSION_ZLIB = 3;
+
+        uint32_t readLittleEndian32(const uint8_t *bytes) {
+            return uint32_t{bytes[0]} | (uint32_t{bytes[1]} << 8) | (uint32_t{bytes[2]} << 16) | (uint32_t{bytes[3]} << 24);
+        }
+
+        uint64_t readLittleEndian64(const uint8_t *bytes) {
+            return uint64_t{readLittleEndian32(bytes)} | (uint64_t{readLittleEndian32(bytes + 4)} << 32);
+        }
+    }
+
+    LveTexelBlock getTexelBlock(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+                return {1, 1, 4};
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_BC4_SNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+            case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+                return {4, 4, 8};
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC5_SNORM_BLOCK:
+            case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+            case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+            case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+                return {4, 4, 16};
+            case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+                return {4, 4, 16};
+            case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+                return {5, 4, 16};
+            case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+                return {5, 5, 16};
+            case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+                return {6, 5, 16};
+            case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+                return {6, 6, 16};
+            case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+                return {8, 5, 16};
+            case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+                return {8, 6, 16};
+            case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+                return {8, 8, 16};
+            case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+                return {10, 5, 16};
+            case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+                return {10, 6, 16};
+            case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+                return {10, 8, 16};
+            case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+                return {10, 10, 16};
+            case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+                return {12, 10, 16};
+            case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+                return {12, 12, 16};
+            default:
+                return {1, 1, 0};
+        }
+    }
+
+    bool isSrgbFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    size_t getLevelBytes(VkFormat format, uint32_t width, uint32_t height) {
+        const LveTexelBlock block = getTexelBlock(format);
+        const size_t blocksWide = (width + block.width - 1) / block.width;
+        const size_t blocksHigh = (height + block.height - 1) / block.height;
+        return blocksWide * blocksHigh * block.bytes;
+    }
+
+    bool isKtx2(const uint8_t *data, size_t size) {
+        return size >= sizeof(KTX2_IDENTIFIER) && std::memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0;
+    }
+
+    LveKtx2Image parseKtx2(const uint8_t *data, size_t size) {
+        if (!isKtx2(data, size) || size < HEADER_BYTES) {
+            throw std::runtime_error("not a KTX2 file");
+        }
+        const uint8_t *header = data + sizeof(KTX2_IDENTIFIER);
+        LveKtx2Image image{};
+        image.format = static_cast<VkFormat>(readLittleEndian32(header));
+        image.width = readLittleEndian32(header + 8);
+        image.height = readLittleEndian32(header + 12);
+        const uint32_t depth = readLittleEndian32(header + 16);
+        const uint32_t layerCount = readLittleEndian32(header + 20);
+        const uint32_t faceCount = readLittleEndian32(header + 24);
+        // 0 asks the loader to generate mips, which the streamer does for RGBA8 anyway
+        const uint32_t levelCount = std::max(readLittleEndian32(header + 28), 1u);
+        const uint32_t supercompression = readLittleEndian32(header + 32);
+
+        if (getTexelBlock(image.format).bytes == 0) {
+            throw std::runtime_error("unsupported KTX2 format " + std::to_string(image.format));
+        }
+        if (image.width == 0 || image.height == 0 || depth > 1 || layerCount > 1 || faceCount != 1) {
+            throw std::runtime_error("only 2D KTX2 textures with one layer and face are supported");
+        }
+        if (supercompression != SUPERCOMPRESSION_NONE && supercompression != SUPERCOMPRESSION_ZLIB) {
+            throw std::runtime_error("unsupported KTX2 supercompression scheme " + std::to_string(supercompression));
+        }
+        uint32_t fullChainLevels = 1;
+        while (fullChainLevels < 32 && std::max(image.width, image.height) >> fullChainLevels) {
+            fullChainLevels++;
+        }
+        // The level count becomes the image's mipLevels, which Vulkan bounds by the full chain
+        if (levelCount > fullChainLevels) {
+            throw std::runtime_error("KTX2 file has " + std::to_string(levelCount) + " levels, a " +
+                std::to_string(image.width) + "x" + std::to_string(image.height) + " image has at most " +
+                std::to_string(fullChainLevels));
+        }
+        if ((size - HEADER_BYTES) / LEVEL_INDEX_BYTES < levelCount) {
+            throw std::runtime_error("truncated KTX2 level index");
+        }
+
+        image.levels.resize(levelCount);
+        for (uint32_t level = 0; level < levelCount; level++) {
+            const uint8_t *entry = data + HEADER_BYTES + level * LEVEL_INDEX_BYTES;
+            const uint64_t offset = readLittleEndian64(entry);
+            const uint64_t length = readLittleEndian64(entry + 8);
+            const uint64_t uncompressedLength = readLittleEndian64(entry + 16);
+            const size_t expected = getLevelBytes(
+                image.format, std::max(image.width >> level, 1u), std::max(image.height >> level, 1u));
+            if (offset > size || length > size - offset) {
+                throw std::runtime_error("truncated KTX2 level data");
+            }
+
+            std::vector<uint8_t> &levelData = image.levels[level];
+            if (supercompression == SUPERCOMPRESSION_NONE) {
+                if (length != expected) {
+                    throw std::runtime_error("KTX2 level " + std::to_string(level) + " has the wrong size");
+                }
+                levelData.assign(data + offset, data + offset + length);
+            } else {
+                if (uncompressedLength != expected) {
+                    throw std::runtime_error("KTX2 level " + std::to_string(level) + " has the wrong size");
+                }
+                levelData.resize(expected);
+                uLongf inflatedSize = static_cast<uLongf>(expected);
+                if (uncompress(levelData.data(), &inflatedSize, data + offset, static_cast<uLong>(length)) != Z_OK ||
+                    inflatedSize != expected) {
+                    throw std::runtime_error("corrupt KTX2 level " + std::to_string(level));
+                }
+            }
+        }
+        return image;
+    }
+
+    LveKtx2Image loadKtx2(const std::string &path) {
+        LveMappedFile file{path};
+        return parseKtx2(file.data(), file.size());
+    }
+}
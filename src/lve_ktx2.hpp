@@ -0,0 +1,42 @@
+#pragma once
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Texels per block and bytes per block; uncompressed formats have 1 x 1 blocks
+    struct LveTexelBlock {
+        uint32_t width = 1;
+        uint32_t height = 1;
+        uint32_t bytes = 0;
+    };
+
+    // RGBA8, BC1-7, ETC2/EAC and ASTC LDR; bytes is 0 for any other format
+    LveTexelBlock getTexelBlock(VkFormat format);
+    bool isSrgbFormat(VkFormat format);
+    // Bytes of one tightly packed level of width x height texels
+    size_t getLevelBytes(VkFormat format, uint32_t width, uint32_t height);
+
+    // One 2D texture from a KTX2 container, with the levels it stores
+    struct LveKtx2Image {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        // Level 0 first, each as tightly packed rows of texel blocks
+        std::vector<std::vector<uint8_t>> levels;
+    };
+
+    bool isKtx2(const uint8_t *data, size_t size);
+    // 2D, one layer and face, in a format getTexelBlock() knows. Levels may be stored as is
+    // or zlib supercompressed; Basis Universal and Zstandard payloads are rejected.
+    // Thread safe, so loading can run on workers.
+    LveKtx2Image parseKtx2(const uint8_t *data, size_t size);
+    LveKtx2Image loadKtx2(const std::string &path);
+}
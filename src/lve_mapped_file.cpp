@@ -0,0 +1,60 @@
+#include "lve_mapped_file.hpp"
+
+// std
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LVE_MAPPED_FILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lve {
+
+    LveMappedFile::LveMappedFile(const std::string &path) {
+#if defined(LVE_MAPPED_FILE_POSIX)
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open file: " + path);
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("failed to stat file: " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                // Parsers touch every page, so have the kernel start reading ahead now
+                madvise(address, length, MADV_WILLNEED);
+                mapped = static_cast<const uint8_t *>(address);
+            }
+        }
+        close(fd);
+        if (mapped || length == 0) {
+            return;
+        }
+#endif
+        std::ifstream file{path, std::ios::ate | std::ios::binary};
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open file: " + path);
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        mapped = buffer.data();
+        length = buffer.size();
+    }
+
+    LveMappedFile::~LveMappedFile() {
+#if defined(LVE_MAPPED_FILE_POSIX)
+        if (mapped && buffer.empty()) {
+            munmap(const_cast<uint8_t *>(mapped), length);
+        }
+#endif
+    }
+}
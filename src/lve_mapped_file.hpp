@@ -0,0 +1,31 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Read-only view of a whole file. Memory mapped where the platform allows, so pages are only
+    // read when touched and parsers can point straight into the file; elsewhere it is read into
+    // memory once.
+    class LveMappedFile {
+        public:
+            explicit LveMappedFile(const std::string &path);
+            ~LveMappedFile();
+
+            LveMappedFile(const LveMappedFile &) = delete;
+            LveMappedFile &operator=(const LveMappedFile &) = delete;
+
+            const uint8_t *data() const { return mapped; }
+            size_t size() const { return length; }
+
+        private:
+            const uint8_t *mapped = nullptr;
+            size_t length = 0;
+            // Holds the contents when the file could not be mapped
+            std::vector<uint8_t> buffer;
+    };
+}
@@ -0,0 +1,759 @@
+#include "lve_mesh_importer.hpp"
+#include "lve_mapped_file.hpp"
+
+// std
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace lve {
+
+    // Elements each job copies out of a glTF accessor
+    static constexpr uint32_t GLB_GRAIN = 1 << 16;
+
+    namespace {
+
+        // ------------------------------------------------------------------ OBJ
+
+        struct ObjChunk {
+            const char *begin;
+            const char *end;
+            uint32_t vertexCount = 0;
+            uint32_t triangleCount = 0;
+            uint32_t firstVertex = 0;
+            size_t firstTriangle = 0;
+        };
+
+        bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        bool isLineEnd(const char *p, const char *end) { return p == end || *p == '\n' || *p == '#'; }
+
+        const char *skipBlanks(const char *p, const char *end) {
+            while (p < end && isBlank(*p)) {
+                p++;
+            }
+            return p;
+        }
+
+        const char *skipLine(const char *p, const char *end) {
+            const void *newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            return newline ? static_cast<const char *>(newline) + 1 : end;
+        }
+
+        // Checks and converts eight ASCII digits at once in a 64-bit register, lowest address first
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        constexpr bool SWAR_DIGITS = false;
+#else
+        constexpr bool SWAR_DIGITS = true;
+#endif
+
+        bool isEightDigits(uint64_t chunk) {
+            return (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+                    0x3333333333333333);
+        }
+
+        uint32_t parseEightDigits(uint64_t chunk) {
+            chunk -= 0x3030303030303030;
+            chunk = (chunk * 10) + (chunk >> 8);
+            chunk = (((chunk & 0x000000FF000000FF) * 0x000F424000000064) +
+                     (((chunk >> 16) & 0x000000FF000000FF) * 0x0000271000000001)) >> 32;
+            return static_cast<uint32_t>(chunk);
+        }
+
+        constexpr double POWERS_OF_TEN[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        // Decimal digits go into one integer mantissa and the point only moves the exponent, so a
+        // number costs a single multiply or divide by an exact power of ten. Returns null if no
+        // number starts at p.
+        const char *parseNumber(const char *p, const char *end, double &out) {
+            p = skipBlanks(p, end);
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                p++;
+            }
+
+            uint64_t mantissa = 0;
+            int32_t exponent = 0;
+            uint32_t digits = 0;
+            bool any = false;
+            auto takeDigits = [&](bool fraction) {
+                while (SWAR_DIGITS && end - p >= 8 && digits + 8 <= 19) {
+                    uint64_t chunk;
+                    std::memcpy(&chunk, p, sizeof(chunk));
+                    if (!isEightDigits(chunk)) {
+                        break;
+                    }
+                    mantissa = mantissa * 100000000 + parseEightDigits(chunk);
+                    digits += 8;
+                    exponent -= fraction ? 8 : 0;
+                    p += 8;
+                    any = true;
+                }
+                while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                    if (digits < 19) {
+                        mantissa = mantissa * 10 + static_cast<uint32_t>(*p - '0');
+                        digits += mantissa != 0 ? 1 : 0;
+                        exponent -= fraction ? 1 : 0;
+                    } else if (!fraction) {
+                        exponent++;
+                    }
+                    p++;
+                    any = true;
+                }
+            };
+            takeDigits(false);
+            if (p < end && *p == '.') {
+                p++;
+                takeDigits(true);
+            }
+            if (!any) {
+                return nullptr;
+            }
+
+            if (p < end && (*p == 'e' || *p == 'E')) {
+                p++;
+                bool negativeExponent = false;
+                if (p < end && (*p == '-' || *p == '+')) {
+                    negativeExponent = *p == '-';
+                    p++;
+                }
+                if (p == end || static_cast<unsigned>(*p - '0') >= 10) {
+                    return nullptr;
+                }
+                int32_t written = 0;
+                while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                    written = std::min(written * 10 + (*p - '0'), 100000);
+                    p++;
+                }
+                exponent += negativeExponent ? -written : written;
+            }
+
+            double value = static_cast<double>(mantissa);
+            if (exponent >= 0 && exponent <= 22) {
+                value *= POWERS_OF_TEN[exponent];
+            } else if (exponent < 0 && exponent >= -22) {
+                value /= POWERS_OF_TEN[-exponent];
+            } else {
+                value *= std::pow(10.0, exponent);
+            }
+            out = negative ? -value : value;
+            return p;
+        }
+
+        const char *parseFloat(const char *p, const char *end, float &out) {
+            double value = 0.0;
+            p = parseNumber(p, end, value);
+            out = static_cast<float>(value);
+            return p;
+        }
+
+        const char *parseIndex(const char *p, const char *end, int64_t &out) {
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                p++;
+            }
+            if (p == end || static_cast<unsigned>(*p - '0') >= 10) {
+                return nullptr;
+            }
+            int64_t value = 0;
+            while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                value = std::min<int64_t>(value * 10 + (*p - '0'), INT64_C(1) << 40);
+                p++;
+            }
+            out = negative ? -value : value;
+            return p;
+        }
+
+        bool startsElement(const char *p, const char *end, char element) {
+            return *p == element && p + 1 < end && isBlank(p[1]);
+        }
+
+        void countObjChunk(ObjChunk &chunk) {
+            const char *p = chunk.begin;
+            const char *end = chunk.end;
+            while (p < end) {
+                p = skipBlanks(p, end);
+                if (p == end) {
+                    break;
+                }
+                if (startsElement(p, end, 'v')) {
+                    chunk.vertexCount++;
+                } else if (startsElement(p, end, 'f')) {
+                    uint32_t corners = 0;
+                    p++;
+                    while (true) {
+                        p = skipBlanks(p, end);
+                        if (isLineEnd(p, end)) {
+                            break;
+                        }
+                        corners++;
+                        while (p < end && !isBlank(*p) && *p != '\n') {
+                            p++;
+                        }
+                    }
+                    chunk.triangleCount += corners >= 3 ? corners - 2 : 0;
+                }
+                p = skipLine(p, end);
+            }
+        }
+
+        void parseObjChunk(const ObjChunk &chunk, uint32_t totalVertices, glm::vec3 *positions, uint32_t *indices) {
+            const char *p = chunk.begin;
+            const char *end = chunk.end;
+            uint32_t vertex = chunk.firstVertex;
+            uint32_t *out = indices + chunk.firstTriangle * 3;
+            while (p < end) {
+                p = skipBlanks(p, end);
+                if (p == end) {
+                    break;
+                }
+                if (startsElement(p, end, 'v')) {
+                    glm::vec3 &position = positions[vertex++];
+                    p++;
+                    for (int axis = 0; axis < 3; axis++) {
+                        p = parseFloat(p, end, position[axis]);
+                        if (!p) {
+                            throw std::runtime_error("OBJ vertex needs three coordinates");
+                        }
+                    }
+                } else if (startsElement(p, end, 'f')) {
+                    uint32_t corner = 0;
+                    uint32_t first = 0;
+                    uint32_t previous = 0;
+                    p++;
+                    while (true) {
+                        p = skipBlanks(p, end);
+                        if (isLineEnd(p, end)) {
+                            break;
+                        }
+                        int64_t index = 0;
+                        p = parseIndex(p, end, index);
+                        if (!p || index == 0) {
+                            throw std::runtime_error("invalid OBJ face index");
+                        }
+                        // Negative indices count back from the vertices defined so far
+                        const int64_t resolved = index > 0 ? index - 1 : static_cast<int64_t>(vertex) + index;
+                        if (resolved < 0 || resolved >= totalVertices) {
+                            throw std::runtime_error("OBJ face references a missing vertex");
+                        }
+                        const uint32_t current = static_cast<uint32_t>(resolved);
+                        // Texture and normal indices after the slashes are not needed
+                        while (p < end && !isBlank(*p) && *p != '\n') {
+                            p++;
+                        }
+
+                        if (corner == 0) {
+                            first = current;
+                        } else if (corner >= 2) {
+                            out[0] = first;
+                            out[1] = previous;
+                            out[2] = current;
+                            out += 3;
+                        }
+                        previous = current;
+                        corner++;
+                    }
+                }
+                p = skipLine(p, end);
+            }
+        }
+
+        // ------------------------------------------------------------------ glTF
+
+        // Just enough JSON for the glTF header chunk
+        struct JsonValue {
+            enum class Type { Null, Bool, Number, String, Array, Object };
+
+            Type type = Type::Null;
+            bool boolean = false;
+            double number = 0.0;
+            std::string string;
+            std::vector<JsonValue> items;
+            std::vector<std::pair<std::string, JsonValue>> members;
+
+            const JsonValue *find(const char *key) const {
+                for (const auto &member : members) {
+                    if (member.first == key) {
+                        return &member.second;
+                    }
+                }
+                return nullptr;
+            }
+
+            uint32_t getUint(const char *key, uint32_t fallback) const {
+                const JsonValue *value = find(key);
+                return value && value->type == Type::Number ? static_cast<uint32_t>(value->number) : fallback;
+            }
+
+            uint32_t requireUint(const char *key) const {
+                const JsonValue *value = find(key);
+                if (!value || value->type != Type::Number || value->number < 0.0) {
+                    throw std::runtime_error(std::string{"glTF: missing "} + key);
+                }
+                return static_cast<uint32_t>(value->number);
+            }
+
+            const JsonValue &at(const char *key, uint32_t index) const {
+                const JsonValue *array = find(key);
+                if (!array || array->type != Type::Array || index >= array->items.size()) {
+                    throw std::runtime_error(std::string{"glTF: bad reference into "} + key);
+                }
+                return array->items[index];
+            }
+        };
+
+        class JsonParser {
+            public:
+                JsonParser(const char *begin, const char *end) : p{begin}, end{end} {}
+
+                JsonValue parseDocument() {
+                    JsonValue value = parseValue(0);
+                    skipSpace();
+                    if (p != end) {
+                        throw std::runtime_error("glTF: trailing data after JSON");
+                    }
+                    return value;
+                }
+
+            private:
+                static constexpr uint32_t MAX_DEPTH = 64;
+
+                void skipSpace() {
+                    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+                        p++;
+                    }
+                }
+
+                void expect(char c) {
+                    skipSpace();
+                    if (p == end || *p != c) {
+                        throw std::runtime_error(std::string{"glTF: expected '"} + c + "' in JSON");
+                    }
+                    p++;
+                }
+
+                bool consumeLiteral(const char *literal) {
+                    const size_t length = std::strlen(literal);
+                    if (static_cast<size_t>(end - p) >= length && std::memcmp(p, literal, length) == 0) {
+                        p += length;
+                        return true;
+                    }
+                    return false;
+                }
+
+                JsonValue parseValue(uint32_t depth) {
+                    if (depth > MAX_DEPTH) {
+                        throw std::runtime_error("glTF: JSON nested too deeply");
+                    }
+                    skipSpace();
+                    if (p == end) {
+                        throw std::runtime_error("glTF: truncated JSON");
+                    }
+                    JsonValue value;
+                    if (*p == '{') {
+                        value.type = JsonValue::Type::Object;
+                        p++;
+                        skipSpace();
+                        if (p < end && *p == '}') {
+                            p++;
+                            return value;
+                        }
+                        while (true) {
+                            skipSpace();
+                            std::string key = parseString();
+                            expect(':');
+                            value.members.emplace_back(std::move(key), parseValue(depth + 1));
+                            skipSpace();
+                            if (p < end && *p == ',') {
+                                p++;
+                                continue;
+                            }
+                            expect('}');
+                            return value;
+                        }
+                    }
+                    if (*p == '[') {
+                        value.type = JsonValue::Type::Array;
+                        p++;
+                        skipSpace();
+                        if (p < end && *p == ']') {
+                            p++;
+                            return value;
+                        }
+                        while (true) {
+                            value.items.push_back(parseValue(depth + 1));
+                            skipSpace();
+                            if (p < end && *p == ',') {
+                                p++;
+                                continue;
+                            }
+                            expect(']');
+                            return value;
+                        }
+                    }
+                    if (*p == '"') {
+                        value.type = JsonValue::Type::String;
+                        value.string = parseString();
+                        return value;
+                    }
+                    if (consumeLiteral("true")) {
+                        value.type = JsonValue::Type::Bool;
+                        value.boolean = true;
+                        return value;
+                    }
+                    if (consumeLiteral("false")) {
+                        value.type = JsonValue::Type::Bool;
+                        return value;
+                    }
+                    if (consumeLiteral("null")) {
+                        return value;
+                    }
+                    const char *next = parseNumber(p, end, value.number);
+                    if (!next) {
+                        throw std::runtime_error("glTF: unexpected character in JSON");
+                    }
+                    value.type = JsonValue::Type::Number;
+                    p = next;
+                    return value;
+                }
+
+                // Escapes are kept as plain characters; glTF keys and the fields read here are ASCII
+                std::string parseString() {
+                    if (p == end || *p != '"') {
+                        throw std::runtime_error("glTF: expected a JSON string");
+                    }
+                    p++;
+                    std::string result;
+                    while (p < end && *p != '"') {
+                        if (*p == '\\' && p + 1 < end) {
+                            p++;
+                            if (*p == 'u') {
+                                // \uXXXX
+                                p += std::min<ptrdiff_t>(5, end - p);
+                                result.push_back('?');
+                                continue;
+                            }
+                        }
+                        result.push_back(*p++);
+                    }
+                    if (p == end) {
+                        throw std::runtime_error("glTF: unterminated JSON string");
+                    }
+                    p++;
+                    return result;
+                }
+
+                const char *p;
+                const char *end;
+        };
+
+        constexpr uint32_t GLB_MAGIC = 0x46546C67;
+        constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+        constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+        constexpr uint32_t GL_UNSIGNED_BYTE = 5121;
+        constexpr uint32_t GL_UNSIGNED_SHORT = 5123;
+        constexpr uint32_t GL_UNSIGNED_INT = 5125;
+        constexpr uint32_t GL_FLOAT = 5126;
+
+        constexpr uint32_t MODE_TRIANGLES = 4;
+        constexpr uint32_t MODE_TRIANGLE_STRIP = 5;
+        constexpr uint32_t MODE_TRIANGLE_FAN = 6;
+
+        uint32_t readU32(const uint8_t *p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        // Points into the binary chunk; nothing is copied until the elements are read
+        struct AccessorView {
+            const uint8_t *data = nullptr;
+            uint32_t count = 0;
+            uint32_t stride = 0;
+            uint32_t componentType = 0;
+
+            uint32_t readIndex(uint32_t i) const {
+                const uint8_t *element = data + static_cast<size_t>(i) * stride;
+                switch (componentType) {
+                    case GL_UNSIGNED_BYTE:
+                        return *element;
+                    case GL_UNSIGNED_SHORT: {
+                        uint16_t value;
+                        std::memcpy(&value, element, sizeof(value));
+                        return value;
+                    }
+                    default:
+                        return readU32(element);
+                }
+            }
+
+            glm::vec3 readVec3(uint32_t i) const {
+                float xyz[3];
+                std::memcpy(xyz, data + static_cast<size_t>(i) * stride, sizeof(xyz));
+                return {xyz[0], xyz[1], xyz[2]};
+            }
+        };
+
+        AccessorView resolveAccessor(
+            const JsonValue &gltf, uint32_t index, const uint8_t *bin, size_t binSize, bool positions) {
+            const JsonValue &accessor = gltf.at("accessors", index);
+            if (accessor.find("sparse")) {
+                throw std::runtime_error("glTF: sparse accessors are not supported");
+            }
+            const JsonValue *type = accessor.find("type");
+            AccessorView view{};
+            view.count = accessor.requireUint("count");
+            view.componentType = accessor.requireUint("componentType");
+
+            uint32_t elementSize = 0;
+            if (positions) {
+                if (!type || type->string != "VEC3" || view.componentType != GL_FLOAT) {
+                    throw std::runtime_error("glTF: positions must be float VEC3");
+                }
+                elementSize = 12;
+            } else {
+                if (!type || type->string != "SCALAR") {
+                    throw std::runtime_error("glTF: indices must be SCALAR");
+                }
+                switch (view.componentType) {
+                    case GL_UNSIGNED_BYTE: elementSize = 1; break;
+                    case GL_UNSIGNED_SHORT: elementSize = 2; break;
+                    case GL_UNSIGNED_INT: elementSize = 4; break;
+                    default: throw std::runtime_error("glTF: unsupported index component type");
+                }
+            }
+
+            const JsonValue &bufferView = gltf.at("bufferViews", accessor.requireUint("bufferView"));
+            if (bufferView.getUint("buffer", 0) != 0 || !bin) {
+                throw std::runtime_error("glTF: only the embedded binary buffer is supported");
+            }
+            const size_t viewOffset = bufferView.getUint("byteOffset", 0);
+            const size_t viewLength = bufferView.requireUint("byteLength");
+            const size_t accessorOffset = accessor.getUint("byteOffset", 0);
+            view.stride = bufferView.getUint("byteStride", elementSize);
+            const size_t span = view.count == 0 ? 0 : static_cast<size_t>(view.count - 1) * view.stride + elementSize;
+            if (viewOffset + viewLength > binSize || accessorOffset + span > viewLength || view.stride < elementSize) {
+                throw std::runtime_error("glTF: accessor outside its buffer view");
+            }
+            view.data = bin + viewOffset + accessorOffset;
+            return view;
+        }
+
+        struct GlbPrimitive {
+            AccessorView positions;
+            AccessorView indices;
+            bool indexed;
+            uint32_t mode;
+            uint32_t firstVertex;
+            size_t firstTriangle;
+            uint32_t triangleCount;
+        };
+    }
+
+    std::vector<LveModel::Vertex> LveMeshData::toModelVertices() const {
+        glm::vec2 minBounds{0.0f};
+        glm::vec2 maxBounds{0.0f};
+        if (!positions.empty()) {
+            minBounds = maxBounds = {positions[0].x, positions[0].y};
+        }
+        for (const auto &position : positions) {
+            minBounds = glm::min(minBounds, glm::vec2{position.x, position.y});
+            maxBounds = glm::max(maxBounds, glm::vec2{position.x, position.y});
+        }
+        const glm::vec2 center = (minBounds + maxBounds) * 0.5f;
+        const float extent = std::max(maxBounds.x - minBounds.x, maxBounds.y - minBounds.y);
+        const float scale = extent > 0.0f ? 2.0f / extent : 1.0f;
+
+        std::vector<LveModel::Vertex> vertices(positions.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            vertices[i].position = {(positions[i].x - center.x) * scale, (center.y - positions[i].y) * scale};
+        }
+        return vertices;
+    }
+
+    LveMeshImporter::LveMeshImporter(LveJobSystem &jobSystem) : jobSystem{jobSystem} {}
+
+    LveMeshData LveMeshImporter::load(const std::string &path) {
+        std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+
+        LveMappedFile file{path};
+        if (extension == ".obj") {
+            return loadObj(reinterpret_cast<const char *>(file.data()), file.size());
+        }
+        if (extension == ".glb") {
+            return loadGlb(file.data(), file.size());
+        }
+        throw std::runtime_error("unsupported mesh format: " + path);
+    }
+
+    LveMeshData LveMeshImporter::loadObj(const char *text, size_t size) {
+        std::vector<ObjChunk> chunks;
+        const char *end = text + size;
+        for (const char *p = text; p < end;) {
+            const char *chunkEnd = p + std::min(OBJ_CHUNK_SIZE, static_cast<size_t>(end - p));
+            // Always finish on a line break, so no line is split between two jobs
+            chunkEnd = skipLine(chunkEnd - 1, end);
+            chunks.push_back({p, chunkEnd});
+            p = chunkEnd;
+        }
+        const uint32_t chunkCount = static_cast<uint32_t>(chunks.size());
+
+        jobSystem.parallelFor(chunkCount, 1, [&chunks](uint32_t begin, uint32_t last) {
+            for (uint32_t i = begin; i < last; i++) {
+                countObjChunk(chunks[i]);
+            }
+        });
+
+        uint64_t totalVertices = 0;
+        size_t totalTriangles = 0;
+        for (auto &chunk : chunks) {
+            chunk.firstVertex = static_cast<uint32_t>(totalVertices);
+            chunk.firstTriangle = totalTriangles;
+            totalVertices += chunk.vertexCount;
+            totalTriangles += chunk.triangleCount;
+        }
+        if (totalVertices > UINT32_MAX) {
+            throw std::runtime_error("OBJ has too many vertices for 32-bit indices");
+        }
+
+        LveMeshData mesh;
+        mesh.positions.resize(totalVertices);
+        mesh.indices.resize(totalTriangles * 3);
+        const uint32_t vertexCount = static_cast<uint32_t>(totalVertices);
+        jobSystem.parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t last) {
+            for (uint32_t i = begin; i < last; i++) {
+                parseObjChunk(chunks[i], vertexCount, mesh.positions.data(), mesh.indices.data());
+            }
+        });
+        return mesh;
+    }
+
+    LveMeshData LveMeshImporter::loadGlb(const uint8_t *data, size_t size) {
+        if (size < 20 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2) {
+            throw std::runtime_error("not a glTF 2.0 binary file");
+        }
+        size = std::min<size_t>(size, readU32(data + 8));
+
+        const uint8_t *json = nullptr;
+        size_t jsonSize = 0;
+        const uint8_t *bin = nullptr;
+        size_t binSize = 0;
+        for (size_t offset = 12; offset + 8 <= size;) {
+            const size_t chunkSize = readU32(data + offset);
+            const uint32_t chunkType = readU32(data + offset + 4);
+            if (offset + 8 + chunkSize > size) {
+                throw std::runtime_error("glTF: truncated chunk");
+            }
+            if (chunkType == GLB_CHUNK_JSON && !json) {
+                json = data + offset + 8;
+                jsonSize = chunkSize;
+            } else if (chunkType == GLB_CHUNK_BIN && !bin) {
+                bin = data + offset + 8;
+                binSize = chunkSize;
+            }
+            offset += 8 + ((chunkSize + 3) & ~size_t{3});
+        }
+        if (!json) {
+            throw std::runtime_error("glTF: missing JSON chunk");
+        }
+        const char *jsonText = reinterpret_cast<const char *>(json);
+        const JsonValue gltf = JsonParser{jsonText, jsonText + jsonSize}.parseDocument();
+
+        std::vector<GlbPrimitive> primitives;
+        uint64_t totalVertices = 0;
+        size_t totalTriangles = 0;
+        const JsonValue *meshes = gltf.find("meshes");
+        if (meshes && meshes->type == JsonValue::Type::Array) {
+            for (const auto &mesh : meshes->items) {
+                const JsonValue *meshPrimitives = mesh.find("primitives");
+                if (!meshPrimitives || meshPrimitives->type != JsonValue::Type::Array) {
+                    continue;
+                }
+                for (const auto &primitive : meshPrimitives->items) {
+                    const uint32_t mode = primitive.getUint("mode", MODE_TRIANGLES);
+                    const JsonValue *attributes = primitive.find("attributes");
+                    // Points and lines have no triangles to import
+                    if (mode < MODE_TRIANGLES || mode > MODE_TRIANGLE_FAN || !attributes ||
+                        !attributes->find("POSITION")) {
+                        continue;
+                    }
+
+                    GlbPrimitive entry{};
+                    entry.mode = mode;
+                    entry.positions = resolveAccessor(gltf, attributes->requireUint("POSITION"), bin, binSize, true);
+                    entry.indexed = primitive.find("indices") != nullptr;
+                    if (entry.indexed) {
+                        entry.indices = resolveAccessor(gltf, primitive.requireUint("indices"), bin, binSize, false);
+                    }
+                    const uint32_t elementCount = entry.indexed ? entry.indices.count : entry.positions.count;
+                    if (mode == MODE_TRIANGLES) {
+                        entry.triangleCount = elementCount / 3;
+                    } else {
+                        entry.triangleCount = elementCount >= 3 ? elementCount - 2 : 0;
+                    }
+                    entry.firstVertex = static_cast<uint32_t>(totalVertices);
+                    entry.firstTriangle = totalTriangles;
+                    totalVertices += entry.positions.count;
+                    totalTriangles += entry.triangleCount;
+                    primitives.push_back(entry);
+                }
+            }
+        }
+        if (totalVertices > UINT32_MAX) {
+            throw std::runtime_error("glTF has too many vertices for 32-bit indices");
+        }
+
+        LveMeshData mesh;
+        mesh.positions.resize(totalVertices);
+        mesh.indices.resize(totalTriangles * 3);
+        for (const auto &primitive : primitives) {
+            glm::vec3 *positions = mesh.positions.data() + primitive.firstVertex;
+            jobSystem.parallelFor(primitive.positions.count, GLB_GRAIN, [&primitive, positions](uint32_t begin, uint32_t last) {
+                for (uint32_t i = begin; i < last; i++) {
+                    positions[i] = primitive.positions.readVec3(i);
+                }
+            });
+
+            uint32_t *indices = mesh.indices.data() + primitive.firstTriangle * 3;
+            jobSystem.parallelFor(primitive.triangleCount, GLB_GRAIN, [&primitive, indices](uint32_t begin, uint32_t last) {
+                auto element = [&primitive](uint32_t i) {
+                    const uint32_t vertex = primitive.indexed ? primitive.indices.readIndex(i) : i;
+                    if (vertex >= primitive.positions.count) {
+                        throw std::runtime_error("glTF: index outside its primitive's positions");
+                    }
+                    return primitive.firstVertex + vertex;
+                };
+                for (uint32_t triangle = begin; triangle < last; triangle++) {
+                    uint32_t *out = indices + static_cast<size_t>(triangle) * 3;
+                    if (primitive.mode == MODE_TRIANGLES) {
+                        out[0] = element(triangle * 3);
+                        out[1] = element(triangle * 3 + 1);
+                        out[2] = element(triangle * 3 + 2);
+                    } else if (primitive.mode == MODE_TRIANGLE_STRIP) {
+                        // Every other strip triangle swaps its first two corners to keep the winding
+                        const bool odd = (triangle & 1) != 0;
+                        out[0] = element(triangle + (odd ? 1 : 0));
+                        out[1] = element(triangle + (odd ? 0 : 1));
+                        out[2] = element(triangle + 2);
+                    } else if (primitive.mode == MODE_TRIANGLE_FAN) {
+                        out[0] = element(0);
+                        out[1] = element(triangle + 1);
+                        out[2] = element(triangle + 2);
+                    }
+                }
+            });
+        }
+        return mesh;
+    }
+}
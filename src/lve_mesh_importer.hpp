@@ -0,0 +1,52 @@
+#pragma once
+
+#include "lve_job_system.hpp"
+#include "lve_model.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Triangle list as imported: one position per vertex, three indices per triangle
+    struct LveMeshData {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+
+        // x and y scaled uniformly to fit [-1, 1], y flipped to point up on screen
+        std::vector<LveModel::Vertex> toModelVertices() const;
+    };
+
+    // Loads OBJ and binary glTF (.glb) meshes from a memory-mapped file. OBJ text is split into
+    // chunks at line breaks and parsed in two parallel passes: the first counts vertices and
+    // triangles per chunk, so the second can write every chunk straight into its slice of the
+    // output. glTF accessors are read in place from the mapped binary chunk.
+    class LveMeshImporter {
+        public:
+            // OBJ text handed to each parse job
+            static constexpr size_t OBJ_CHUNK_SIZE = 1 << 22;
+
+            explicit LveMeshImporter(LveJobSystem &jobSystem);
+
+            // Picks the format from the extension
+            LveMeshData load(const std::string &path);
+
+            // Faces with more than three corners are fanned; normals and texture coordinates are
+            // skipped
+            LveMeshData loadObj(const char *text, size_t size);
+            // Every triangle primitive of every mesh, in mesh order and without node transforms.
+            // Strips and fans are expanded to lists.
+            LveMeshData loadGlb(const uint8_t *data, size_t size);
+
+        private:
+            LveJobSystem &jobSystem;
+    };
+}
@@ -0,0 +1,286 @@
+#include "lve_mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+
+    namespace {
+        // A FIFO cache kept as the time each vertex last entered it; a vertex is cached while fewer
+        // than cacheSize others have entered since. Skipping time ahead by cacheSize empties it.
+        class FifoCacheTimes {
+            public:
+                FifoCacheTimes(uint32_t vertexCount, uint32_t cacheSize)
+                    : entryTimes(vertexCount, 0), cacheSize{cacheSize}, time{cacheSize + 1} {}
+
+                bool contains(uint32_t vertex) const { return time - entryTimes[vertex] <= cacheSize; }
+                uint32_t age(uint32_t vertex) const { return time - entryTimes[vertex]; }
+
+                // Returns 1 on a miss
+                uint32_t access(uint32_t vertex) {
+                    if (contains(vertex)) {
+                        return 0;
+                    }
+                    entryTimes[vertex] = time++;
+                    return 1;
+                }
+
+                void clear() { time += cacheSize + 1; }
+
+            private:
+                std::vector<uint32_t> entryTimes;
+                uint32_t cacheSize;
+                uint32_t time;
+        };
+    }
+
+    VertexCacheStats analyzeVertexCache(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize) {
+        VertexCacheStats stats{};
+        if (indices.empty()) {
+            return stats;
+        }
+
+        FifoCacheTimes cache{vertexCount, cacheSize};
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        uint32_t misses = 0;
+        uint32_t referencedCount = 0;
+        for (uint32_t index : indices) {
+            misses += cache.access(index);
+            referencedCount += referenced[index] ? 0 : 1;
+            referenced[index] = 1;
+        }
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+        stats.atvr = static_cast<float>(misses) / static_cast<float>(referencedCount);
+        return stats;
+    }
+
+    // Tipsify (Sander, Nehab and Barczak 2007): emit every remaining triangle around a fanning
+    // vertex, then move to the vertex just emitted that is most likely to still be cached once its
+    // own triangles are emitted. Dead ends fall back to recently used vertices, then to input order.
+    std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize) {
+        assert(indices.size() % 3 == 0 && "Triangle list size must be a multiple of 3");
+        const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        if (triangleCount == 0) {
+            return {};
+        }
+
+        // Triangles around each vertex, packed by vertex
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (uint32_t index : indices) {
+            assert(index < vertexCount && "Index out of range");
+            liveTriangles[index]++;
+        }
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t i = 0; i < indices.size(); i++) {
+                adjacency[fill[indices[i]]++] = i / 3;
+            }
+        }
+
+        FifoCacheTimes cache{vertexCount, cacheSize};
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        uint32_t cursor = 0;
+
+        auto skipDeadEnd = [&]() -> int64_t {
+            while (!deadEnds.empty()) {
+                const uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[vertex] > 0) {
+                    return vertex;
+                }
+            }
+            for (; cursor < vertexCount; cursor++) {
+                if (liveTriangles[cursor] > 0) {
+                    return cursor;
+                }
+            }
+            return -1;
+        };
+
+        int64_t fanning = skipDeadEnd();
+        while (fanning >= 0) {
+            candidates.clear();
+            for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+                const uint32_t triangle = adjacency[a];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                emitted[triangle] = 1;
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    cache.access(vertex);
+                }
+            }
+
+            // Prefer the oldest candidate that will still be cached after emitting its triangles
+            int64_t next = -1;
+            int64_t bestPriority = -1;
+            for (uint32_t vertex : candidates) {
+                if (liveTriangles[vertex] == 0) {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (cache.age(vertex) + 2 * liveTriangles[vertex] <= cacheSize) {
+                    priority = cache.age(vertex);
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+            fanning = next >= 0 ? next : skipDeadEnd();
+        }
+        indices.swap(output);
+
+        // A triangle whose vertices all miss starts from a cold cache, so nothing is lost by
+        // drawing what follows at another point in the order
+        std::vector<uint32_t> clusters;
+        FifoCacheTimes replay{vertexCount, cacheSize};
+        for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            uint32_t misses = 0;
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                misses += replay.access(indices[triangle * 3 + corner]);
+            }
+            if (misses == 3 || triangle == 0) {
+                clusters.push_back(triangle);
+            }
+        }
+        return clusters;
+    }
+
+    uint32_t optimizeOverdraw(
+            std::vector<uint32_t> &indices,
+            const std::vector<uint32_t> &clusters,
+            const std::vector<glm::vec3> &positions,
+            float threshold,
+            uint32_t cacheSize) {
+        const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        if (triangleCount == 0 || clusters.empty()) {
+            return 0;
+        }
+        const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+        const float meshAcmr = analyzeVertexCache(indices, vertexCount, cacheSize).acmr;
+
+        // Soft boundaries: cut a cluster as soon as the part drawn so far is about as cache
+        // friendly as the mesh overall, since the cut only costs the next part a cold start
+        std::vector<uint32_t> starts;
+        FifoCacheTimes cache{vertexCount, cacheSize};
+        for (size_t c = 0; c < clusters.size(); c++) {
+            const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+            uint32_t start = clusters[c];
+            uint32_t misses = 0;
+            cache.clear();
+            starts.push_back(start);
+            for (uint32_t triangle = start; triangle < end; triangle++) {
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    misses += cache.access(indices[triangle * 3 + corner]);
+                }
+                const uint32_t drawn = triangle + 1 - start;
+                if (triangle + 1 < end && misses <= threshold * meshAcmr * drawn) {
+                    start = triangle + 1;
+                    misses = 0;
+                    cache.clear();
+                    starts.push_back(start);
+                }
+            }
+        }
+        const uint32_t clusterCount = static_cast<uint32_t>(starts.size());
+
+        // Area weighted centroid and normal of each cluster and of the whole mesh
+        std::vector<glm::vec3> centroids(clusterCount, glm::vec3{0.0f});
+        std::vector<glm::vec3> normals(clusterCount, glm::vec3{0.0f});
+        std::vector<float> areas(clusterCount, 0.0f);
+        glm::vec3 meshCentroid{0.0f};
+        float meshArea = 0.0f;
+        for (uint32_t c = 0; c < clusterCount; c++) {
+            const uint32_t end = c + 1 < clusterCount ? starts[c + 1] : triangleCount;
+            for (uint32_t triangle = starts[c]; triangle < end; triangle++) {
+                const glm::vec3 &a = positions[indices[triangle * 3]];
+                const glm::vec3 &b = positions[indices[triangle * 3 + 1]];
+                const glm::vec3 &p = positions[indices[triangle * 3 + 2]];
+                const glm::vec3 normal = glm::cross(b - a, p - a);
+                const float area = glm::length(normal);
+                centroids[c] += (a + b + p) * (area / 3.0f);
+                normals[c] += normal;
+                areas[c] += area;
+            }
+            meshCentroid += centroids[c];
+            meshArea += areas[c];
+            if (areas[c] > 0.0f) {
+                centroids[c] /= areas[c];
+            }
+        }
+        if (meshArea > 0.0f) {
+            meshCentroid /= meshArea;
+        }
+
+        std::vector<float> keys(clusterCount, 0.0f);
+        for (uint32_t c = 0; c < clusterCount; c++) {
+            const float length = glm::length(normals[c]);
+            if (length > 0.0f) {
+                keys[c] = glm::dot(centroids[c] - meshCentroid, normals[c] / length);
+            }
+        }
+        std::vector<uint32_t> order(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++) {
+            order[c] = c;
+        }
+        std::stable_sort(order.begin(), order.end(), [&keys](uint32_t x, uint32_t y) { return keys[x] > keys[y]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        for (uint32_t c : order) {
+            const uint32_t end = c + 1 < clusterCount ? starts[c + 1] : triangleCount;
+            output.insert(output.end(), indices.begin() + starts[c] * 3, indices.begin() + end * 3);
+        }
+        indices.swap(output);
+        return clusterCount;
+    }
+
+    std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> &indices, uint32_t vertexCount) {
+        std::vector<uint32_t> remap(vertexCount, UNUSED_VERTEX);
+        uint32_t next = 0;
+        for (uint32_t &index : indices) {
+            if (remap[index] == UNUSED_VERTEX) {
+                remap[index] = next++;
+            }
+            index = remap[index];
+        }
+        return remap;
+    }
+
+    std::vector<uint32_t> optimizeMeshIndices(
+            std::vector<uint32_t> &indices,
+            uint32_t vertexCount,
+            const std::vector<glm::vec3> &positions,
+            MeshOptimizeReport &report) {
+        assert((positions.empty() || positions.size() == vertexCount) && "Need one position per vertex");
+        report.before = analyzeVertexCache(indices, vertexCount);
+
+        auto clusters = optimizeVertexCache(indices, vertexCount);
+        report.clusterCount = static_cast<uint32_t>(clusters.size());
+        if (!positions.empty()) {
+            report.clusterCount = optimizeOverdraw(indices, clusters, positions);
+        }
+
+        auto remap = optimizeVertexFetch(indices, vertexCount);
+        report.vertexCount = static_cast<uint32_t>(
+            std::count_if(remap.begin(), remap.end(), [](uint32_t index) { return index != UNUSED_VERTEX; }));
+        report.after = analyzeVertexCache(indices, report.vertexCount);
+        return remap;
+    }
+}
@@ -0,0 +1,185 @@
+#include "lve_mesh_pool.hpp"
+
+// std
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    LveMeshPool::LveMeshPool(
+        LveDevice &device,
+        uint32_t vertexCapacity,
+        uint32_t indexCapacity,
+        uint32_t maxDrawsPerFrame,
+        uint32_t frameCount)
+        : lveDevice{device},
+          vertexCapacity{vertexCapacity},
+          indexCapacity{indexCapacity},
+          maxDrawsPerFrame{maxDrawsPerFrame} {
+        lveDevice.createBuffer(
+            sizeof(LveModel::Vertex) * vertexCapacity,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            vertexBuffer,
+            vertexBufferMemory
+        );
+        lveDevice.createBuffer(
+            sizeof(uint32_t) * indexCapacity,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            indexBuffer,
+            indexBufferMemory
+        );
+
+        indirectBuffers.resize(frameCount);
+        for (auto &indirect : indirectBuffers) {
+            lveDevice.createBuffer(
+                sizeof(VkDrawIndexedIndirectCommand) * maxDrawsPerFrame,
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                indirect.buffer,
+                indirect.memory
+            );
+            void *data;
+            vkMapMemory(lveDevice.device(), indirect.memory, 0, VK_WHOLE_SIZE, 0, &data);
+            indirect.mapped = static_cast<VkDrawIndexedIndirectCommand *>(data);
+        }
+    }
+
+    LveMeshPool::~LveMeshPool() {
+        for (auto &indirect : indirectBuffers) {
+            vkUnmapMemory(lveDevice.device(), indirect.memory);
+            vkDestroyBuffer(lveDevice.device(), indirect.buffer, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), indirect.memory, lveDevice.getAllocator());
+        }
+        vkDestroyBuffer(lveDevice.device(), indexBuffer, lveDevice.getAllocator());
+        vkFreeMemory(lveDevice.device(), indexBufferMemory, lveDevice.getAllocator());
+        vkDestroyBuffer(lveDevice.device(), vertexBuffer, lveDevice.getAllocator());
+        vkFreeMemory(lveDevice.device(), vertexBufferMemory, lveDevice.getAllocator());
+    }
+
+    uint32_t LveMeshPool::addMesh(const std::vector<LveModel::Vertex> &vertices, const std::vector<uint32_t> &indices) {
+        const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+        const uint32_t indexCount = indices.empty() ? vertexCount : static_cast<uint32_t>(indices.size());
+        const uint32_t firstVertex = uploadedVertices + static_cast<uint32_t>(pendingVertices.size());
+        const uint32_t firstIndex = uploadedIndices + static_cast<uint32_t>(pendingIndices.size());
+
+        if (firstVertex + vertexCount > vertexCapacity || firstIndex + indexCount > indexCapacity) {
+            throw std::runtime_error("mesh pool is full");
+        }
+
+        pendingVertices.insert(pendingVertices.end(), vertices.begin(), vertices.end());
+        if (indices.empty()) {
+            for (uint32_t i = 0; i < vertexCount; i++) {
+                pendingIndices.push_back(i);
+            }
+        } else {
+            pendingIndices.insert(pendingIndices.end(), indices.begin(), indices.end());
+        }
+
+        meshes.push_back({firstIndex, indexCount, static_cast<int32_t>(firstVertex), vertexCount});
+        return static_cast<uint32_t>(meshes.size() - 1);
+    }
+
+    void LveMeshPool::upload() {
+        if (pendingVertices.empty()) {
+            return;
+        }
+
+        const VkDeviceSize vertexBytes = sizeof(LveModel::Vertex) * pendingVertices.size();
+        const VkDeviceSize indexBytes = sizeof(uint32_t) * pendingIndices.size();
+
+        // One staging buffer and one submission for vertices and indices together
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        lveDevice.createBuffer(
+            vertexBytes + indexBytes,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer,
+            stagingBufferMemory
+        );
+
+        void *data;
+        vkMapMemory(lveDevice.device(), stagingBufferMemory, 0, vertexBytes + indexBytes, 0, &data);
+        memcpy(data, pendingVertices.data(), static_cast<size_t>(vertexBytes));
+        memcpy(static_cast<char *>(data) + vertexBytes, pendingIndices.data(), static_cast<size_t>(indexBytes));
+        vkUnmapMemory(lveDevice.device(), stagingBufferMemory);
+
+        VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
+        VkBufferCopy vertexCopy{};
+        vertexCopy.srcOffset = 0;
+        vertexCopy.dstOffset = sizeof(LveModel::Vertex) * uploadedVertices;
+        vertexCopy.size = vertexBytes;
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, vertexBuffer, 1, &vertexCopy);
+
+        VkBufferCopy indexCopy{};
+        indexCopy.srcOffset = vertexBytes;
+        indexCopy.dstOffset = sizeof(uint32_t) * uploadedIndices;
+        indexCopy.size = indexBytes;
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, indexBuffer, 1, &indexCopy);
+        lveDevice.endSingleTimeCommands(commandBuffer);
+
+        vkDestroyBuffer(lveDevice.device(), stagingBuffer, lveDevice.getAllocator());
+        vkFreeMemory(lveDevice.device(), stagingBufferMemory, lveDevice.getAllocator());
+
+        uploadedVertices += static_cast<uint32_t>(pendingVertices.size());
+        uploadedIndices += static_cast<uint32_t>(pendingIndices.size());
+        pendingVertices.clear();
+        pendingIndices.clear();
+    }
+
+    void LveMeshPool::bind(VkCommandBuffer commandBuffer) {
+        VkBuffer buffers[] = {vertexBuffer};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    void LveMeshPool::draw(VkCommandBuffer commandBuffer, const DrawItem &item) {
+        const MeshRange &mesh = meshes[item.meshId];
+        vkCmdDrawIndexed(
+            commandBuffer,
+            mesh.indexCount,
+            item.instanceCount,
+            mesh.firstIndex,
+            mesh.vertexOffset,
+            item.firstInstance);
+    }
+
+    void LveMeshPool::drawBatch(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::vector<DrawItem> &items) {
+        bool useIndirect = lveDevice.supportsMultiDrawIndirect() && items.size() <= maxDrawsPerFrame;
+        if (useIndirect && !lveDevice.supportsDrawIndirectFirstInstance()) {
+            for (const auto &item : items) {
+                if (item.firstInstance != 0) {
+                    useIndirect = false;
+                    break;
+                }
+            }
+        }
+
+        if (!useIndirect) {
+            for (const auto &item : items) {
+                draw(commandBuffer, item);
+            }
+            return;
+        }
+
+        auto &indirect = indirectBuffers[frameIndex];
+        for (size_t i = 0; i < items.size(); i++) {
+            const MeshRange &mesh = meshes[items[i].meshId];
+            indirect.mapped[i].indexCount = mesh.indexCount;
+            indirect.mapped[i].instanceCount = items[i].instanceCount;
+            indirect.mapped[i].firstIndex = mesh.firstIndex;
+            indirect.mapped[i].vertexOffset = mesh.vertexOffset;
+            indirect.mapped[i].firstInstance = items[i].firstInstance;
+        }
+        vkCmdDrawIndexedIndirect(
+            commandBuffer,
+            indirect.buffer,
+            0,
+            static_cast<uint32_t>(items.size()),
+            sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_model.hpp"
+
+// std
+#include <vector>
+
+namespace lve {
+
+    // Packs many small meshes into one shared vertex buffer and one shared
+    // index buffer. Meshes are addressed through an offset table, so a whole
+    // batch needs a single bind and can be drawn with one multi-draw-indirect.
+    class LveMeshPool {
+        public:
+            struct MeshRange {
+                uint32_t firstIndex;
+                uint32_t indexCount;
+                int32_t vertexOffset;
+                uint32_t vertexCount;
+            };
+
+            struct DrawItem {
+                uint32_t meshId;
+                uint32_t instanceCount = 1;
+                uint32_t firstInstance = 0;
+            };
+
+            LveMeshPool(
+                LveDevice &device,
+                uint32_t vertexCapacity,
+                uint32_t indexCapacity,
+                uint32_t maxDrawsPerFrame,
+                uint32_t frameCount);
+            ~LveMeshPool();
+
+            LveMeshPool(const LveMeshPool &) = delete;
+            LveMeshPool &operator=(const LveMeshPool &) = delete;
+
+            // Queues a mesh for the next upload(); indices are relative to the mesh's
+            // own vertices. An empty index list draws the vertices in order.
+            uint32_t addMesh(const std::vector<LveModel::Vertex> &vertices, const std::vector<uint32_t> &indices = {});
+            // Copies every mesh added since the last upload in a single transfer
+            void upload();
+
+            const MeshRange &getMesh(uint32_t meshId) const { return meshes[meshId]; }
+            uint32_t getMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+
+            void bind(VkCommandBuffer commandBuffer);
+            void draw(VkCommandBuffer commandBuffer, const DrawItem &item);
+            // Draws a batch with one vkCmdDrawIndexedIndirect when the device allows it
+            void drawBatch(VkCommandBuffer commandBuffer, uint32_t frameIndex, const std::vector<DrawItem> &items);
+
+        private:
+            struct IndirectBuffer {
+                VkBuffer buffer;
+                VkDeviceMemory memory;
+                VkDrawIndexedIndirectCommand *mapped;
+            };
+
+            LveDevice &lveDevice;
+            uint32_t vertexCapacity;
+            uint32_t indexCapacity;
+            uint32_t maxDrawsPerFrame;
+
+            VkBuffer vertexBuffer;
+            VkDeviceMemory vertexBufferMemory;
+            VkBuffer indexBuffer;
+            VkDeviceMemory indexBufferMemory;
+            std::vector<IndirectBuffer> indirectBuffers;
+
+            std::vector<MeshRange> meshes;
+            std::vector<LveModel::Vertex> pendingVertices;
+            std::vector<uint32_t> pendingIndices;
+            uint32_t uploadedVertices = 0;
+            uint32_t uploadedIndices = 0;
+    };
+}
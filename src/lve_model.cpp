@@ -1,8 +1,10 @@
 #include "lve_model.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <stdexcept>
 #define _USE_MATH_DEFINES
 #include<cmath>
 
@@ -11,9 +13,60 @@ namespace lve {
         createVertexBuffer(vertices);
     }
 
+    LveModel::LveModel(
+        LveDevice &device,
+        const std::vector<Vertex> &vertices,
+        const std::vector<uint32_t> &indices,
+        VkPrimitiveTopology topology)
+        : lveDevice{device}, topology{topology} {
+        createVertexBuffer(vertices);
+        createIndexBuffer(indices);
+    }
+
+    LveModel::LveModel(LveDevice &device, uint32_t vertexCapacity, uint32_t bufferCount)
+        : lveDevice{device}, vertexCount{0}, vertexCapacity{vertexCapacity} {
+        assert(vertexCapacity >= 3 && "Vertex capacity must be at least 3");
+        assert(bufferCount > 0 && "Dynamic model needs at least one buffer");
+        shadowVertices.resize(vertexCapacity, Vertex{{0.0f, 0.0f}});
+
+        VkDeviceSize bufferSize = sizeof(Vertex) * vertexCapacity;
+        dynamicBuffers.resize(bufferCount);
+        for (auto &dynamicBuffer : dynamicBuffers) {
+            lveDevice.createBuffer(
+                bufferSize,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                dynamicBuffer.buffer,
+                dynamicBuffer.memory
+            );
+            void *data;
+            vkMapMemory(lveDevice.device(), dynamicBuffer.memory, 0, bufferSize, 0, &data);
+            dynamicBuffer.mapped = static_cast<Vertex *>(data);
+            memcpy(dynamicBuffer.mapped, shadowVertices.data(), static_cast<size_t>(bufferSize));
+        }
+    }
+
+    LveModel::LveModel(LveDevice &device, Procedural procedural)
+        : lveDevice{device}, proceduralDepth{procedural.depth} {
+        assert(procedural.depth <= MAX_PROCEDURAL_DEPTH && "Procedural depth too large");
+        vertexCount = 3;
+        for (uint32_t level = 0; level < procedural.depth; level++) {
+            vertexCount *= 3;
+        }
+    }
+
     LveModel::~LveModel() {
-        vkDestroyBuffer(lveDevice.device(), vertexBuffer, nullptr);
-        vkFreeMemory(lveDevice.device(), vertexBufferMemory, nullptr);
+        // Frames still in flight may reference the buffers, so release them once those frames complete
+        if (vertexBuffer != VK_NULL_HANDLE) {
+            lveDevice.deferDestroyBuffer(vertexBuffer, vertexBufferMemory);
+        }
+        if (indexBuffer != VK_NULL_HANDLE) {
+            lveDevice.deferDestroyBuffer(indexBuffer, indexBufferMemory);
+        }
+        for (auto &dynamicBuffer : dynamicBuffers) {
+            vkUnmapMemory(lveDevice.device(), dynamicBuffer.memory);
+            lveDevice.deferDestroyBuffer(dynamicBuffer.buffer, dynamicBuffer.memory);
+        }
     }
 
     void LveModel::createVertexBuffer(const std::vector<Vertex> &vertices) {
@@ -35,14 +88,118 @@ namespace lve {
         vkUnmapMemory(lveDevice.device(), vertexBufferMemory);
     }
 
+    void LveModel::createIndexBuffer(const std::vector<uint32_t> &indices) {
+        indexCount = static_cast<uint32_t>(indices.size());
+        assert(indexCount >= 3 && "Index Count must be at least 3");
+
+        const bool restartable = topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP ||
+                                 topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN ||
+                                 topology == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+        const bool hasRestart = std::find(indices.begin(), indices.end(), PRIMITIVE_RESTART_INDEX) != indices.end();
+        // Vulkan 1.0 only allows restart for strips and fans
+        if (hasRestart && !restartable) {
+            throw std::runtime_error("primitive restart index in a list topology");
+        }
+        primitiveRestart = hasRestart;
+
+        // 0xFFFF is the 16-bit restart index, so it cannot address a vertex either way
+        std::vector<uint16_t> shortIndices;
+        const void *source = indices.data();
+        VkDeviceSize bufferSize = sizeof(uint32_t) * indexCount;
+        if (vertexCount < 0xFFFF) {
+            indexType = VK_INDEX_TYPE_UINT16;
+            shortIndices.resize(indexCount);
+            for (uint32_t i = 0; i < indexCount; i++) {
+                shortIndices[i] = indices[i] == PRIMITIVE_RESTART_INDEX ? 0xFFFF : static_cast<uint16_t>(indices[i]);
+            }
+            source = shortIndices.data();
+            bufferSize = sizeof(uint16_t) * indexCount;
+        }
+
+        lveDevice.createBuffer(
+            bufferSize,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            indexBuffer,
+            indexBufferMemory
+        );
+
+        void *data;
+        vkMapMemory(lveDevice.device(), indexBufferMemory, 0, bufferSize, 0, &data);
+        memcpy(data, source, static_cast<size_t>(bufferSize));
+        vkUnmapMemory(lveDevice.device(), indexBufferMemory);
+    }
+
+    void LveModel::writeVertices(uint32_t firstVertex, const Vertex *vertices, uint32_t count) {
+        assert(!dynamicBuffers.empty() && "writeVertices requires a dynamic model");
+        assert(firstVertex + count <= vertexCapacity && "Vertex span out of range");
+        if (count == 0) {
+            return;
+        }
+        memcpy(&shadowVertices[firstVertex], vertices, sizeof(Vertex) * count);
+        for (auto &dynamicBuffer : dynamicBuffers) {
+            dynamicBuffer.pendingSpans.push_back({firstVertex, count});
+        }
+    }
+
+    void LveModel::setVertexCount(uint32_t count) {
+        assert(count <= vertexCapacity && "Vertex count exceeds capacity");
+        vertexCount = count;
+    }
+
+    VkDeviceSize LveModel::flush(uint32_t bufferIndex) {
+        auto &dynamicBuffer = dynamicBuffers[bufferIndex];
+        auto &spans = dynamicBuffer.pendingSpans;
+        if (spans.empty()) {
+            return 0;
+        }
+
+        // Coalesce overlapping and adjacent spans so each byte is copied once
+        std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) { return a.first < b.first; });
+        VkDeviceSize bytesCopied = 0;
+        Span current = spans[0];
+        auto copySpan = [&](const Span &span) {
+            memcpy(&dynamicBuffer.mapped[span.first], &shadowVertices[span.first], sizeof(Vertex) * span.count);
+            bytesCopied += sizeof(Vertex) * span.count;
+        };
+        for (size_t i = 1; i < spans.size(); i++) {
+            if (spans[i].first <= current.first + current.count) {
+                uint32_t end = std::max(current.first + current.count, spans[i].first + spans[i].count);
+                current.count = end - current.first;
+            } else {
+                copySpan(current);
+                current = spans[i];
+            }
+        }
+        copySpan(current);
+        spans.clear();
+        return bytesCopied;
+    }
+
+    void LveModel::bind(VkCommandBuffer commandBuffer, uint32_t bufferIndex) {
+        VkBuffer buffers[] = {dynamicBuffers[bufferIndex].buffer};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    }
+
     void LveModel::draw(VkCommandBuffer commandBuffer) {
+        if (indexBuffer != VK_NULL_HANDLE) {
+            vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+            return;
+        }
         vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
     }
 
     void LveModel::bind(VkCommandBuffer commandBuffer) {
+        if (isProcedural()) {
+            return;
+        }
         VkBuffer buffers[] = {vertexBuffer};
         VkDeviceSize offsets[] = {0};
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+        if (indexBuffer != VK_NULL_HANDLE) {
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+        }
     }
 
     std::vector<VkVertexInputBindingDescription> LveModel::Vertex::getBindingDescriptions() {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lve_device.hpp"
+#include "lve_stripifier.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -8,6 +9,7 @@
 #include <glm/glm.hpp>
 
 // std
+#include <optional>
 #include <vector>
 
 namespace lve {
@@ -22,7 +24,25 @@ namespace lve {
                 static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
             };
 
+            // Procedural Sierpinski model drawn by sierpinski.vert from gl_VertexIndex alone
+            struct Procedural {
+                uint32_t depth;
+            };
+            // 3 * 3^depth vertices must stay within a signed gl_VertexIndex
+            static constexpr uint32_t MAX_PROCEDURAL_DEPTH = 18;
+
             LveModel(LveDevice &device, const std::vector<Vertex> &vertices);
+            // Indexed model. Strip and fan indices may separate primitives with
+            // PRIMITIVE_RESTART_INDEX. Indices are stored as 16-bit when every vertex fits.
+            LveModel(
+                LveDevice &device,
+                const std::vector<Vertex> &vertices,
+                const std::vector<uint32_t> &indices,
+                VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+            // Dynamic model: one host-visible copy per frame in flight, updated by span
+            LveModel(LveDevice &device, uint32_t vertexCapacity, uint32_t bufferCount);
+            // Procedural model: no vertex memory, draw only records the vertex count
+            LveModel(LveDevice &device, Procedural procedural);
             ~LveModel();
 
             LveModel(const LveModel &) = delete;
@@ -30,15 +50,55 @@ namespace lve {
 
             void bind(VkCommandBuffer commandBuffer);
             void draw(VkCommandBuffer commandBuffer);
+            uint32_t getVertexCount() const { return vertexCount; }
+            uint32_t getIndexCount() const { return indexCount; }
+            VkIndexType getIndexType() const { return indexType; }
+            // Pipelines drawing this model should follow these, see PipelineConfigInfo::setTopology
+            VkPrimitiveTopology getTopology() const { return topology; }
+            bool usesPrimitiveRestart() const { return primitiveRestart; }
+            bool isProcedural() const { return proceduralDepth.has_value(); }
+            uint32_t getProceduralDepth() const { return proceduralDepth.value_or(0); }
+
+            // Dynamic model API
+            void writeVertices(uint32_t firstVertex, const Vertex *vertices, uint32_t count);
+            void setVertexCount(uint32_t count);
+            // Applies the spans written since this copy was last flushed, returns bytes copied
+            VkDeviceSize flush(uint32_t bufferIndex);
+            void bind(VkCommandBuffer commandBuffer, uint32_t bufferIndex);
 
         private:
+            struct Span {
+                uint32_t first;
+                uint32_t count;
+            };
+
+            struct DynamicBuffer {
+                VkBuffer buffer;
+                VkDeviceMemory memory;
+                Vertex *mapped;
+                std::vector<Span> pendingSpans;
+            };
+
             void createVertexBuffer(const std::vector<Vertex> &vertices);
+            void createIndexBuffer(const std::vector<uint32_t> &indices);
 
             LveDevice& lveDevice;
-            VkBuffer vertexBuffer;
-            VkDeviceMemory vertexBufferMemory;
+            VkBuffer vertexBuffer = VK_NULL_HANDLE;
+            VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
             uint32_t vertexCount;
+            std::optional<uint32_t> proceduralDepth;
+
+            VkBuffer indexBuffer = VK_NULL_HANDLE;
+            VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+            uint32_t indexCount = 0;
+            VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+            VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            bool primitiveRestart = false;
+
+            uint32_t vertexCapacity = 0;
+            std::vector<Vertex> shadowVertices;
+            std::vector<DynamicBuffer> dynamicBuffers;
     };
     
   
-}
\ No newline at end of file
+}
@@ -13,13 +13,20 @@ namespace lve {
                 const std::string& vertFilePath,
                 const std::string& fragFilePath,
                 const PipelineConfigInfo& configInfo) : lveDevice{device} {
-        createGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
+        createGraphicsPipeline(readFile(vertFilePath), readFile(fragFilePath), configInfo);
     } 
 
+    LvePipeline::LvePipeline(LveDevice& device,
+                const std::vector<char>& vertCode,
+                const std::vector<char>& fragCode,
+                const PipelineConfigInfo& configInfo) : lveDevice{device} {
+        createGraphicsPipeline(vertCode, fragCode, configInfo);
+    }
+
     LvePipeline::~LvePipeline() {
-        vkDestroyShaderModule(lveDevice.device(), vertShaderModule, nullptr);
-        vkDestroyShaderModule(lveDevice.device(), fragShaderModule, nullptr);
-        vkDestroyPipeline(lveDevice.device(), graphicsPipeline, nullptr);
+        vkDestroyShaderModule(lveDevice.device(), vertShaderModule, lveDevice.getAllocator());
+        vkDestroyShaderModule(lveDevice.device(), fragShaderModule, lveDevice.getAllocator());
+        vkDestroyPipeline(lveDevice.device(), graphicsPipeline, lveDevice.getAllocator());
     }
 
     std::vector<char> LvePipeline::readFile(const std::string& filePath) {
@@ -29,7 +36,7 @@ namespace lve {
         };
 
         if (!file.is_open()) {
-            std::runtime_error("failed to open file: " + filePath);
+            throw std::runtime_error("failed to open file: " + filePath);
         }
 
         size_t fileSize = static_cast<size_t>(file.tellg());
@@ -43,16 +50,13 @@ namespace lve {
     }
 
     void LvePipeline::createGraphicsPipeline(
-                const std::string& vertFilePath,
-                const std::string& fragFilePath,
+                const std::vector<char>& vertCode,
+                const std::vector<char>& fragCode,
                 const PipelineConfigInfo& configInfo) {
         assert(configInfo.pipelineLayout != VK_NULL_HANDLE 
             && "Cannot create graphics pipeline: no pipelineLayout provided in configInfo");
-        assert(configInfo.renderPass != VK_NULL_HANDLE 
-            && "Cannot create graphics pipeline: no renderPass provided in configInfo");
-
-        auto vertCode = readFile(vertFilePath);
-        auto fragCode = readFile(fragFilePath);
+        assert((configInfo.renderPass != VK_NULL_HANDLE || configInfo.colorAttachmentFormat != VK_FORMAT_UNDEFINED)
+            && "Cannot create graphics pipeline: no renderPass or attachment formats provided in configInfo");
 
         createShaderModule(vertCode, &vertShaderModule);
         createShaderModule(fragCode, &fragShaderModule);
@@ -74,8 +78,8 @@ namespace lve {
         shaderStages[1].pNext = nullptr;
         shaderStages[1].pSpecializationInfo = nullptr;
 
-        auto bindingDescriptions = LveModel::Vertex::getBindingDescriptions();
-        auto attributeDescriptions = LveModel::Vertex::getAttributeDescriptions();
+        auto& bindingDescriptions = configInfo.bindingDescriptions;
+        auto& attributeDescriptions = configInfo.attributeDescriptions;
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -91,8 +95,26 @@ namespace lve {
         viewportInfo.scissorCount = 1;
         viewportInfo.pScissors = &configInfo.scissor;
 
+        // configInfo may have been copied since defaultPipelineConfigInfo pointed this at its own member
+        VkPipelineColorBlendStateCreateInfo colorBlendInfo = configInfo.colorBlendInfo;
+        colorBlendInfo.pAttachments = &configInfo.colorBlendAttachment;
+
+        VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
+        dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
+        dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
+
+        // Without a render pass the attachment formats are given directly
+        VkPipelineRenderingCreateInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachmentFormats = &configInfo.colorAttachmentFormat;
+        renderingInfo.depthAttachmentFormat = configInfo.depthAttachmentFormat;
+        renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = configInfo.renderPass == VK_NULL_HANDLE ? &renderingInfo : nullptr;
         pipelineInfo.stageCount = 2;
         pipelineInfo.pStages = shaderStages;
         pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -100,9 +122,9 @@ namespace lve {
         pipelineInfo.pViewportState = &viewportInfo;
         pipelineInfo.pRasterizationState = &configInfo.rasterizationInfo;
         pipelineInfo.pMultisampleState = &configInfo.multisampleInfo;
-        pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
+        pipelineInfo.pColorBlendState = &colorBlendInfo;
         pipelineInfo.pDepthStencilState = &configInfo.depthStencilInfo;
-        pipelineInfo.pDynamicState = nullptr;
+        pipelineInfo.pDynamicState = configInfo.dynamicStateEnables.empty() ? nullptr : &dynamicStateInfo;
 
         pipelineInfo.layout = configInfo.pipelineLayout;
         pipelineInfo.renderPass = configInfo.renderPass;
@@ -111,7 +133,7 @@ namespace lve {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        if (vkCreateGraphicsPipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, lveDevice.getAllocator(), &graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create graphics pipeline");
         }
     }
@@ -122,7 +144,7 @@ namespace lve {
         createInfo.codeSize = code.size();
         createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-        if (vkCreateShaderModule(lveDevice.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
+        if (vkCreateShaderModule(lveDevice.device(), &createInfo, lveDevice.getAllocator(), shaderModule) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create shader module");
         }
     }
@@ -130,6 +152,10 @@ namespace lve {
     PipelineConfigInfo LvePipeline::defaultPipelineConfigInfo(uint32_t width, uint32_t height) {
         PipelineConfigInfo configInfo{};
 
+        // Vertex Input
+        configInfo.bindingDescriptions = LveModel::Vertex::getBindingDescriptions();
+        configInfo.attributeDescriptions = LveModel::Vertex::getAttributeDescriptions();
+
         // Input Assembly
         configInfo.inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
         configInfo.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
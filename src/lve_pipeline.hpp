@@ -7,7 +7,17 @@
 
 namespace lve {
 
+    // What a graphics pipeline renders into: a render pass, or for dynamic rendering a null
+    // render pass and the attachment formats
+    struct RenderTargetInfo {
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+        VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    };
+
     struct PipelineConfigInfo {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
         VkViewport viewport;
         VkRect2D scissor;
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
@@ -17,8 +27,24 @@ namespace lve {
         VkPipelineColorBlendStateCreateInfo colorBlendInfo;
         VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
         VkPipelineLayout pipelineLayout = nullptr;
+        std::vector<VkDynamicState> dynamicStateEnables{};
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
+        // Dynamic rendering, used when renderPass is null
+        VkFormat colorAttachmentFormat = VK_FORMAT_UNDEFINED;
+        VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+        void setRenderTarget(const RenderTargetInfo &target) {
+            renderPass = target.renderPass;
+            colorAttachmentFormat = target.colorFormat;
+            depthAttachmentFormat = target.depthFormat;
+        }
+
+        // e.g. setTopology(model.getTopology(), model.usesPrimitiveRestart())
+        void setTopology(VkPrimitiveTopology topology, bool primitiveRestart = false) {
+            inputAssemblyInfo.topology = topology;
+            inputAssemblyInfo.primitiveRestartEnable = primitiveRestart ? VK_TRUE : VK_FALSE;
+        }
     };
 
     class LvePipeline {
@@ -28,6 +54,13 @@ namespace lve {
                 const std::string& vertFilePath,
                 const std::string& fragFilePath,
                 const PipelineConfigInfo& configInfo); 
+
+            // Builds from SPIR-V already read into memory, e.g. loaded on a startup worker
+            LvePipeline(
+                LveDevice& device,
+                const std::vector<char>& vertCode,
+                const std::vector<char>& fragCode,
+                const PipelineConfigInfo& configInfo);
         
             ~LvePipeline();
 
@@ -36,12 +69,12 @@ namespace lve {
 
             void bind(VkCommandBuffer commandBuffer);
             static PipelineConfigInfo defaultPipelineConfigInfo(uint32_t width, uint32_t height);
+            static std::vector<char> readFile(const std::string& filePath);
 
         private:
-            static std::vector<char> readFile(const std::string& filePath);
             void createGraphicsPipeline(
-                const std::string& vertFilePath,
-                const std::string& fragFilePath,
+                const std::vector<char>& vertCode,
+                const std::vector<char>& fragCode,
                 const PipelineConfigInfo& configInfo);
 
             void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
@@ -0,0 +1,139 @@
+#include "lve_png_writer.hpp"
+
+// libs
+#include <zlib.h>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace lve {
+
+    // IDAT chunks are split at this size; any split is valid
+    static constexpr size_t MAX_CHUNK_SIZE = 1 << 20;
+
+    static void putUint32(uint8_t *out, uint32_t value) {
+        out[0] = static_cast<uint8_t>(value >> 24);
+        out[1] = static_cast<uint8_t>(value >> 16);
+        out[2] = static_cast<uint8_t>(value >> 8);
+        out[3] = static_cast<uint8_t>(value);
+    }
+
+    LvePngWriter::LvePngWriter(const std::string &path, uint32_t width, uint32_t height)
+        : file{path, std::ios::binary}, path{path}, width{width}, height{height} {
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open " + path);
+        }
+        if (width == 0 || height == 0 || width > 0x7fffffff || height > 0x7fffffff) {
+            throw std::runtime_error("invalid PNG size for " + path);
+        }
+
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        file.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+        bytesWritten += sizeof(signature);
+
+        uint8_t header[13];
+        putUint32(header, width);
+        putUint32(header + 4, height);
+        header[8] = 8;   // bit depth
+        header[9] = 2;   // truecolour
+        header[10] = 0;  // deflate
+        header[11] = 0;  // adaptive filtering
+        header[12] = 0;  // no interlace
+        writeChunk("IHDR", header, sizeof(header));
+
+        // zlib header: deflate with a 32K window, fastest-compression hint
+        static const uint8_t zlibHeader[2] = {0x78, 0x01};
+        writeChunk("IDAT", zlibHeader, sizeof(zlibHeader));
+    }
+
+    LvePngWriter::CompressedBand LvePngWriter::compressBand(
+        const uint8_t *rgb, uint32_t width, uint32_t rowCount, bool last, int level) {
+        CompressedBand band{};
+        band.rowCount = rowCount;
+        band.adler = 1;
+
+        z_stream stream{};
+        // Raw deflate so bands can be concatenated into one zlib stream
+        if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("failed to initialise deflate");
+        }
+
+        const size_t rowBytes = size_t{width} * 3;
+        std::vector<uint8_t> filtered(rowBytes + 1);
+        band.data.resize(deflateBound(&stream, static_cast<uLong>((rowBytes + 1) * rowCount)) + 16);
+        stream.next_out = band.data.data();
+        stream.avail_out = static_cast<uInt>(band.data.size());
+
+        for (uint32_t row = 0; row < rowCount; row++) {
+            // Sub filter: each byte minus the same channel of the pixel to its left
+            const uint8_t *src = rgb + row * rowBytes;
+            filtered[0] = 1;
+            std::copy(src, src + std::min<size_t>(3, rowBytes), filtered.begin() + 1);
+            for (size_t i = 3; i < rowBytes; i++) {
+                filtered[1 + i] = static_cast<uint8_t>(src[i] - src[i - 3]);
+            }
+            band.adler = static_cast<uint32_t>(adler32(band.adler, filtered.data(), static_cast<uInt>(filtered.size())));
+            band.filteredSize += filtered.size();
+
+            stream.next_in = filtered.data();
+            stream.avail_in = static_cast<uInt>(filtered.size());
+            const bool lastRow = row + 1 == rowCount;
+            // A full flush ends the band on a byte boundary without marking the stream final
+            int flush = !lastRow ? Z_NO_FLUSH : last ? Z_FINISH : Z_FULL_FLUSH;
+            int result = deflate(&stream, flush);
+            if (result == Z_STREAM_ERROR || stream.avail_in != 0 || (flush == Z_FINISH && result != Z_STREAM_END)) {
+                deflateEnd(&stream);
+                throw std::runtime_error("deflate failed");
+            }
+        }
+        band.data.resize(band.data.size() - stream.avail_out);
+        deflateEnd(&stream);
+        return band;
+    }
+
+    void LvePngWriter::writeBand(const CompressedBand &band) {
+        if (rowsWritten + band.rowCount > height) {
+            throw std::runtime_error("too many rows written to " + path);
+        }
+        for (size_t offset = 0; offset < band.data.size(); offset += MAX_CHUNK_SIZE) {
+            writeChunk("IDAT", band.data.data() + offset, std::min(MAX_CHUNK_SIZE, band.data.size() - offset));
+        }
+        adler = static_cast<uint32_t>(adler32_combine(adler, band.adler, static_cast<z_off_t>(band.filteredSize)));
+        rowsWritten += band.rowCount;
+
+        if (rowsWritten == height) {
+            uint8_t trailer[4];
+            putUint32(trailer, adler);
+            writeChunk("IDAT", trailer, sizeof(trailer));
+            writeChunk("IEND", nullptr, 0);
+            file.close();
+            if (!file) {
+                throw std::runtime_error("failed to write " + path);
+            }
+        }
+    }
+
+    void LvePngWriter::writeChunk(const char *type, const uint8_t *data, size_t size) {
+        uint8_t header[8];
+        putUint32(header, static_cast<uint32_t>(size));
+        std::copy(type, type + 4, header + 4);
+
+        uLong crc = crc32(0, header + 4, 4);
+        if (size > 0) {
+            crc = crc32(crc, data, static_cast<uInt>(size));
+        }
+        uint8_t footer[4];
+        putUint32(footer, static_cast<uint32_t>(crc));
+
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        if (size > 0) {
+            file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+        }
+        file.write(reinterpret_cast<const char *>(footer), sizeof(footer));
+        if (!file) {
+            throw std::runtime_error("failed to write " + path);
+        }
+        bytesWritten += sizeof(header) + size + sizeof(footer);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Writes an 8-bit RGB PNG top to bottom in one pass. The image is cut into bands of rows that
+    // compressBand() deflates independently, so bands can be compressed on several threads at
+    // once; writeBand() then appends them in order. Only the bands in flight are held in memory.
+    class LvePngWriter {
+        public:
+            struct CompressedBand {
+                uint32_t rowCount;
+                // Raw deflate data, ending on a byte boundary unless this is the last band
+                std::vector<uint8_t> data;
+                // Adler-32 of the filtered rows, combined into the zlib trailer
+                uint32_t adler;
+                uint64_t filteredSize;
+            };
+
+            LvePngWriter(const std::string &path, uint32_t width, uint32_t height);
+
+            LvePngWriter(const LvePngWriter &) = delete;
+            LvePngWriter &operator=(const LvePngWriter &) = delete;
+
+            // Thread safe. rgb holds rowCount tightly packed rows; last marks the final band.
+            static CompressedBand compressBand(
+                const uint8_t *rgb, uint32_t width, uint32_t rowCount, bool last, int level = 6);
+
+            // Bands must arrive in order; the file is complete after the last one
+            void writeBand(const CompressedBand &band);
+
+            uint32_t getRowsWritten() const { return rowsWritten; }
+            uint64_t getBytesWritten() const { return bytesWritten; }
+
+        private:
+            void writeChunk(const char *type, const uint8_t *data, size_t size);
+
+            std::ofstream file;
+            std::string path;
+            uint32_t width;
+            uint32_t height;
+            uint32_t rowsWritten = 0;
+            uint32_t adler = 1;
+            uint64_t bytesWritten = 0;
+    };
+}
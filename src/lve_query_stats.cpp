@@ -0,0 +1,175 @@
+#include "lve_query_stats.hpp"
+
+// std
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+
+namespace lve {
+
+    namespace {
+        // Results come back in bit order, so these must stay sorted by bit
+        constexpr VkQueryPipelineStatisticFlags STATISTICS =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+        constexpr uint32_t STATISTICS_COUNT = 4;
+
+        void add(LveQueryStats::FrameStats &sum, const LveQueryStats::FrameStats &frame) {
+            sum.inputAssemblyVertices += frame.inputAssemblyVertices;
+            sum.vertexShaderInvocations += frame.vertexShaderInvocations;
+            sum.clippingPrimitives += frame.clippingPrimitives;
+            sum.fragmentShaderInvocations += frame.fragmentShaderInvocations;
+            sum.samplesPassed += frame.samplesPassed;
+        }
+
+        LveQueryStats::FrameStats average(const LveQueryStats::FrameStats &sum, uint64_t frames) {
+            if (frames == 0) {
+                return {};
+            }
+            LveQueryStats::FrameStats result{};
+            result.inputAssemblyVertices = sum.inputAssemblyVertices / frames;
+            result.vertexShaderInvocations = sum.vertexShaderInvocations / frames;
+            result.clippingPrimitives = sum.clippingPrimitives / frames;
+            result.fragmentShaderInvocations = sum.fragmentShaderInvocations / frames;
+            result.samplesPassed = sum.samplesPassed / frames;
+            return result;
+        }
+    }
+
+    LveQueryStats::LveQueryStats(LveDevice &device, uint32_t slotCount) : lveDevice{device}, pending(slotCount, false) {
+        // Occlusion queries are core; pipeline statistics are an optional feature
+        VkQueryPoolCreateInfo occlusionInfo{};
+        occlusionInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        occlusionInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+        occlusionInfo.queryCount = slotCount;
+        if (vkCreateQueryPool(lveDevice.device(), &occlusionInfo, lveDevice.getAllocator(), &occlusionPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create occlusion query pool");
+        }
+        if (lveDevice.supportsPreciseOcclusion()) {
+            occlusionFlags = VK_QUERY_CONTROL_PRECISE_BIT;
+        }
+
+        if (!lveDevice.supportsPipelineStatistics()) {
+            return;
+        }
+        VkQueryPoolCreateInfo statisticsInfo{};
+        statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsInfo.queryCount = slotCount;
+        statisticsInfo.pipelineStatistics = STATISTICS;
+        if (vkCreateQueryPool(lveDevice.device(), &statisticsInfo, lveDevice.getAllocator(), &statisticsPool) != VK_SUCCESS) {
+            vkDestroyQueryPool(lveDevice.device(), occlusionPool, lveDevice.getAllocator());
+            throw std::runtime_error("Failed to create pipeline statistics query pool");
+        }
+    }
+
+    LveQueryStats::~LveQueryStats() {
+        if (statisticsPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(lveDevice.device(), statisticsPool, lveDevice.getAllocator());
+        }
+        vkDestroyQueryPool(lveDevice.device(), occlusionPool, lveDevice.getAllocator());
+    }
+
+    void LveQueryStats::recordReset(VkCommandBuffer commandBuffer, uint32_t slot) {
+        vkCmdResetQueryPool(commandBuffer, occlusionPool, slot, 1);
+        if (statisticsPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, statisticsPool, slot, 1);
+        }
+    }
+
+    void LveQueryStats::begin(VkCommandBuffer commandBuffer, uint32_t slot) {
+        vkCmdBeginQuery(commandBuffer, occlusionPool, slot, occlusionFlags);
+        if (statisticsPool != VK_NULL_HANDLE) {
+            vkCmdBeginQuery(commandBuffer, statisticsPool, slot, 0);
+        }
+    }
+
+    void LveQueryStats::end(VkCommandBuffer commandBuffer, uint32_t slot) {
+        if (statisticsPool != VK_NULL_HANDLE) {
+            vkCmdEndQuery(commandBuffer, statisticsPool, slot);
+        }
+        vkCmdEndQuery(commandBuffer, occlusionPool, slot);
+        pending[slot] = true;
+    }
+
+    void LveQueryStats::collect(uint32_t slot) {
+        if (!pending[slot]) {
+            return;
+        }
+        pending[slot] = false;
+
+        // No WAIT bit: the fence has signalled, so anything else is a driver hiccup worth counting
+        FrameStats frame{};
+        VkResult result = vkGetQueryPoolResults(
+            lveDevice.device(),
+            occlusionPool,
+            slot,
+            1,
+            sizeof(uint64_t),
+            &frame.samplesPassed,
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT);
+        if (result != VK_SUCCESS) {
+            notReady++;
+            return;
+        }
+        if (statisticsPool != VK_NULL_HANDLE) {
+            std::array<uint64_t, STATISTICS_COUNT> statistics{};
+            result = vkGetQueryPoolResults(
+                lveDevice.device(),
+                statisticsPool,
+                slot,
+                1,
+                sizeof(statistics),
+                statistics.data(),
+                sizeof(statistics),
+                VK_QUERY_RESULT_64_BIT);
+            if (result != VK_SUCCESS) {
+                notReady++;
+                return;
+            }
+            frame.inputAssemblyVertices = statistics[0];
+            frame.vertexShaderInvocations = statistics[1];
+            frame.clippingPrimitives = statistics[2];
+            frame.fragmentShaderInvocations = statistics[3];
+        }
+
+        lastFrame = frame;
+        add(interval, frame);
+        intervalFrames++;
+        add(total, frame);
+        totalFrames++;
+    }
+
+    LveQueryStats::FrameStats LveQueryStats::takeAverage() {
+        FrameStats result = average(interval, intervalFrames);
+        interval = {};
+        intervalFrames = 0;
+        return result;
+    }
+
+    void LveQueryStats::printReport() {
+        FrameStats frame = average(total, totalFrames);
+        std::printf("queries: %llu frames, %llu samples passed per frame",
+            static_cast<unsigned long long>(totalFrames),
+            static_cast<unsigned long long>(frame.samplesPassed));
+        if (hasPipelineStatistics()) {
+            // Fewer shader invocations than vertices fetched means the post-transform cache hit
+            std::printf(", %llu vertices, %llu vertex shader invocations (%.2f per vertex), "
+                        "%llu primitives after clipping, %llu fragment shader invocations",
+                static_cast<unsigned long long>(frame.inputAssemblyVertices),
+                static_cast<unsigned long long>(frame.vertexShaderInvocations),
+                frame.inputAssemblyVertices > 0
+                    ? static_cast<double>(frame.vertexShaderInvocations) / frame.inputAssemblyVertices
+                    : 0.0,
+                static_cast<unsigned long long>(frame.clippingPrimitives),
+                static_cast<unsigned long long>(frame.fragmentShaderInvocations));
+        }
+        if (notReady > 0) {
+            std::printf(", %llu frames not ready", static_cast<unsigned long long>(notReady));
+        }
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+    // Pipeline statistics and an occlusion query around the main pass, one pair per frame slot.
+    // Results are read without waiting once the slot's fence has signalled, so each frame's
+    // counters arrive slotCount frames after it was drawn.
+    class LveQueryStats {
+        public:
+            struct FrameStats {
+                uint64_t inputAssemblyVertices = 0;
+                uint64_t vertexShaderInvocations = 0;
+                uint64_t clippingPrimitives = 0;
+                uint64_t fragmentShaderInvocations = 0;
+                // Samples that passed the depth test; exact only with precise occlusion
+                uint64_t samplesPassed = 0;
+            };
+
+            LveQueryStats(LveDevice &device, uint32_t slotCount);
+            ~LveQueryStats();
+
+            LveQueryStats(const LveQueryStats &) = delete;
+            LveQueryStats &operator=(const LveQueryStats &) = delete;
+
+            bool hasPipelineStatistics() const { return statisticsPool != VK_NULL_HANDLE; }
+
+            // Outside any render pass, before the pass that calls begin()
+            void recordReset(VkCommandBuffer commandBuffer, uint32_t slot);
+            // Inside the pass, around the draws to count
+            void begin(VkCommandBuffer commandBuffer, uint32_t slot);
+            void end(VkCommandBuffer commandBuffer, uint32_t slot);
+            // Call once the slot's fence has signalled: adds the frame it last recorded
+            void collect(uint32_t slot);
+
+            const FrameStats &getLastFrame() const { return lastFrame; }
+            // Per-frame average since the last call, then starts a new interval
+            FrameStats takeAverage();
+            // Per-frame average over every collected frame
+            void printReport();
+
+        private:
+            LveDevice &lveDevice;
+            VkQueryPool statisticsPool = VK_NULL_HANDLE;
+            VkQueryPool occlusionPool = VK_NULL_HANDLE;
+            VkQueryControlFlags occlusionFlags = 0;
+            // Slots whose queries were recorded and not yet collected
+            std::vector<bool> pending;
+
+            FrameStats lastFrame{};
+            FrameStats interval{};
+            uint64_t intervalFrames = 0;
+            FrameStats total{};
+            uint64_t totalFrames = 0;
+            uint64_t notReady = 0;
+    };
+}
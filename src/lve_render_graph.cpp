@@ -0,0 +1,807 @@
+#include "lve_render_graph.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+
+namespace lve {
+
+    static bool isDepthFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static VkImageAspectFlags aspectMask(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return isDepthFormat(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    // PassBuilder
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::writeColor(
+        ResourceId image, std::optional<VkClearColorValue> clear) {
+        Usage usage{};
+        usage.resource = image;
+        usage.type = UsageType::ColorAttachment;
+        usage.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        usage.access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        usage.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        usage.write = true;
+        usage.clear = clear.has_value();
+        if (clear) {
+            usage.clearValue.color = *clear;
+        }
+        graph.addUsage(passId, usage);
+        return *this;
+    }
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::writeDepth(
+        ResourceId image, std::optional<VkClearDepthStencilValue> clear) {
+        Usage usage{};
+        usage.resource = image;
+        usage.type = UsageType::DepthAttachment;
+        usage.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        usage.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        usage.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        usage.write = true;
+        usage.clear = clear.has_value();
+        if (clear) {
+            usage.clearValue.depthStencil = *clear;
+        }
+        graph.addUsage(passId, usage);
+        return *this;
+    }
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::readImage(ResourceId image, VkPipelineStageFlags stages) {
+        Usage usage{};
+        usage.resource = image;
+        usage.type = UsageType::SampledImage;
+        usage.stages = stages;
+        usage.access = VK_ACCESS_SHADER_READ_BIT;
+        usage.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        graph.addUsage(passId, usage);
+        return *this;
+    }
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::copySource(ResourceId image) {
+        Usage usage{};
+        usage.resource = image;
+        usage.type = UsageType::TransferSource;
+        usage.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        usage.access = VK_ACCESS_TRANSFER_READ_BIT;
+        usage.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        graph.addUsage(passId, usage);
+        return *this;
+    }
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::readBuffer(
+        ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+        Usage usage{};
+        usage.resource = buffer;
+        usage.type = UsageType::BufferRead;
+        usage.stages = stages;
+        usage.access = access;
+        graph.addUsage(passId, usage);
+        return *this;
+    }
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::writeBuffer(
+        ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+        Usage usage{};
+        usage.resource = buffer;
+        usage.type = UsageType::BufferWrite;
+        usage.stages = stages;
+        usage.access = access;
+        usage.write = true;
+        graph.addUsage(passId, usage);
+        return *this;
+    }
+
+    LveRenderGraph::PassBuilder &LveRenderGraph::PassBuilder::sideEffect() {
+        graph.passes[passId].sideEffect = true;
+        return *this;
+    }
+
+    // LveRenderGraph
+
+    LveRenderGraph::LveRenderGraph(LveDevice &device, bool dynamicRendering)
+        : lveDevice{device}, dynamicRendering{dynamicRendering} {
+        assert((!dynamicRendering || device.supportsDynamicRendering()) && "Dynamic rendering is not enabled");
+    }
+
+    LveRenderGraph::~LveRenderGraph() {
+        destroyResources();
+    }
+
+    LveRenderGraph::ResourceId LveRenderGraph::createImage(const std::string &name, const ImageDesc &desc) {
+        assert(!compiled && "Resources must be declared before compile");
+        Resource resource{};
+        resource.name = name;
+        resource.image = true;
+        resource.imported = false;
+        resource.desc = desc;
+        resources.push_back(resource);
+        return static_cast<ResourceId>(resources.size() - 1);
+    }
+
+    LveRenderGraph::ResourceId LveRenderGraph::importImage(
+        const std::string &name,
+        const ImageDesc &desc,
+        VkImageLayout initialLayout,
+        VkPipelineStageFlags initialStages,
+        VkImageLayout finalLayout) {
+        assert(!compiled && "Resources must be declared before compile");
+        Resource resource{};
+        resource.name = name;
+        resource.image = true;
+        resource.imported = true;
+        resource.desc = desc;
+        resource.initialLayout = initialLayout;
+        resource.initialStages = initialStages;
+        resource.finalLayout = finalLayout;
+        resources.push_back(resource);
+        return static_cast<ResourceId>(resources.size() - 1);
+    }
+
+    LveRenderGraph::ResourceId LveRenderGraph::importBuffer(const std::string &name) {
+        assert(!compiled && "Resources must be declared before compile");
+        Resource resource{};
+        resource.name = name;
+        resource.image = false;
+        resource.imported = true;
+        resources.push_back(resource);
+        return static_cast<ResourceId>(resources.size() - 1);
+    }
+
+    void LveRenderGraph::setImportedImage(ResourceId image, VkImage handle, VkImageView view) {
+        assert(resources[image].image && resources[image].imported && "Not an imported image");
+        resources[image].imageHandle = handle;
+        resources[image].view = view;
+    }
+
+    void LveRenderGraph::setImportedBuffer(ResourceId buffer, VkBuffer handle) {
+        assert(!resources[buffer].image && "Not an imported buffer");
+        resources[buffer].bufferHandle = handle;
+    }
+
+    LveRenderGraph::PassBuilder LveRenderGraph::addGraphicsPass(
+        const std::string &name, std::function<void(VkCommandBuffer)> record) {
+        return PassBuilder{*this, addPass(name, PassKind::Graphics, std::move(record))};
+    }
+
+    LveRenderGraph::PassBuilder LveRenderGraph::addComputePass(
+        const std::string &name, std::function<void(VkCommandBuffer)> record) {
+        return PassBuilder{*this, addPass(name, PassKind::Compute, std::move(record))};
+    }
+
+    LveRenderGraph::PassBuilder LveRenderGraph::addTransferPass(
+        const std::string &name, std::function<void(VkCommandBuffer)> record) {
+        return PassBuilder{*this, addPass(name, PassKind::Transfer, std::move(record))};
+    }
+
+    const char *LveRenderGraph::kindName(PassKind kind) {
+        switch (kind) {
+            case PassKind::Graphics:
+                return "graphics";
+            case PassKind::Compute:
+                return "compute";
+            case PassKind::Transfer:
+                return "transfer";
+        }
+        return "unknown";
+    }
+
+    LveRenderGraph::PassId LveRenderGraph::addPass(
+        const std::string &name, PassKind kind, std::function<void(VkCommandBuffer)> record) {
+        assert(!compiled && "Passes must be added before compile");
+        Pass pass{};
+        pass.name = name;
+        pass.kind = kind;
+        pass.record = std::move(record);
+        passes.push_back(std::move(pass));
+        return static_cast<PassId>(passes.size() - 1);
+    }
+
+    void LveRenderGraph::addUsage(PassId pass, const Usage &usage) {
+        assert(usage.resource < resources.size() && "Unknown render graph resource");
+        bool attachment = usage.type == UsageType::ColorAttachment || usage.type == UsageType::DepthAttachment;
+        if (attachment && passes[pass].kind != PassKind::Graphics) {
+            throw std::runtime_error(std::string{kindName(passes[pass].kind)} + " pass '" + passes[pass].name +
+                "' cannot write attachments");
+        }
+        passes[pass].usages.push_back(usage);
+    }
+
+    void LveRenderGraph::compile() {
+        if (compiled) {
+            destroyResources();
+        }
+        cullPasses();
+        createTransientImages();
+        resolveAttachments();
+        if (!dynamicRendering) {
+            createRenderPasses();
+        }
+        states.assign(resources.size(), AccessState{});
+        compiled = true;
+    }
+
+    void LveRenderGraph::cullPasses() {
+        // Walk backwards from passes with visible effects: writes to imported resources or
+        // explicit side effects. A pass survives if a surviving later pass needs what it writes.
+        std::vector<bool> needed(resources.size(), false);
+        for (size_t i = passes.size(); i-- > 0;) {
+            Pass &pass = passes[i];
+            pass.live = pass.sideEffect;
+            for (const auto &usage : pass.usages) {
+                if (usage.write && (resources[usage.resource].imported || needed[usage.resource])) {
+                    pass.live = true;
+                }
+            }
+            if (!pass.live) {
+                continue;
+            }
+            for (const auto &usage : pass.usages) {
+                bool attachment = usage.type == UsageType::ColorAttachment || usage.type == UsageType::DepthAttachment;
+                if (!usage.write || (attachment && !usage.clear)) {
+                    // Reads, and attachments that load what was there before
+                    needed[usage.resource] = true;
+                } else if (attachment && usage.clear) {
+                    // A clear overwrites everything earlier passes produced
+                    needed[usage.resource] = false;
+                }
+                // Buffer writes may be partial, so earlier writers stay needed
+            }
+            // A read in the same pass keeps earlier writers alive even if this pass clears
+            for (const auto &usage : pass.usages) {
+                if (!usage.write) {
+                    needed[usage.resource] = true;
+                }
+            }
+        }
+    }
+
+    void LveRenderGraph::createTransientImages() {
+        std::vector<ResourceId> transients;
+        for (ResourceId id = 0; id < resources.size(); id++) {
+            Resource &resource = resources[id];
+            resource.firstPass = UINT32_MAX;
+            resource.lastPass = 0;
+            resource.usage = 0;
+        }
+        for (uint32_t p = 0; p < passes.size(); p++) {
+            if (!passes[p].live) {
+                continue;
+            }
+            for (const auto &usage : passes[p].usages) {
+                Resource &resource = resources[usage.resource];
+                resource.firstPass = std::min(resource.firstPass, p);
+                resource.lastPass = std::max(resource.lastPass, p);
+                switch (usage.type) {
+                    case UsageType::ColorAttachment:
+                        resource.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+                        break;
+                    case UsageType::DepthAttachment:
+                        resource.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+                        break;
+                    case UsageType::SampledImage:
+                        resource.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+                        break;
+                    case UsageType::TransferSource:
+                        resource.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        for (ResourceId id = 0; id < resources.size(); id++) {
+            Resource &resource = resources[id];
+            if (resource.imported || resource.firstPass == UINT32_MAX) {
+                continue;
+            }
+
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = resource.desc.format;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = resource.usage;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            if (vkCreateImage(lveDevice.device(), &imageInfo, lveDevice.getAllocator(), &resource.imageHandle) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create render graph image " + resource.name);
+            }
+            vkGetImageMemoryRequirements(lveDevice.device(), resource.imageHandle, &resource.requirements);
+            transients.push_back(id);
+        }
+
+        // Largest first, each into the first block whose members are never alive at the same time
+        std::sort(transients.begin(), transients.end(), [&](ResourceId a, ResourceId b) {
+            return resources[a].requirements.size > resources[b].requirements.size;
+        });
+        for (ResourceId id : transients) {
+            Resource &resource = resources[id];
+            for (uint32_t b = 0; b < blocks.size() && resource.block == UINT32_MAX; b++) {
+                MemoryBlock &block = blocks[b];
+                if ((block.memoryTypeBits & resource.requirements.memoryTypeBits) == 0) {
+                    continue;
+                }
+                bool overlaps = std::any_of(block.members.begin(), block.members.end(), [&](ResourceId other) {
+                    return resources[other].firstPass <= resource.lastPass &&
+                           resource.firstPass <= resources[other].lastPass;
+                });
+                if (!overlaps) {
+                    resource.block = b;
+                }
+            }
+            if (resource.block == UINT32_MAX) {
+                resource.block = static_cast<uint32_t>(blocks.size());
+                blocks.emplace_back();
+            }
+            MemoryBlock &block = blocks[resource.block];
+            block.members.push_back(id);
+            block.memoryTypeBits &= resource.requirements.memoryTypeBits;
+            // Every member is bound at offset 0, so the block only needs the largest size
+            block.size = std::max(block.size, resource.requirements.size);
+        }
+
+        for (auto &block : blocks) {
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = block.size;
+            allocInfo.memoryTypeIndex =
+                lveDevice.findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            if (vkAllocateMemory(lveDevice.device(), &allocInfo, lveDevice.getAllocator(), &block.memory) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate render graph memory");
+            }
+            for (ResourceId id : block.members) {
+                Resource &resource = resources[id];
+                if (vkBindImageMemory(lveDevice.device(), resource.imageHandle, block.memory, 0) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to bind render graph image memory");
+                }
+
+                VkImageViewCreateInfo viewInfo{};
+                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                viewInfo.image = resource.imageHandle;
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = resource.desc.format;
+                viewInfo.subresourceRange.aspectMask = aspectMask(resource.desc.format);
+                viewInfo.subresourceRange.baseMipLevel = 0;
+                viewInfo.subresourceRange.levelCount = 1;
+                viewInfo.subresourceRange.baseArrayLayer = 0;
+                viewInfo.subresourceRange.layerCount = 1;
+
+                if (vkCreateImageView(lveDevice.device(), &viewInfo, lveDevice.getAllocator(), &resource.view) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create render graph image view " + resource.name);
+                }
+            }
+        }
+    }
+
+    void LveRenderGraph::resolveAttachments() {
+        for (uint32_t p = 0; p < passes.size(); p++) {
+            Pass &pass = passes[p];
+            pass.attachments.clear();
+            pass.clearValues.clear();
+            if (!pass.live || pass.kind != PassKind::Graphics) {
+                continue;
+            }
+
+            std::vector<const Usage *> attachmentUsages;
+            for (const auto &usage : pass.usages) {
+                if (usage.type == UsageType::ColorAttachment) {
+                    attachmentUsages.push_back(&usage);
+                }
+            }
+            for (const auto &usage : pass.usages) {
+                if (usage.type == UsageType::DepthAttachment) {
+                    attachmentUsages.push_back(&usage);
+                    break;
+                }
+            }
+            if (attachmentUsages.empty()) {
+                throw std::runtime_error("graphics pass '" + pass.name + "' has no attachments");
+            }
+            pass.extent = resources[attachmentUsages[0]->resource].desc.extent;
+
+            for (const Usage *usage : attachmentUsages) {
+                const Resource &resource = resources[usage->resource];
+
+                // Earlier contents matter if a live pass wrote them or they were imported
+                bool hasContents = resource.imported && resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+                bool usedLater = resource.imported;
+                for (uint32_t other = 0; other < passes.size(); other++) {
+                    if (!passes[other].live || other == p) {
+                        continue;
+                    }
+                    for (const auto &otherUsage : passes[other].usages) {
+                        if (otherUsage.resource != usage->resource) {
+                            continue;
+                        }
+                        hasContents |= other < p && otherUsage.write;
+                        usedLater |= other > p;
+                    }
+                }
+
+                Attachment attachment{};
+                attachment.resource = usage->resource;
+                attachment.usage = usage;
+                attachment.loadOp = usage->clear ? VK_ATTACHMENT_LOAD_OP_CLEAR
+                                  : hasContents  ? VK_ATTACHMENT_LOAD_OP_LOAD
+                                                 : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                attachment.storeOp = usedLater ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                pass.attachments.push_back(attachment);
+                pass.clearValues.push_back(usage->clearValue);
+            }
+        }
+    }
+
+    void LveRenderGraph::createRenderPasses() {
+        for (auto &pass : passes) {
+            if (!pass.live || pass.kind != PassKind::Graphics) {
+                continue;
+            }
+
+            std::vector<VkAttachmentDescription> attachments;
+            std::vector<VkAttachmentReference> colorReferences;
+            VkAttachmentReference depthReference{};
+            bool hasDepth = false;
+
+            for (const auto &passAttachment : pass.attachments) {
+                const Usage *usage = passAttachment.usage;
+                VkAttachmentDescription attachment{};
+                attachment.format = resources[passAttachment.resource].desc.format;
+                attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+                attachment.loadOp = passAttachment.loadOp;
+                attachment.storeOp = passAttachment.storeOp;
+                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                // Transitions happen in the graph's barriers, so the pass itself keeps one layout
+                attachment.initialLayout = usage->layout;
+                attachment.finalLayout = usage->layout;
+
+                VkAttachmentReference reference{};
+                reference.attachment = static_cast<uint32_t>(attachments.size());
+                reference.layout = usage->layout;
+                if (usage->type == UsageType::DepthAttachment) {
+                    depthReference = reference;
+                    hasDepth = true;
+                } else {
+                    colorReferences.push_back(reference);
+                }
+                attachments.push_back(attachment);
+            }
+
+            VkSubpassDescription subpass{};
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+            subpass.pColorAttachments = colorReferences.data();
+            subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+            VkRenderPassCreateInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            renderPassInfo.pAttachments = attachments.data();
+            renderPassInfo.subpassCount = 1;
+            renderPassInfo.pSubpasses = &subpass;
+
+            if (vkCreateRenderPass(lveDevice.device(), &renderPassInfo, lveDevice.getAllocator(), &pass.renderPass) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create render pass for " + pass.name);
+            }
+        }
+    }
+
+    VkFramebuffer LveRenderGraph::getFramebuffer(const Pass &pass) {
+        std::vector<VkImageView> views;
+        for (const auto &attachment : pass.attachments) {
+            assert(resources[attachment.resource].view != VK_NULL_HANDLE && "Imported image not set for this frame");
+            views.push_back(resources[attachment.resource].view);
+        }
+
+        auto key = std::make_pair(pass.renderPass, views);
+        auto found = framebuffers.find(key);
+        if (found != framebuffers.end()) {
+            return found->second;
+        }
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = pass.renderPass;
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+        framebufferInfo.pAttachments = views.data();
+        framebufferInfo.width = pass.extent.width;
+        framebufferInfo.height = pass.extent.height;
+        framebufferInfo.layers = 1;
+
+        VkFramebuffer framebuffer;
+        if (vkCreateFramebuffer(lveDevice.device(), &framebufferInfo, lveDevice.getAllocator(), &framebuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create framebuffer for " + pass.name);
+        }
+        framebuffers.emplace(key, framebuffer);
+        return framebuffer;
+    }
+
+    void LveRenderGraph::beginRendering(VkCommandBuffer commandBuffer, const Pass &pass) {
+        std::vector<VkRenderingAttachmentInfoKHR> colorAttachments;
+        VkRenderingAttachmentInfoKHR depthAttachment{};
+        bool hasDepth = false;
+        for (const auto &attachment : pass.attachments) {
+            assert(resources[attachment.resource].view != VK_NULL_HANDLE && "Imported image not set for this frame");
+            VkRenderingAttachmentInfoKHR info{};
+            info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            info.imageView = resources[attachment.resource].view;
+            info.imageLayout = attachment.usage->layout;
+            info.resolveMode = VK_RESOLVE_MODE_NONE;
+            info.loadOp = attachment.loadOp;
+            info.storeOp = attachment.storeOp;
+            info.clearValue = attachment.usage->clearValue;
+            if (attachment.usage->type == UsageType::DepthAttachment) {
+                depthAttachment = info;
+                hasDepth = true;
+            } else {
+                colorAttachments.push_back(info);
+            }
+        }
+
+        VkRenderingInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInfo.renderArea.offset = {0, 0};
+        renderingInfo.renderArea.extent = pass.extent;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+        renderingInfo.pColorAttachments = colorAttachments.data();
+        renderingInfo.pDepthAttachment = hasDepth ? &depthAttachment : nullptr;
+        lveDevice.cmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+    }
+
+    void LveRenderGraph::execute(VkCommandBuffer commandBuffer) {
+        assert(compiled && "Render graph must be compiled before execute");
+
+        // Imported images restart from their per-frame state; transient contents are discarded
+        std::vector<bool> discarded(resources.size(), false);
+        for (ResourceId id = 0; id < resources.size(); id++) {
+            const Resource &resource = resources[id];
+            if (resource.image && resource.imported) {
+                states[id] = AccessState{};
+                states[id].layout = resource.initialLayout;
+                states[id].writeStages = resource.initialStages;
+            } else if (resource.image) {
+                discarded[id] = true;
+            }
+        }
+
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+        auto flushBarriers = [&](VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages) {
+            if (imageBarriers.empty() && bufferBarriers.empty() && srcStages == 0) {
+                return;
+            }
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                dstStages != 0 ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0, 0, nullptr,
+                static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+            imageBarriers.clear();
+            bufferBarriers.clear();
+        };
+
+        auto addImageBarrier = [&](const Resource &resource, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                   VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = newLayout;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = resource.imageHandle;
+            barrier.subresourceRange.aspectMask = aspectMask(resource.desc.format);
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            imageBarriers.push_back(barrier);
+        };
+
+        for (auto &pass : passes) {
+            if (!pass.live) {
+                continue;
+            }
+
+            // Barriers are derived from the state before the pass, then the pass's accesses are applied
+            VkPipelineStageFlags srcStages = 0;
+            VkPipelineStageFlags dstStages = 0;
+            for (const auto &usage : pass.usages) {
+                const Resource &resource = resources[usage.resource];
+                const AccessState &state = states[usage.resource];
+                // First use of a transient waits for whatever last touched its memory, this frame or the last
+                const bool discard = discarded[usage.resource];
+                const AccessState &previous = discard ? blocks[resource.block].state : state;
+                const VkImageLayout oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+                const bool layoutChange = resource.image && oldLayout != usage.layout;
+
+                VkPipelineStageFlags waitStages;
+                VkAccessFlags waitAccess = previous.writeAccess;
+                bool needBarrier;
+                if (usage.write || layoutChange) {
+                    // Write-after-write and write-after-read; a layout transition counts as a write
+                    waitStages = previous.writeStages | previous.readStages;
+                    needBarrier = waitStages != 0 || layoutChange;
+                } else {
+                    // Read-after-write, unless an earlier read already waited for this write
+                    waitStages = previous.writeStages;
+                    bool alreadyVisible =
+                        (state.readStages & usage.stages) == usage.stages &&
+                        (state.readAccess & usage.access) == usage.access;
+                    needBarrier = waitStages != 0 && !alreadyVisible;
+                }
+                if (!needBarrier) {
+                    continue;
+                }
+
+                srcStages |= waitStages;
+                dstStages |= usage.stages;
+                if (resource.image) {
+                    addImageBarrier(resource, oldLayout, usage.layout, waitAccess, usage.access);
+                } else {
+                    VkBufferMemoryBarrier barrier{};
+                    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                    barrier.srcAccessMask = waitAccess;
+                    barrier.dstAccessMask = usage.access;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.buffer = resource.bufferHandle;
+                    barrier.offset = 0;
+                    barrier.size = VK_WHOLE_SIZE;
+                    bufferBarriers.push_back(barrier);
+                }
+            }
+            flushBarriers(srcStages, dstStages);
+
+            for (const auto &usage : pass.usages) {
+                const Resource &resource = resources[usage.resource];
+                AccessState &state = states[usage.resource];
+                if (discarded[usage.resource]) {
+                    state = AccessState{};
+                    discarded[usage.resource] = false;
+                }
+                state.layout = resource.image ? usage.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+                if (usage.write) {
+                    state.writeStages = usage.stages;
+                    state.writeAccess = usage.access;
+                    state.readStages = 0;
+                    state.readAccess = 0;
+                } else {
+                    state.readStages |= usage.stages;
+                    state.readAccess |= usage.access;
+                }
+                if (resource.block != UINT32_MAX) {
+                    blocks[resource.block].state = state;
+                }
+            }
+
+            if (pass.kind == PassKind::Graphics && dynamicRendering) {
+                beginRendering(commandBuffer, pass);
+                pass.record(commandBuffer);
+                lveDevice.cmdEndRenderingKHR(commandBuffer);
+            } else if (pass.kind == PassKind::Graphics) {
+                VkRenderPassBeginInfo renderPassInfo{};
+                renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                renderPassInfo.renderPass = pass.renderPass;
+                renderPassInfo.framebuffer = getFramebuffer(pass);
+                renderPassInfo.renderArea.offset = {0, 0};
+                renderPassInfo.renderArea.extent = pass.extent;
+                renderPassInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+                renderPassInfo.pClearValues = pass.clearValues.data();
+
+                vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+                pass.record(commandBuffer);
+                vkCmdEndRenderPass(commandBuffer);
+            } else {
+                pass.record(commandBuffer);
+            }
+        }
+
+        // Hand imported images back in the layout their owner expects, e.g. for present
+        VkPipelineStageFlags srcStages = 0;
+        for (ResourceId id = 0; id < resources.size(); id++) {
+            const Resource &resource = resources[id];
+            AccessState &state = states[id];
+            if (!resource.image || !resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+                state.layout == resource.finalLayout) {
+                continue;
+            }
+            srcStages |= state.writeStages | state.readStages;
+            addImageBarrier(resource, state.layout, resource.finalLayout, state.writeAccess, 0);
+            state.layout = resource.finalLayout;
+        }
+        if (!imageBarriers.empty()) {
+            flushBarriers(srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        }
+    }
+
+    void LveRenderGraph::printReport() const {
+        std::printf("render graph passes:\n");
+        for (const auto &pass : passes) {
+            std::printf("  %-20s %-8s %s\n", pass.name.c_str(), kindName(pass.kind),
+                pass.live ? "live" : "culled");
+        }
+
+        VkDeviceSize unaliased = 0;
+        VkDeviceSize aliased = 0;
+        for (const auto &resource : resources) {
+            if (resource.block != UINT32_MAX) {
+                unaliased += resource.requirements.size;
+                std::printf("  transient %-16s passes %u-%u  %8.2f MiB  block %u\n",
+                    resource.name.c_str(), resource.firstPass, resource.lastPass,
+                    resource.requirements.size / (1024.0 * 1024.0), resource.block);
+            }
+        }
+        for (const auto &block : blocks) {
+            aliased += block.size;
+        }
+        std::printf("  transient memory %.2f MiB (%.2f MiB without aliasing)\n",
+            aliased / (1024.0 * 1024.0), unaliased / (1024.0 * 1024.0));
+    }
+
+    void LveRenderGraph::destroyResources() {
+        for (auto &entry : framebuffers) {
+            vkDestroyFramebuffer(lveDevice.device(), entry.second, lveDevice.getAllocator());
+        }
+        framebuffers.clear();
+
+        for (auto &pass : passes) {
+            if (pass.renderPass != VK_NULL_HANDLE) {
+                vkDestroyRenderPass(lveDevice.device(), pass.renderPass, lveDevice.getAllocator());
+                pass.renderPass = VK_NULL_HANDLE;
+            }
+        }
+        for (auto &resource : resources) {
+            if (resource.imported) {
+                continue;
+            }
+            if (resource.view != VK_NULL_HANDLE) {
+                vkDestroyImageView(lveDevice.device(), resource.view, lveDevice.getAllocator());
+            }
+            if (resource.imageHandle != VK_NULL_HANDLE) {
+                vkDestroyImage(lveDevice.device(), resource.imageHandle, lveDevice.getAllocator());
+            }
+            resource.view = VK_NULL_HANDLE;
+            resource.imageHandle = VK_NULL_HANDLE;
+            resource.block = UINT32_MAX;
+        }
+        for (auto &block : blocks) {
+            vkFreeMemory(lveDevice.device(), block.memory, lveDevice.getAllocator());
+        }
+        blocks.clear();
+        compiled = false;
+    }
+}
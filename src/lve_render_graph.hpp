@@ -0,0 +1,186 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Frame described as passes that declare what they read and write. compile() culls passes
+    // that contribute nothing, creates transient images with aliased memory and one render pass
+    // per graphics pass; execute() records every live pass with the layout transitions and
+    // pipeline barriers derived from the declared accesses. With dynamic rendering no render
+    // pass or framebuffer objects exist and graphics passes use vkCmdBeginRenderingKHR.
+    class LveRenderGraph {
+        public:
+            using ResourceId = uint32_t;
+            using PassId = uint32_t;
+
+            struct ImageDesc {
+                VkFormat format;
+                VkExtent2D extent;
+            };
+
+            class PassBuilder {
+                public:
+                    // Attachments without a clear value keep what earlier passes wrote
+                    PassBuilder &writeColor(ResourceId image, std::optional<VkClearColorValue> clear = std::nullopt);
+                    PassBuilder &writeDepth(ResourceId image, std::optional<VkClearDepthStencilValue> clear = std::nullopt);
+                    PassBuilder &readImage(ResourceId image, VkPipelineStageFlags stages);
+                    // Source of vkCmdCopyImage* or vkCmdBlitImage
+                    PassBuilder &copySource(ResourceId image);
+                    PassBuilder &readBuffer(ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+                    PassBuilder &writeBuffer(ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+                    // Never culled, for passes whose effects the graph cannot see
+                    PassBuilder &sideEffect();
+
+                    PassId id() const { return passId; }
+
+                private:
+                    friend class LveRenderGraph;
+                    PassBuilder(LveRenderGraph &graph, PassId passId) : graph{graph}, passId{passId} {}
+
+                    LveRenderGraph &graph;
+                    PassId passId;
+            };
+
+            LveRenderGraph(LveDevice &device, bool dynamicRendering = false);
+            ~LveRenderGraph();
+
+            LveRenderGraph(const LveRenderGraph &) = delete;
+            LveRenderGraph &operator=(const LveRenderGraph &) = delete;
+
+            // Owned by the graph; contents do not survive the frame and memory may be shared
+            ResourceId createImage(const std::string &name, const ImageDesc &desc);
+            // Owned elsewhere, e.g. the swap chain image. Each frame starts in initialLayout after
+            // initialStages (the stage an acquire semaphore waits on) and ends in finalLayout.
+            ResourceId importImage(
+                const std::string &name,
+                const ImageDesc &desc,
+                VkImageLayout initialLayout,
+                VkPipelineStageFlags initialStages,
+                VkImageLayout finalLayout);
+            // Owned elsewhere; its access state carries over between frames
+            ResourceId importBuffer(const std::string &name);
+
+            // Imported handles may change every frame
+            void setImportedImage(ResourceId image, VkImage handle, VkImageView view);
+            void setImportedBuffer(ResourceId buffer, VkBuffer handle);
+
+            PassBuilder addGraphicsPass(const std::string &name, std::function<void(VkCommandBuffer)> record);
+            PassBuilder addComputePass(const std::string &name, std::function<void(VkCommandBuffer)> record);
+            // Copies and blits, recorded outside any render pass like compute passes
+            PassBuilder addTransferPass(const std::string &name, std::function<void(VkCommandBuffer)> record);
+
+            void compile();
+            void execute(VkCommandBuffer commandBuffer);
+
+            // Valid after compile for live graphics passes; compatible with pipelines built for it.
+            // VK_NULL_HANDLE with dynamic rendering.
+            VkRenderPass getRenderPass(PassId pass) const { return passes[pass].renderPass; }
+            bool isPassLive(PassId pass) const { return passes[pass].live; }
+            void printReport() const;
+
+        private:
+            enum class PassKind { Graphics, Compute, Transfer };
+            enum class UsageType { ColorAttachment, DepthAttachment, SampledImage, TransferSource, BufferRead, BufferWrite };
+
+            struct Usage {
+                ResourceId resource;
+                UsageType type;
+                VkPipelineStageFlags stages;
+                VkAccessFlags access;
+                VkImageLayout layout;
+                bool write;
+                // Attachments only: clear on load, otherwise the previous contents are kept
+                bool clear;
+                VkClearValue clearValue;
+            };
+
+            struct Attachment {
+                ResourceId resource;
+                const Usage *usage;
+                VkAttachmentLoadOp loadOp;
+                VkAttachmentStoreOp storeOp;
+            };
+
+            struct Pass {
+                std::string name;
+                PassKind kind;
+                bool sideEffect = false;
+                std::function<void(VkCommandBuffer)> record;
+                std::vector<Usage> usages;
+
+                bool live = false;
+                VkRenderPass renderPass = VK_NULL_HANDLE;
+                // Colour attachments first, then depth
+                std::vector<Attachment> attachments;
+                std::vector<VkClearValue> clearValues;
+                VkExtent2D extent{};
+            };
+
+            struct Resource {
+                std::string name;
+                bool image;
+                bool imported;
+                ImageDesc desc{};
+                VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                VkPipelineStageFlags initialStages = 0;
+                VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+                VkImage imageHandle = VK_NULL_HANDLE;
+                VkImageView view = VK_NULL_HANDLE;
+                VkBuffer bufferHandle = VK_NULL_HANDLE;
+                VkImageUsageFlags usage = 0;
+
+                // Transient images: live pass range and the memory block they share
+                uint32_t firstPass = UINT32_MAX;
+                uint32_t lastPass = 0;
+                uint32_t block = UINT32_MAX;
+                VkMemoryRequirements requirements{};
+            };
+
+            // Access state used to derive barriers
+            struct AccessState {
+                VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                VkPipelineStageFlags writeStages = 0;
+                VkAccessFlags writeAccess = 0;
+                VkPipelineStageFlags readStages = 0;
+                VkAccessFlags readAccess = 0;
+            };
+
+            struct MemoryBlock {
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                VkDeviceSize size = 0;
+                uint32_t memoryTypeBits = ~0u;
+                std::vector<ResourceId> members;
+                // Last access to any member, so the next member's first use waits for it
+                AccessState state;
+            };
+
+            static const char *kindName(PassKind kind);
+            PassId addPass(const std::string &name, PassKind kind, std::function<void(VkCommandBuffer)> record);
+            void addUsage(PassId pass, const Usage &usage);
+            void cullPasses();
+            void createTransientImages();
+            void resolveAttachments();
+            void createRenderPasses();
+            VkFramebuffer getFramebuffer(const Pass &pass);
+            void beginRendering(VkCommandBuffer commandBuffer, const Pass &pass);
+            void destroyResources();
+
+            LveDevice &lveDevice;
+            bool dynamicRendering;
+            std::vector<Pass> passes;
+            std::vector<Resource> resources;
+            std::vector<MemoryBlock> blocks;
+            std::vector<AccessState> states;
+            std::map<std::pair<VkRenderPass, std::vector<VkImageView>>, VkFramebuffer> framebuffers;
+            bool compiled = false;
+    };
+}
@@ -0,0 +1,302 @@
+#include "lve_scene.hpp"
+#include "lve_culling.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace lve {
+
+    void LveScene::reserve(uint32_t capacity) {
+        posX.reserve(capacity);
+        posY.reserve(capacity);
+        velX.reserve(capacity);
+        velY.reserve(capacity);
+        rotation.reserve(capacity);
+        angularVelocity.reserve(capacity);
+        scale.reserve(capacity);
+        radius.reserve(capacity);
+        minX.reserve(capacity);
+        minY.reserve(capacity);
+        maxX.reserve(capacity);
+        maxY.reserve(capacity);
+        color.reserve(capacity);
+        meshId.reserve(capacity);
+        visible.reserve(capacity);
+        denseToSlot.reserve(capacity);
+        slotToDense.reserve(capacity);
+        slotGeneration.reserve(capacity);
+    }
+
+    LveScene::Handle LveScene::create(const ObjectDesc &desc) {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slotToDense.size());
+            slotToDense.push_back(UINT32_MAX);
+            slotGeneration.push_back(0);
+        }
+
+        const uint32_t index = size();
+        slotToDense[slot] = index;
+        denseToSlot.push_back(slot);
+
+        posX.push_back(desc.position.x);
+        posY.push_back(desc.position.y);
+        velX.push_back(desc.velocity.x);
+        velY.push_back(desc.velocity.y);
+        rotation.push_back(desc.rotation);
+        angularVelocity.push_back(desc.angularVelocity);
+        scale.push_back(desc.scale);
+        radius.push_back(desc.radius);
+        color.push_back(desc.color);
+        meshId.push_back(desc.meshId);
+        visible.push_back(desc.visible ? 1 : 0);
+        minX.push_back(0.0f);
+        minY.push_back(0.0f);
+        maxX.push_back(0.0f);
+        maxY.push_back(0.0f);
+        updateBounds(index);
+
+        meshIdLimit = std::max(meshIdLimit, desc.meshId + 1);
+        return {slot, slotGeneration[slot]};
+    }
+
+    void LveScene::destroy(Handle handle) {
+        const uint32_t index = denseIndex(handle);
+        const uint32_t last = size() - 1;
+
+        // Swap the last object into the hole to keep the arrays dense
+        auto swapRemove = [index, last](auto &array) {
+            array[index] = array[last];
+            array.pop_back();
+        };
+        swapRemove(posX);
+        swapRemove(posY);
+        swapRemove(velX);
+        swapRemove(velY);
+        swapRemove(rotation);
+        swapRemove(angularVelocity);
+        swapRemove(scale);
+        swapRemove(radius);
+        swapRemove(minX);
+        swapRemove(minY);
+        swapRemove(maxX);
+        swapRemove(maxY);
+        swapRemove(color);
+        swapRemove(meshId);
+        swapRemove(visible);
+
+        const uint32_t movedSlot = denseToSlot[last];
+        slotToDense[movedSlot] = index;
+        swapRemove(denseToSlot);
+
+        slotToDense[handle.slot] = UINT32_MAX;
+        slotGeneration[handle.slot]++;
+        freeSlots.push_back(handle.slot);
+    }
+
+    bool LveScene::isValid(Handle handle) const {
+        return handle.slot < slotToDense.size() &&
+               slotGeneration[handle.slot] == handle.generation &&
+               slotToDense[handle.slot] != UINT32_MAX;
+    }
+
+    void LveScene::clear() {
+        for (uint32_t slot : denseToSlot) {
+            slotToDense[slot] = UINT32_MAX;
+            slotGeneration[slot]++;
+            freeSlots.push_back(slot);
+        }
+        posX.clear();
+        posY.clear();
+        velX.clear();
+        velY.clear();
+        rotation.clear();
+        angularVelocity.clear();
+        scale.clear();
+        radius.clear();
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+        color.clear();
+        meshId.clear();
+        visible.clear();
+        denseToSlot.clear();
+        meshIdLimit = 0;
+    }
+
+    uint32_t LveScene::denseIndex(Handle handle) const {
+        assert(isValid(handle) && "Stale or invalid scene handle");
+        return slotToDense[handle.slot];
+    }
+
+    void LveScene::setPosition(Handle handle, const glm::vec2 &position) {
+        uint32_t index = denseIndex(handle);
+        posX[index] = position.x;
+        posY[index] = position.y;
+        updateBounds(index);
+    }
+
+    void LveScene::setVelocity(Handle handle, const glm::vec2 &velocity) {
+        uint32_t index = denseIndex(handle);
+        velX[index] = velocity.x;
+        velY[index] = velocity.y;
+    }
+
+    void LveScene::setColor(Handle handle, const glm::vec4 &newColor) {
+        color[denseIndex(handle)] = newColor;
+    }
+
+    void LveScene::setVisible(Handle handle, bool isVisible) {
+        visible[denseIndex(handle)] = isVisible ? 1 : 0;
+    }
+
+    void LveScene::setWorldBounds(const glm::vec2 &minBounds, const glm::vec2 &maxBounds) {
+        wrapEnabled = true;
+        worldMin = minBounds;
+        worldMax = maxBounds;
+    }
+
+    void LveScene::updateBounds(uint32_t index) {
+        const float extent = radius[index] * scale[index];
+        minX[index] = posX[index] - extent;
+        minY[index] = posY[index] - extent;
+        maxX[index] = posX[index] + extent;
+        maxY[index] = posY[index] + extent;
+    }
+
+    bool LveScene::hasMotion() const {
+        auto nonZero = [](float value) { return value != 0.0f; };
+        return std::any_of(velX.begin(), velX.end(), nonZero) ||
+            std::any_of(velY.begin(), velY.end(), nonZero) ||
+            std::any_of(angularVelocity.begin(), angularVelocity.end(), nonZero);
+    }
+
+    void LveScene::update(float dt) {
+        const uint32_t count = size();
+        if (jobSystem && count > PARALLEL_GRAIN) {
+            jobSystem->parallelFor(count, PARALLEL_GRAIN, [this, dt](uint32_t begin, uint32_t end) {
+                updateRange(begin, end, dt);
+            });
+        } else {
+            updateRange(0, count, dt);
+        }
+    }
+
+    void LveScene::updateRange(uint32_t begin, uint32_t end, float dt) {
+        float *px = posX.data();
+        float *py = posY.data();
+        const float *vx = velX.data();
+        const float *vy = velY.data();
+        float *rot = rotation.data();
+        const float *angVel = angularVelocity.data();
+
+        // Separate sweeps keep each loop branch-free and easy to vectorize
+        for (uint32_t i = begin; i < end; i++) {
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            rot[i] += angVel[i] * dt;
+        }
+
+        if (wrapEnabled) {
+            const float width = worldMax.x - worldMin.x;
+            const float height = worldMax.y - worldMin.y;
+            for (uint32_t i = begin; i < end; i++) {
+                px[i] += (px[i] < worldMin.x ? width : 0.0f) - (px[i] > worldMax.x ? width : 0.0f);
+                py[i] += (py[i] < worldMin.y ? height : 0.0f) - (py[i] > worldMax.y ? height : 0.0f);
+            }
+        }
+
+        const float *rad = radius.data();
+        const float *scl = scale.data();
+        float *x0 = minX.data();
+        float *y0 = minY.data();
+        float *x1 = maxX.data();
+        float *y1 = maxY.data();
+        for (uint32_t i = begin; i < end; i++) {
+            const float extent = rad[i] * scl[i];
+            x0[i] = px[i] - extent;
+            y0[i] = py[i] - extent;
+            x1[i] = px[i] + extent;
+            y1[i] = py[i] + extent;
+        }
+    }
+
+    void LveScene::cull(const glm::vec2 &viewMin, const glm::vec2 &viewMax, std::vector<uint32_t> &visibleIndices) const {
+        const uint32_t count = size();
+        visibleIndices.resize(count);
+        if (!jobSystem || count <= PARALLEL_GRAIN) {
+            uint32_t visibleCount = cullRects(
+                minX.data(), minY.data(), maxX.data(), maxY.data(),
+                visible.data(),
+                count,
+                {viewMin, viewMax},
+                visibleIndices.data());
+            visibleIndices.resize(visibleCount);
+            return;
+        }
+
+        // Each range compacts into its own stretch of the output, then the stretches are closed
+        // up in order so the result matches the serial sweep
+        rangeVisibleCounts.assign((count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN, 0);
+        jobSystem->parallelFor(count, PARALLEL_GRAIN, [&](uint32_t begin, uint32_t end) {
+            uint32_t *out = visibleIndices.data() + begin;
+            const uint32_t rangeVisible = cullRects(
+                minX.data() + begin, minY.data() + begin, maxX.data() + begin, maxY.data() + begin,
+                visible.data() + begin,
+                end - begin,
+                {viewMin, viewMax},
+                out);
+            for (uint32_t i = 0; i < rangeVisible; i++) {
+                out[i] += begin;
+            }
+            rangeVisibleCounts[begin / PARALLEL_GRAIN] = rangeVisible;
+        });
+
+        uint32_t visibleCount = 0;
+        for (uint32_t range = 0; range < rangeVisibleCounts.size(); range++) {
+            const uint32_t *first = visibleIndices.data() + size_t{range} * PARALLEL_GRAIN;
+            uint32_t *dest = visibleIndices.data() + visibleCount;
+            // Already in place while every earlier range was fully visible; std::copy may not
+            // write onto its own source
+            if (dest != first) {
+                std::copy(first, first + rangeVisibleCounts[range], dest);
+            }
+            visibleCount += rangeVisibleCounts[range];
+        }
+        visibleIndices.resize(visibleCount);
+    }
+
+    void LveScene::buildDrawList(
+        const std::vector<uint32_t> &visibleIndices,
+        std::vector<InstanceData> &instances,
+        std::vector<DrawBatch> &batches) const {
+        meshOffsets.assign(meshIdLimit + 1, 0);
+        for (uint32_t index : visibleIndices) {
+            meshOffsets[meshId[index] + 1]++;
+        }
+
+        batches.clear();
+        for (uint32_t mesh = 0; mesh < meshIdLimit; mesh++) {
+            const uint32_t instanceCount = meshOffsets[mesh + 1];
+            if (instanceCount > 0) {
+                batches.push_back({mesh, meshOffsets[mesh], instanceCount});
+            }
+            meshOffsets[mesh + 1] += meshOffsets[mesh];
+        }
+
+        instances.resize(visibleIndices.size());
+        for (uint32_t index : visibleIndices) {
+            InstanceData &instance = instances[meshOffsets[meshId[index]]++];
+            instance.position = {posX[index], posY[index]};
+            instance.rotation = rotation[index];
+            instance.scale = scale[index];
+            instance.color = color[index];
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "lve_job_system.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+    // Scene objects stored as structure-of-arrays. Objects live densely in
+    // [0, size()) and are addressed from outside through generational handles,
+    // so removal is a swap with the last element and every per-frame pass is
+    // a linear sweep over contiguous arrays.
+    class LveScene {
+        public:
+            struct Handle {
+                uint32_t slot = UINT32_MAX;
+                uint32_t generation = 0;
+            };
+
+            struct ObjectDesc {
+                glm::vec2 position{0.0f, 0.0f};
+                glm::vec2 velocity{0.0f, 0.0f};
+                float rotation = 0.0f;
+                float angularVelocity = 0.0f;
+                float scale = 1.0f;
+                // Radius of the mesh's bounding circle before scaling
+                float radius = 1.0f;
+                glm::vec4 color{1.0f, 1.0f, 1.0f, 1.0f};
+                uint32_t meshId = 0;
+                bool visible = true;
+            };
+
+            // Per-instance vertex data, matches the binding 1 layout of instanced.vert
+            struct InstanceData {
+                glm::vec2 position;
+                float rotation;
+                float scale;
+                glm::vec4 color;
+            };
+
+            struct DrawBatch {
+                uint32_t meshId;
+                uint32_t firstInstance;
+                uint32_t instanceCount;
+            };
+
+            // Objects per job when update() and cull() are split across the job system
+            static constexpr uint32_t PARALLEL_GRAIN = 16384;
+
+            void reserve(uint32_t capacity);
+            Handle create(const ObjectDesc &desc);
+            void destroy(Handle handle);
+            bool isValid(Handle handle) const;
+            void clear();
+
+            void setPosition(Handle handle, const glm::vec2 &position);
+            void setVelocity(Handle handle, const glm::vec2 &velocity);
+            void setColor(Handle handle, const glm::vec4 &color);
+            void setVisible(Handle handle, bool visible);
+
+            // Objects leaving these bounds wrap around to the other side
+            void setWorldBounds(const glm::vec2 &minBounds, const glm::vec2 &maxBounds);
+            // Scenes larger than one grain update and cull in parallel; null keeps it all on the caller
+            void setJobSystem(LveJobSystem *jobSystem) { this->jobSystem = jobSystem; }
+
+            // Integrates motion and refreshes world bounds
+            void update(float dt);
+            // True when update() would move or rotate anything
+            bool hasMotion() const;
+            // Writes the dense index of every visible object overlapping the view
+            void cull(const glm::vec2 &viewMin, const glm::vec2 &viewMax, std::vector<uint32_t> &visibleIndices) const;
+            // Groups visible objects by mesh (counting sort) into contiguous instance data
+            void buildDrawList(
+                const std::vector<uint32_t> &visibleIndices,
+                std::vector<InstanceData> &instances,
+                std::vector<DrawBatch> &batches) const;
+
+            uint32_t size() const { return static_cast<uint32_t>(posX.size()); }
+
+            // Raw world-space bounds for culling systems
+            const float *getMinX() const { return minX.data(); }
+            const float *getMinY() const { return minY.data(); }
+            const float *getMaxX() const { return maxX.data(); }
+            const float *getMaxY() const { return maxY.data(); }
+            const uint8_t *getVisibleFlags() const { return visible.data(); }
+
+        private:
+            uint32_t denseIndex(Handle handle) const;
+            void updateBounds(uint32_t index);
+            void updateRange(uint32_t begin, uint32_t end, float dt);
+
+            // Dense object arrays
+            std::vector<float> posX, posY;
+            std::vector<float> velX, velY;
+            std::vector<float> rotation, angularVelocity;
+            std::vector<float> scale, radius;
+            std::vector<float> minX, minY, maxX, maxY;
+            std::vector<glm::vec4> color;
+            std::vector<uint32_t> meshId;
+            std::vector<uint8_t> visible;
+            std::vector<uint32_t> denseToSlot;
+
+            // Handle indirection
+            std::vector<uint32_t> slotToDense;
+            std::vector<uint32_t> slotGeneration;
+            std::vector<uint32_t> freeSlots;
+
+            bool wrapEnabled = false;
+            glm::vec2 worldMin{0.0f, 0.0f};
+            glm::vec2 worldMax{0.0f, 0.0f};
+            uint32_t meshIdLimit = 0;
+            mutable std::vector<uint32_t> meshOffsets;
+
+            LveJobSystem *jobSystem = nullptr;
+            mutable std::vector<uint32_t> rangeVisibleCounts;
+    };
+}
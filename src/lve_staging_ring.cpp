@@ -0,0 +1,51 @@
+#include "lve_staging_ring.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+
+    LveStagingRing::LveStagingRing(LveDevice &device, VkDeviceSize size, uint32_t slotCount)
+        : lveDevice{device}, size{size}, slotEnds(slotCount, 0) {
+        lveDevice.createBuffer(
+            size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            buffer,
+            memory
+        );
+        void *data;
+        vkMapMemory(lveDevice.device(), memory, 0, VK_WHOLE_SIZE, 0, &data);
+        mapped = static_cast<uint8_t *>(data);
+    }
+
+    LveStagingRing::~LveStagingRing() {
+        vkUnmapMemory(lveDevice.device(), memory);
+        vkDestroyBuffer(lveDevice.device(), buffer, lveDevice.getAllocator());
+        vkFreeMemory(lveDevice.device(), memory, lveDevice.getAllocator());
+    }
+
+    void LveStagingRing::beginFrame(uint32_t slot) {
+        // Frames retire in order, so this slot's mark covers every older frame as well
+        tail = std::max(tail, slotEnds[slot]);
+        currentSlot = slot;
+        slotEnds[slot] = head;
+    }
+
+    bool LveStagingRing::allocate(VkDeviceSize bytes, VkDeviceSize alignment, VkDeviceSize &offset) {
+        assert(alignment > 0 && "Alignment must be at least 1");
+        uint64_t start = (head + alignment - 1) / alignment * alignment;
+        if (start % size + bytes > size) {
+            // Skip the end of the ring; the gap is freed with this allocation
+            start = (start / size + 1) * size;
+        }
+        if (start + bytes - tail > size) {
+            return false;
+        }
+        offset = start % size;
+        head = start + bytes;
+        slotEnds[currentSlot] = head;
+        return true;
+    }
+}
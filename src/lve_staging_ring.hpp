@@ -0,0 +1,48 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+    // Persistently mapped upload buffer used as a ring. Each frame slot remembers how far the
+    // ring had been filled when it was last recorded; once the slot's fence has signalled,
+    // everything up to that point is free again, so uploads never wait on the GPU.
+    class LveStagingRing {
+        public:
+            LveStagingRing(LveDevice &device, VkDeviceSize size, uint32_t slotCount);
+            ~LveStagingRing();
+
+            LveStagingRing(const LveStagingRing &) = delete;
+            LveStagingRing &operator=(const LveStagingRing &) = delete;
+
+            // Call once the slot's fence has signalled, before allocating for the frame recorded
+            // into it: frees what the slot's previous frame used
+            void beginFrame(uint32_t slot);
+            // Returns false when size bytes are not free until more frames retire. Allocations
+            // never wrap, so a request larger than the ring always fails.
+            bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+
+            VkBuffer getBuffer() const { return buffer; }
+            uint8_t *getMapped() const { return mapped; }
+            VkDeviceSize getSize() const { return size; }
+            // Bytes allocated and not yet retired
+            VkDeviceSize getUsedBytes() const { return head - tail; }
+
+        private:
+            LveDevice &lveDevice;
+            VkDeviceSize size;
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            uint8_t *mapped = nullptr;
+
+            // Running byte counts; the ring offset is the count modulo size
+            uint64_t head = 0;
+            uint64_t tail = 0;
+            std::vector<uint64_t> slotEnds;
+            uint32_t currentSlot = 0;
+    };
+}
@@ -0,0 +1,146 @@
+#include "lve_startup.hpp"
+
+// std
+#include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+
+namespace lve {
+
+    LveStartupGraph::TaskId LveStartupGraph::addTask(
+            const std::string &name,
+            Thread thread,
+            std::function<void()> fn,
+            const std::vector<TaskId> &dependencies) {
+        TaskId id = static_cast<TaskId>(tasks.size());
+        for (TaskId dependency : dependencies) {
+            // Dependencies must already exist, which also rules out cycles
+            if (dependency >= id) {
+                throw std::runtime_error("startup task '" + name + "' depends on an unknown task");
+            }
+        }
+        tasks.push_back({name, thread, std::move(fn), dependencies, {}, {}});
+        return id;
+    }
+
+    void LveStartupGraph::run() {
+        enum class State { Pending, Running, Done };
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::vector<State> states(tasks.size(), State::Pending);
+        LveJobSystem::Counter workerTasks;
+        std::exception_ptr failure;
+        size_t doneCount = 0;
+        size_t runningWorkers = 0;
+
+        auto isReady = [&](TaskId id) {
+            if (states[id] != State::Pending) {
+                return false;
+            }
+            for (TaskId dependency : tasks[id].dependencies) {
+                if (states[dependency] != State::Done) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto execute = [&](TaskId id) {
+            Task &task = tasks[id];
+            task.startTime = Clock::now();
+            std::exception_ptr error;
+            try {
+                task.fn();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            task.endTime = Clock::now();
+
+            std::lock_guard<std::mutex> lock{mutex};
+            states[id] = State::Done;
+            doneCount++;
+            if (error && !failure) {
+                failure = error;
+            }
+            if (task.thread == Thread::Worker) {
+                runningWorkers--;
+            }
+            finished.notify_all();
+        };
+
+        graphStart = Clock::now();
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            while (doneCount < tasks.size()) {
+                if (failure) {
+                    // Start nothing new; phases already running are waited for below
+                    break;
+                }
+
+                TaskId mainTask = static_cast<TaskId>(tasks.size());
+                for (TaskId id = 0; id < tasks.size(); id++) {
+                    if (!isReady(id)) {
+                        continue;
+                    }
+                    states[id] = State::Running;
+                    if (tasks[id].thread == Thread::Worker) {
+                        runningWorkers++;
+                        jobSystem.run([&execute, id]() { execute(id); }, &workerTasks);
+                    } else if (mainTask == tasks.size()) {
+                        mainTask = id;
+                    } else {
+                        states[id] = State::Pending;
+                    }
+                }
+
+                if (mainTask < tasks.size()) {
+                    lock.unlock();
+                    execute(mainTask);
+                    lock.lock();
+                    continue;
+                }
+
+                size_t seen = doneCount;
+                assert(runningWorkers > 0 && "startup graph has no runnable task");
+                lock.unlock();
+                bool helped = jobSystem.runPendingJob();
+                lock.lock();
+                if (!helped) {
+                    finished.wait(lock, [&]() { return doneCount != seen; });
+                }
+            }
+        }
+
+        // execute() never throws, so this only waits
+        jobSystem.wait(workerTasks);
+        graphEnd = Clock::now();
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    void LveStartupGraph::printReport() const {
+        auto ms = [this](Clock::time_point time) {
+            return std::chrono::duration<double, std::milli>(time - graphStart).count();
+        };
+
+        double serialMs = 0.0;
+        std::printf("%-20s %-7s %10s %10s %10s\n", "startup phase", "thread", "start ms", "end ms", "took ms");
+        for (const auto &task : tasks) {
+            double took = ms(task.endTime) - ms(task.startTime);
+            serialMs += took;
+            std::printf("%-20s %-7s %10.2f %10.2f %10.2f\n",
+                task.name.c_str(),
+                task.thread == Thread::Main ? "main" : "worker",
+                ms(task.startTime),
+                ms(task.endTime),
+                took);
+        }
+        std::printf("startup total %.2f ms (phases sum to %.2f ms)\n", ms(graphEnd), serialMs);
+    }
+}
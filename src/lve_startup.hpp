@@ -0,0 +1,57 @@
+#pragma once
+
+#include "lve_job_system.hpp"
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Runs startup phases as a dependency graph. Worker phases go to the job system as soon as
+    // their dependencies finish; main-thread phases (window system calls) run on the caller, which
+    // helps with worker phases while none of its own are ready.
+    class LveStartupGraph {
+        public:
+            using TaskId = uint32_t;
+            using Clock = std::chrono::steady_clock;
+
+            enum class Thread { Main, Worker };
+
+            explicit LveStartupGraph(LveJobSystem &jobSystem) : jobSystem{jobSystem} {}
+
+            LveStartupGraph(const LveStartupGraph &) = delete;
+            LveStartupGraph &operator=(const LveStartupGraph &) = delete;
+
+            TaskId addTask(
+                const std::string &name,
+                Thread thread,
+                std::function<void()> fn,
+                const std::vector<TaskId> &dependencies = {});
+
+            // Blocks until every phase has finished; rethrows the first failure after all
+            // running phases have stopped
+            void run();
+
+            // Per phase start/end offsets and durations relative to the start of run()
+            void printReport() const;
+
+        private:
+            struct Task {
+                std::string name;
+                Thread thread;
+                std::function<void()> fn;
+                std::vector<TaskId> dependencies;
+                Clock::time_point startTime;
+                Clock::time_point endTime;
+            };
+
+            LveJobSystem &jobSystem;
+            std::vector<Task> tasks;
+            Clock::time_point graphStart;
+            Clock::time_point graphEnd;
+    };
+}
@@ -0,0 +1,156 @@
+#include "lve_stripifier.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+
+    static constexpr uint32_t NO_TRIANGLE = 0xFFFFFFFF;
+
+    namespace {
+        // Edge from -> to as it appears in the winding of triangle
+        struct DirectedEdge {
+            uint64_t key;
+            uint32_t triangle;
+        };
+
+        class StripBuilder {
+            public:
+                explicit StripBuilder(const std::vector<uint32_t> &indices)
+                    : indices{indices},
+                      triangleCount{static_cast<uint32_t>(indices.size() / 3)},
+                      used(triangleCount, 0),
+                      trialMarks(triangleCount, 0) {
+                    edges.reserve(indices.size());
+                    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+                        const uint32_t a = indices[triangle * 3];
+                        const uint32_t b = indices[triangle * 3 + 1];
+                        const uint32_t c = indices[triangle * 3 + 2];
+                        if (a == b || b == c || c == a) {
+                            used[triangle] = 1;
+                            continue;
+                        }
+                        edges.push_back({edgeKey(a, b), triangle});
+                        edges.push_back({edgeKey(b, c), triangle});
+                        edges.push_back({edgeKey(c, a), triangle});
+                    }
+                    std::sort(edges.begin(), edges.end(), [](const DirectedEdge &x, const DirectedEdge &y) {
+                        return x.key < y.key || (x.key == y.key && x.triangle < y.triangle);
+                    });
+                }
+
+                std::vector<uint32_t> build() {
+                    std::vector<uint32_t> strips;
+                    strips.reserve(triangleCount + triangleCount / 4);
+                    std::vector<uint32_t> best, trial, bestTriangles, trialTriangles;
+
+                    for (uint32_t start = 0; start < triangleCount; start++) {
+                        if (used[start]) {
+                            continue;
+                        }
+                        best.clear();
+                        for (uint32_t rotation = 0; rotation < 3; rotation++) {
+                            grow(start, rotation, trial, trialTriangles);
+                            if (trial.size() > best.size()) {
+                                best.swap(trial);
+                                bestTriangles.swap(trialTriangles);
+                            }
+                        }
+                        for (uint32_t triangle : bestTriangles) {
+                            used[triangle] = 1;
+                        }
+                        if (!strips.empty()) {
+                            strips.push_back(PRIMITIVE_RESTART_INDEX);
+                        }
+                        strips.insert(strips.end(), best.begin(), best.end());
+                    }
+                    return strips;
+                }
+
+            private:
+                static uint64_t edgeKey(uint32_t from, uint32_t to) {
+                    return (static_cast<uint64_t>(from) << 32) | to;
+                }
+
+                // An unused triangle whose winding contains from -> to and is not yet in the trial
+                uint32_t findNeighbour(uint32_t from, uint32_t to) const {
+                    const uint64_t key = edgeKey(from, to);
+                    auto it = std::lower_bound(edges.begin(), edges.end(), key, [](const DirectedEdge &edge, uint64_t k) {
+                        return edge.key < k;
+                    });
+                    for (; it != edges.end() && it->key == key; ++it) {
+                        if (!used[it->triangle] && trialMarks[it->triangle] != trialStamp) {
+                            return it->triangle;
+                        }
+                    }
+                    return NO_TRIANGLE;
+                }
+
+                uint32_t thirdVertex(uint32_t triangle, uint32_t from, uint32_t to) const {
+                    for (uint32_t corner = 0; corner < 3; corner++) {
+                        const uint32_t vertex = indices[triangle * 3 + corner];
+                        if (vertex != from && vertex != to) {
+                            return vertex;
+                        }
+                    }
+                    assert(false && "triangle does not contain the edge");
+                    return from;
+                }
+
+                // Triangle i of a strip is (v[i], v[i + 1], v[i + 2]) for even i and
+                // (v[i], v[i + 2], v[i + 1]) for odd i, so the next triangle must wind through the
+                // last two vertices forwards after an even count and backwards after an odd one
+                void grow(uint32_t start, uint32_t rotation, std::vector<uint32_t> &strip, std::vector<uint32_t> &triangles) {
+                    trialStamp++;
+                    strip.clear();
+                    triangles.clear();
+                    for (uint32_t corner = 0; corner < 3; corner++) {
+                        strip.push_back(indices[start * 3 + (rotation + corner) % 3]);
+                    }
+                    triangles.push_back(start);
+                    trialMarks[start] = trialStamp;
+
+                    while (true) {
+                        const size_t next = strip.size() - 2;
+                        const uint32_t older = strip[strip.size() - 2];
+                        const uint32_t newer = strip[strip.size() - 1];
+                        const uint32_t from = next % 2 == 0 ? older : newer;
+                        const uint32_t to = next % 2 == 0 ? newer : older;
+                        const uint32_t triangle = findNeighbour(from, to);
+                        if (triangle == NO_TRIANGLE) {
+                            return;
+                        }
+                        strip.push_back(thirdVertex(triangle, from, to));
+                        triangles.push_back(triangle);
+                        trialMarks[triangle] = trialStamp;
+                    }
+                }
+
+                const std::vector<uint32_t> &indices;
+                uint32_t triangleCount;
+                std::vector<uint8_t> used;
+                std::vector<uint32_t> trialMarks;
+                uint32_t trialStamp = 0;
+                std::vector<DirectedEdge> edges;
+        };
+    }
+
+    std::vector<uint32_t> stripify(const std::vector<uint32_t> &triangleIndices) {
+        assert(triangleIndices.size() % 3 == 0 && "Triangle list size must be a multiple of 3");
+        return StripBuilder{triangleIndices}.build();
+    }
+
+    uint32_t countStripTriangles(const std::vector<uint32_t> &stripIndices) {
+        uint32_t triangles = 0;
+        uint32_t run = 0;
+        for (uint32_t index : stripIndices) {
+            if (index == PRIMITIVE_RESTART_INDEX) {
+                run = 0;
+            } else if (++run >= 3) {
+                triangles++;
+            }
+        }
+        return triangles;
+    }
+}
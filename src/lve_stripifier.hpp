@@ -0,0 +1,22 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+    // Separates strips in an index list drawn with primitive restart. A 16-bit index buffer uses
+    // the low half, 0xFFFF, instead.
+    static constexpr uint32_t PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+
+    // Converts a triangle list into triangle strips joined by PRIMITIVE_RESTART_INDEX. Each strip
+    // starts at the first unused triangle and repeatedly steps to the unused neighbour across its
+    // newest edge; all three rotations of the start are tried and the longest strip is kept.
+    // Every triangle keeps its winding, and degenerate triangles are dropped. A long strip needs
+    // about one index per triangle instead of three.
+    std::vector<uint32_t> stripify(const std::vector<uint32_t> &triangleIndices);
+
+    // Number of triangles a strip index list draws, counting restarts
+    uint32_t countStripTriangles(const std::vector<uint32_t> &stripIndices);
+}
@@ -0,0 +1,222 @@
+#include "lve_submit_thread.hpp"
+
+// std
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace lve {
+
+    static_assert((LveSubmitThread::CAPACITY & (LveSubmitThread::CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    // Empty polls the thread makes before going to sleep
+    static constexpr uint32_t IDLE_SPINS = 64;
+
+    LveSubmitThread::LveSubmitThread(VkDevice device) : device{device} {
+        for (uint32_t i = 0; i < CAPACITY; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        thread = std::thread{&LveSubmitThread::threadLoop, this};
+    }
+
+    LveSubmitThread::~LveSubmitThread() {
+        Request request{};
+        request.type = Type::Stop;
+        push(request);
+        thread.join();
+    }
+
+    void LveSubmitThread::submit(const SubmitRequest &request) {
+        throwIfFailed();
+        Request wrapped{};
+        wrapped.type = Type::Submit;
+        wrapped.submit = request;
+        push(wrapped);
+    }
+
+    void LveSubmitThread::present(const PresentRequest &request) {
+        throwIfFailed();
+        Request wrapped{};
+        wrapped.type = Type::Present;
+        wrapped.present = request;
+        push(wrapped);
+    }
+
+    void LveSubmitThread::acquire(const AcquireRequest &request) {
+        throwIfFailed();
+        request.ticket->ready.store(false, std::memory_order_relaxed);
+        Request wrapped{};
+        wrapped.type = Type::Acquire;
+        wrapped.acquire = request;
+        push(wrapped);
+    }
+
+    void LveSubmitThread::wait(AcquireTicket &ticket) {
+        if (!ticket.ready.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock{completionMutex};
+            completed.wait(lock, [&ticket]() { return ticket.ready.load(std::memory_order_acquire); });
+        }
+    }
+
+    void LveSubmitThread::waitIdle() {
+        const uint64_t target = enqueuePosition.load();
+        std::unique_lock<std::mutex> lock{completionMutex};
+        completed.wait(lock, [this, target]() { return processed.load() >= target; });
+    }
+
+    void LveSubmitThread::printReport() const {
+        std::printf("submit thread: %llu presents, %.1f ms blocked in present, %.1f ms in acquire, "
+                    "ring full %llu times\n",
+            static_cast<unsigned long long>(presents),
+            presentSeconds * 1000.0,
+            acquireSeconds * 1000.0,
+            static_cast<unsigned long long>(fullRetries.load()));
+    }
+
+    void LveSubmitThread::push(const Request &request) {
+        uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[position & (CAPACITY - 1)];
+            const uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // Still holds the request from one lap ago; let the thread catch up
+                fullRetries.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        cell->request = request;
+        // Sequentially consistent, as is the load of sleeping: either the thread sees this request
+        // before it sleeps or we see it sleeping
+        cell->sequence.store(position + 1);
+
+        if (sleeping.load()) {
+            { std::lock_guard<std::mutex> lock{wakeMutex}; }
+            wake.notify_one();
+        }
+    }
+
+    bool LveSubmitThread::pop(Request &request) {
+        if (!hasRequest()) {
+            return false;
+        }
+        Cell &cell = cells[dequeuePosition & (CAPACITY - 1)];
+        request = cell.request;
+        cell.sequence.store(dequeuePosition + CAPACITY, std::memory_order_release);
+        dequeuePosition++;
+        return true;
+    }
+
+    bool LveSubmitThread::hasRequest() const {
+        return cells[dequeuePosition & (CAPACITY - 1)].sequence.load() == dequeuePosition + 1;
+    }
+
+    void LveSubmitThread::threadLoop() {
+        uint32_t idleSpins = 0;
+        while (true) {
+            Request request{};
+            if (!pop(request)) {
+                if (++idleSpins < IDLE_SPINS) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock{wakeMutex};
+                sleeping.store(true);
+                wake.wait(lock, [this]() { return hasRequest(); });
+                sleeping.store(false);
+                idleSpins = 0;
+                continue;
+            }
+
+            if (request.type != Type::Stop) {
+                execute(request);
+            }
+            {
+                std::lock_guard<std::mutex> lock{completionMutex};
+                processed.fetch_add(1);
+            }
+            completed.notify_all();
+            if (request.type == Type::Stop) {
+                return;
+            }
+        }
+    }
+
+    void LveSubmitThread::execute(const Request &request) {
+        switch (request.type) {
+            case Type::Submit: {
+                const SubmitRequest &submit = request.submit;
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                if (submit.waitSemaphore != VK_NULL_HANDLE) {
+                    submitInfo.waitSemaphoreCount = 1;
+                    submitInfo.pWaitSemaphores = &submit.waitSemaphore;
+                    submitInfo.pWaitDstStageMask = &submit.waitStage;
+                }
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &submit.commandBuffer;
+                if (submit.signalSemaphore != VK_NULL_HANDLE) {
+                    submitInfo.signalSemaphoreCount = 1;
+                    submitInfo.pSignalSemaphores = &submit.signalSemaphore;
+                }
+                VkResult result = vkQueueSubmit(submit.queue, 1, &submitInfo, submit.fence);
+                if (result != VK_SUCCESS) {
+                    VkResult expected = VK_SUCCESS;
+                    submitResult.compare_exchange_strong(expected, result);
+                }
+                break;
+            }
+            case Type::Present: {
+                const PresentRequest &present = request.present;
+                VkPresentInfoKHR presentInfo{};
+                presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+                presentInfo.waitSemaphoreCount = 1;
+                presentInfo.pWaitSemaphores = &present.waitSemaphore;
+                presentInfo.swapchainCount = 1;
+                presentInfo.pSwapchains = &present.swapChain;
+                presentInfo.pImageIndices = &present.imageIndex;
+
+                auto start = std::chrono::steady_clock::now();
+                presentResult.store(vkQueuePresentKHR(present.queue, &presentInfo));
+                presentSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                presents++;
+                break;
+            }
+            case Type::Acquire: {
+                const AcquireRequest &acquire = request.acquire;
+                auto start = std::chrono::steady_clock::now();
+                if (acquire.waitFence != VK_NULL_HANDLE) {
+                    vkWaitForFences(device, 1, &acquire.waitFence, VK_TRUE, UINT64_MAX);
+                }
+                uint32_t imageIndex = 0;
+                VkResult result = vkAcquireNextImageKHR(
+                    device, acquire.swapChain, UINT64_MAX, acquire.semaphore, VK_NULL_HANDLE, &imageIndex);
+                acquireSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::lock_guard<std::mutex> lock{completionMutex};
+                acquire.ticket->imageIndex = imageIndex;
+                acquire.ticket->result = result;
+                acquire.ticket->ready.store(true, std::memory_order_release);
+                break;
+            }
+            case Type::Stop:
+                break;
+        }
+    }
+
+    void LveSubmitThread::throwIfFailed() {
+        VkResult result = submitResult.load();
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("queue submission failed on the submit thread: " + std::to_string(result));
+        }
+    }
+}
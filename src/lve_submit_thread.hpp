@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace lve {
+
+    // Owns the graphics and present queues once started: every vkQueueSubmit, vkQueuePresentKHR
+    // and, for the swap chain, vkAcquireNextImageKHR runs on this thread, in the order requests
+    // were pushed. Producers on any thread claim a slot of a bounded ring with one compare and
+    // swap, so a present that blocks for a vsync interval stalls only this thread, never the one
+    // simulating and recording. Producers only touch a mutex to wake the thread when it sleeps.
+    class LveSubmitThread {
+        public:
+            // Power of two; producers spin while the ring is full
+            static constexpr uint32_t CAPACITY = 64;
+
+            struct SubmitRequest {
+                VkQueue queue;
+                VkCommandBuffer commandBuffer;
+                VkSemaphore waitSemaphore = VK_NULL_HANDLE;
+                VkPipelineStageFlags waitStage = 0;
+                VkSemaphore signalSemaphore = VK_NULL_HANDLE;
+                VkFence fence = VK_NULL_HANDLE;
+            };
+
+            struct PresentRequest {
+                VkQueue queue;
+                VkSwapchainKHR swapChain;
+                uint32_t imageIndex;
+                VkSemaphore waitSemaphore;
+            };
+
+            // Filled in by the thread; wait() returns once ready is set
+            struct AcquireTicket {
+                std::atomic<bool> ready{false};
+                uint32_t imageIndex = 0;
+                VkResult result = VK_SUCCESS;
+            };
+
+            // waitFence, if set, is waited on first; the thread may only signal semaphore once the
+            // frame that last waited on it has finished
+            struct AcquireRequest {
+                VkSwapchainKHR swapChain;
+                VkFence waitFence;
+                VkSemaphore semaphore;
+                AcquireTicket *ticket;
+            };
+
+            explicit LveSubmitThread(VkDevice device);
+            // Runs every request already pushed before joining
+            ~LveSubmitThread();
+
+            LveSubmitThread(const LveSubmitThread &) = delete;
+            LveSubmitThread &operator=(const LveSubmitThread &) = delete;
+
+            // Throw if an earlier submit failed on the thread
+            void submit(const SubmitRequest &request);
+            void present(const PresentRequest &request);
+            void acquire(const AcquireRequest &request);
+
+            void wait(AcquireTicket &ticket);
+            // Returns once every request pushed before the call has run
+            void waitIdle();
+            // Result of the most recent present, e.g. VK_SUBOPTIMAL_KHR
+            VkResult getPresentResult() const { return presentResult.load(); }
+
+            // Time the thread spent blocked in present and acquire, and how often producers found
+            // the ring full. Call after waitIdle().
+            void printReport() const;
+
+        private:
+            enum class Type { Submit, Present, Acquire, Stop };
+
+            struct Request {
+                Type type;
+                SubmitRequest submit;
+                PresentRequest present;
+                AcquireRequest acquire;
+            };
+
+            // Sequence is the ring position a producer may claim the cell at, or that position + 1
+            // once the request in it is published
+            struct Cell {
+                std::atomic<uint64_t> sequence{0};
+                Request request;
+            };
+
+            void push(const Request &request);
+            bool pop(Request &request);
+            bool hasRequest() const;
+            void threadLoop();
+            void execute(const Request &request);
+            void throwIfFailed();
+
+            VkDevice device;
+            std::array<Cell, CAPACITY> cells;
+            alignas(64) std::atomic<uint64_t> enqueuePosition{0};
+            // Only touched by the thread
+            alignas(64) uint64_t dequeuePosition = 0;
+
+            // Producers lock this only when sleeping is set
+            std::mutex wakeMutex;
+            std::condition_variable wake;
+            std::atomic<bool> sleeping{false};
+
+            std::mutex completionMutex;
+            std::condition_variable completed;
+            std::atomic<uint64_t> processed{0};
+
+            std::atomic<VkResult> submitResult{VK_SUCCESS};
+            std::atomic<VkResult> presentResult{VK_SUCCESS};
+            std::atomic<uint64_t> fullRetries{0};
+            uint64_t presents = 0;
+            double presentSeconds = 0.0;
+            double acquireSeconds = 0.0;
+
+            std::thread thread;
+    };
+}
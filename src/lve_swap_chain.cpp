@@ -11,47 +11,88 @@
 
 namespace lve {
 
-LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent)
-    : device{deviceRef}, windowExtent{extent} {
+LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent, bool dynamicRendering)
+    : dynamicRendering{dynamicRendering}, device{deviceRef}, windowExtent{extent} {
   createSwapChain();
   createImageViews();
-  createRenderPass();
-  createDepthResources();
-  createFramebuffers();
+  if (!dynamicRendering) {
+    createRenderPass();
+    createDepthResources();
+    createFramebuffers();
+  }
   createSyncObjects();
 }
 
 LveSwapChain::~LveSwapChain() {
+  // A present or acquire may still be queued on the submit thread
+  if (LveSubmitThread *submitThread = device.getSubmitThread()) {
+    submitThread->waitIdle();
+    if (acquireRequested) {
+      submitThread->wait(acquireTicket);
+      consumeImageAvailableSemaphore();
+    }
+  }
+
   for (auto imageView : swapChainImageViews) {
-    vkDestroyImageView(device.device(), imageView, nullptr);
+    vkDestroyImageView(device.device(), imageView, device.getAllocator());
   }
   swapChainImageViews.clear();
 
   if (swapChain != nullptr) {
-    vkDestroySwapchainKHR(device.device(), swapChain, nullptr);
+    vkDestroySwapchainKHR(device.device(), swapChain, device.getAllocator());
     swapChain = nullptr;
   }
 
   for (int i = 0; i < depthImages.size(); i++) {
-    vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-    vkDestroyImage(device.device(), depthImages[i], nullptr);
-    vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+    vkDestroyImageView(device.device(), depthImageViews[i], device.getAllocator());
+    vkDestroyImage(device.device(), depthImages[i], device.getAllocator());
+    vkFreeMemory(device.device(), depthImageMemorys[i], device.getAllocator());
   }
 
   for (auto framebuffer : swapChainFramebuffers) {
-    vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
+    vkDestroyFramebuffer(device.device(), framebuffer, device.getAllocator());
   }
 
-  vkDestroyRenderPass(device.device(), renderPass, nullptr);
+  if (renderPass != VK_NULL_HANDLE) {
+    vkDestroyRenderPass(device.device(), renderPass, device.getAllocator());
+  }
 
   // cleanup synchronization objects
   for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
-    vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-    vkDestroyFence(device.device(), inFlightFences[i], nullptr);
+    vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], device.getAllocator());
+    vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], device.getAllocator());
+    vkDestroyFence(device.device(), inFlightFences[i], device.getAllocator());
   }
 }
 
+void LveSwapChain::consumeImageAvailableSemaphore() {
+  acquireRequested = false;
+  // A failed acquire leaves the semaphore unsignaled
+  if (acquireTicket.result != VK_SUCCESS && acquireTicket.result != VK_SUBOPTIMAL_KHR) {
+    return;
+  }
+
+  // vkDeviceWaitIdle does not cover acquire signals, so an empty submit waits on the semaphore
+  // and its fence tells when the semaphore can be destroyed
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  VkFence fence;
+  if (vkCreateFence(device.device(), &fenceInfo, device.getAllocator(), &fence) != VK_SUCCESS) {
+    return;
+  }
+
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.pWaitSemaphores = &imageAvailableSemaphores[currentFrame];
+  submitInfo.pWaitDstStageMask = &waitStage;
+  if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, fence) == VK_SUCCESS) {
+    vkWaitForFences(device.device(), 1, &fence, VK_TRUE, UINT64_MAX);
+  }
+  vkDestroyFence(device.device(), fence, device.getAllocator());
+}
+
 VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex) {
   vkWaitForFences(
       device.device(),
@@ -59,6 +100,19 @@ VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex) {
       &inFlightFences[currentFrame],
       VK_TRUE,
       std::numeric_limits<uint64_t>::max());
+  // Everything up to the frame that last used this slot has now finished
+  device.retireFrames(slotFrameNumbers[currentFrame]);
+
+  if (LveSubmitThread *submitThread = device.getSubmitThread()) {
+    if (!acquireRequested) {
+      submitThread->acquire(
+          {swapChain, VK_NULL_HANDLE, imageAvailableSemaphores[currentFrame], &acquireTicket});
+    }
+    acquireRequested = false;
+    submitThread->wait(acquireTicket);
+    *imageIndex = acquireTicket.imageIndex;
+    return acquireTicket.result;
+  }
 
   VkResult result = vkAcquireNextImageKHR(
       device.device(),
@@ -95,10 +149,37 @@ VkResult LveSwapChain::submitCommandBuffers(
   submitInfo.pSignalSemaphores = signalSemaphores;
 
   vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-  if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
+  LveSubmitThread *submitThread = device.getSubmitThread();
+  if (submitThread) {
+    submitThread->submit(
+        {device.graphicsQueue(),
+         *buffers,
+         waitSemaphores[0],
+         waitStages[0],
+         signalSemaphores[0],
+         inFlightFences[currentFrame]});
+  } else if (
+      vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
       VK_SUCCESS) {
     throw std::runtime_error("failed to submit draw command buffer!");
   }
+  slotFrameNumbers[currentFrame] = device.currentFrameNumber();
+  device.advanceFrame();
+
+  if (submitThread) {
+    submitThread->present({device.presentQueue(), swapChain, *imageIndex, signalSemaphores[0]});
+    // Acquiring next frame's image right behind the present keeps a blocking acquire off this
+    // thread too. Its semaphore is free once the frame that last waited on it has finished.
+    size_t nextFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    submitThread->acquire(
+        {swapChain,
+         inFlightFences[nextFrame],
+         imageAvailableSemaphores[nextFrame],
+         &acquireTicket});
+    acquireRequested = true;
+    currentFrame = nextFrame;
+    return submitThread->getPresentResult();
+  }
 
   VkPresentInfoKHR presentInfo = {};
   presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -141,7 +222,10 @@ void LveSwapChain::createSwapChain() {
   createInfo.imageColorSpace = surfaceFormat.colorSpace;
   createInfo.imageExtent = extent;
   createInfo.imageArrayLayers = 1;
-  createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  // Transfer source when available so finished frames can be read back
+  imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+               (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+  createInfo.imageUsage = imageUsage;
 
   QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
   uint32_t queueFamilyIndices[] = {indices.graphicsFamily, indices.presentFamily};
@@ -164,7 +248,7 @@ void LveSwapChain::createSwapChain() {
 
   createInfo.oldSwapchain = VK_NULL_HANDLE;
 
-  if (vkCreateSwapchainKHR(device.device(), &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+  if (vkCreateSwapchainKHR(device.device(), &createInfo, device.getAllocator(), &swapChain) != VK_SUCCESS) {
     throw std::runtime_error("failed to create swap chain!");
   }
 
@@ -194,7 +278,7 @@ void LveSwapChain::createImageViews() {
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
-    if (vkCreateImageView(device.device(), &viewInfo, nullptr, &swapChainImageViews[i]) !=
+    if (vkCreateImageView(device.device(), &viewInfo, device.getAllocator(), &swapChainImageViews[i]) !=
         VK_SUCCESS) {
       throw std::runtime_error("failed to create texture image view!");
     }
@@ -257,7 +341,7 @@ void LveSwapChain::createRenderPass() {
   renderPassInfo.dependencyCount = 1;
   renderPassInfo.pDependencies = &dependency;
 
-  if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+  if (vkCreateRenderPass(device.device(), &renderPassInfo, device.getAllocator(), &renderPass) != VK_SUCCESS) {
     throw std::runtime_error("failed to create render pass!");
   }
 }
@@ -280,7 +364,7 @@ void LveSwapChain::createFramebuffers() {
     if (vkCreateFramebuffer(
             device.device(),
             &framebufferInfo,
-            nullptr,
+            device.getAllocator(),
             &swapChainFramebuffers[i]) != VK_SUCCESS) {
       throw std::runtime_error("failed to create framebuffer!");
     }
@@ -329,7 +413,7 @@ void LveSwapChain::createDepthResources() {
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
-    if (vkCreateImageView(device.device(), &viewInfo, nullptr, &depthImageViews[i]) != VK_SUCCESS) {
+    if (vkCreateImageView(device.device(), &viewInfo, device.getAllocator(), &depthImageViews[i]) != VK_SUCCESS) {
       throw std::runtime_error("failed to create texture image view!");
     }
   }
@@ -339,6 +423,7 @@ void LveSwapChain::createSyncObjects() {
   imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
   renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
   inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+  slotFrameNumbers.resize(MAX_FRAMES_IN_FLIGHT, 0);
   imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
 
   VkSemaphoreCreateInfo semaphoreInfo = {};
@@ -349,11 +434,11 @@ void LveSwapChain::createSyncObjects() {
   fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
   for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
+    if (vkCreateSemaphore(device.device(), &semaphoreInfo, device.getAllocator(), &imageAvailableSemaphores[i]) !=
             VK_SUCCESS ||
-        vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) !=
+        vkCreateSemaphore(device.device(), &semaphoreInfo, device.getAllocator(), &renderFinishedSemaphores[i]) !=
             VK_SUCCESS ||
-        vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+        vkCreateFence(device.device(), &fenceInfo, device.getAllocator(), &inFlightFences[i]) != VK_SUCCESS) {
       throw std::runtime_error("failed to create synchronization objects for a frame!");
     }
   }
@@ -407,7 +492,7 @@ VkExtent2D LveSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabi
   }
 }
 
-VkFormat LveSwapChain::findDepthFormat() {
+VkFormat LveSwapChain::findDepthFormat(LveDevice &device) {
   return device.findSupportedFormat(
       {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
       VK_IMAGE_TILING_OPTIMAL,
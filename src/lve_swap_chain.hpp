@@ -15,16 +15,25 @@ class LveSwapChain {
  public:
   static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
-  LveSwapChain(LveDevice &deviceRef, VkExtent2D windowExtent);
+  // With dynamicRendering no render pass, framebuffers or depth images are created; the
+  // caller renders straight into the image views with vkCmdBeginRenderingKHR
+  LveSwapChain(LveDevice &deviceRef, VkExtent2D windowExtent, bool dynamicRendering = false);
   ~LveSwapChain();
 
   LveSwapChain(const LveSwapChain &) = delete;
   void operator=(const LveSwapChain &) = delete;
 
   VkFramebuffer getFrameBuffer(int index) { return swapChainFramebuffers[index]; }
+  // VK_NULL_HANDLE when using dynamic rendering
   VkRenderPass getRenderPass() { return renderPass; }
+  bool usesDynamicRendering() { return dynamicRendering; }
+  // Whether images can be copied from, e.g. for frame readback
+  bool supportsTransferSource() { return (imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0; }
+  VkImage getImage(int index) { return swapChainImages[index]; }
   VkImageView getImageView(int index) { return swapChainImageViews[index]; }
   size_t imageCount() { return swapChainImages.size(); }
+  // Frame-in-flight slot used by the next acquire/submit pair
+  size_t getCurrentFrameIndex() { return currentFrame; }
   VkFormat getSwapChainImageFormat() { return swapChainImageFormat; }
   VkExtent2D getSwapChainExtent() { return swapChainExtent; }
   uint32_t width() { return swapChainExtent.width; }
@@ -33,8 +42,16 @@ class LveSwapChain {
   float extentAspectRatio() {
     return static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height);
   }
-  VkFormat findDepthFormat();
+  VkFormat findDepthFormat() { return findDepthFormat(device); }
 
+  // Also usable before a swap chain exists, e.g. to build pipelines for dynamic rendering
+  static VkSurfaceFormatKHR chooseSwapSurfaceFormat(
+      const std::vector<VkSurfaceFormatKHR> &availableFormats);
+  static VkFormat findDepthFormat(LveDevice &device);
+
+  // With the device's submit thread the image is acquired on that thread right after the
+  // previous present, and submitCommandBuffers returns without waiting for the present. Its
+  // result is then that of an earlier frame's present.
   VkResult acquireNextImage(uint32_t *imageIndex);
   VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
 
@@ -45,19 +62,21 @@ class LveSwapChain {
   void createRenderPass();
   void createFramebuffers();
   void createSyncObjects();
+  // Waits for the signal of an acquire no frame will consume so its semaphore can be destroyed
+  void consumeImageAvailableSemaphore();
 
   // Helper functions
-  VkSurfaceFormatKHR chooseSwapSurfaceFormat(
-      const std::vector<VkSurfaceFormatKHR> &availableFormats);
   VkPresentModeKHR chooseSwapPresentMode(
       const std::vector<VkPresentModeKHR> &availablePresentModes);
   VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
 
   VkFormat swapChainImageFormat;
+  VkImageUsageFlags imageUsage = 0;
   VkExtent2D swapChainExtent;
 
+  bool dynamicRendering;
   std::vector<VkFramebuffer> swapChainFramebuffers;
-  VkRenderPass renderPass;
+  VkRenderPass renderPass = VK_NULL_HANDLE;
 
   std::vector<VkImage> depthImages;
   std::vector<VkDeviceMemory> depthImageMemorys;
@@ -74,7 +93,13 @@ class LveSwapChain {
   std::vector<VkSemaphore> renderFinishedSemaphores;
   std::vector<VkFence> inFlightFences;
   std::vector<VkFence> imagesInFlight;
+  // Device frame number last submitted on each frame-in-flight slot
+  std::vector<uint64_t> slotFrameNumbers;
   size_t currentFrame = 0;
+
+  // Acquire for currentFrame already pushed to the submit thread
+  LveSubmitThread::AcquireTicket acquireTicket;
+  bool acquireRequested = false;
 };
 
 }  // namespace lve
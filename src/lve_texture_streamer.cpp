@@ -0,0 +1,689 @@
+#include "lve_texture_streamer.hpp"
+
+#include "lve_block_decoder.hpp"
+#include "lve_mapped_file.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    namespace {
+        // PNG and PPM images are sRGB, filtered in linear space by both the blits and the sampler
+        constexpr VkFormat IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+        bool isRgba8(VkFormat format) {
+            return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+        }
+
+        // The finest level whose larger side is at most coarseSize
+        uint32_t sizeCoarseLevel(uint32_t width, uint32_t height, uint32_t coarseSize) {
+            uint32_t level = 0;
+            while (std::max(width, height) >> level > coarseSize) {
+                level++;
+            }
+            return level;
+        }
+
+        VkImageMemoryBarrier imageBarrier(
+            VkImage image,
+            uint32_t baseLevel,
+            uint32_t levelCount,
+            VkImageLayout oldLayout,
+            VkImageLayout newLayout,
+            VkAccessFlags srcAccess,
+            VkAccessFlags dstAccess) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = newLayout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = image;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = baseLevel;
+            barrier.subresourceRange.levelCount = levelCount;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            return barrier;
+        }
+
+        void recordBarrier(
+            VkCommandBuffer commandBuffer,
+            VkPipelineStageFlags srcStage,
+            VkPipelineStageFlags dstStage,
+            const VkImageMemoryBarrier &barrier) {
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+    }
+
+    LveTextureStreamer::LveTextureStreamer(
+        LveDevice &device,
+        LveJobSystem &jobSystem,
+        LveBindlessHeap &bindlessHeap,
+        uint32_t slotCount,
+        VkDeviceSize budgetBytes)
+        : lveDevice{device},
+          jobSystem{jobSystem},
+          bindlessHeap{bindlessHeap},
+          budgetBytes{budgetBytes},
+          stagingRing{device, STAGING_SIZE, slotCount} {
+        const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        for (VkFormat format : {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB}) {
+            if (!lveDevice.supportsFormat(format, VK_IMAGE_TILING_OPTIMAL, required)) {
+                throw std::runtime_error("RGBA8 textures cannot be blitted and filtered on this device");
+            }
+        }
+        // Buffer offsets of copies must also be multiples of 4
+        copyAlignment = std::max<VkDeviceSize>(4, lveDevice.properties.limits.optimalBufferCopyOffsetAlignment);
+
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.anisotropyEnable = VK_TRUE;
+        samplerInfo.maxAnisotropy = lveDevice.properties.limits.maxSamplerAnisotropy;
+        samplerInfo.minLod = 0.0f;
+        // Images only hold their resident levels, so no clamp is needed
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(lveDevice.device(), &samplerInfo, lveDevice.getAllocator(), &sampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create texture sampler");
+        }
+    }
+
+    LveTextureStreamer::~LveTextureStreamer() {
+        // Decode jobs write into this object, and catch everything they could throw
+        jobSystem.wait(decodeJobs);
+        for (auto &texture : textures) {
+            if (texture.bindlessIndex != NOT_RESIDENT) {
+                bindlessHeap.releaseImage(texture.bindlessIndex);
+            }
+            destroyResidency(texture.resident);
+            destroyResidency(texture.pending);
+        }
+        VkDevice device = lveDevice.device();
+        const VkAllocationCallbacks *allocator = lveDevice.getAllocator();
+        VkSampler retiredSampler = sampler;
+        lveDevice.deferDestroy([device, allocator, retiredSampler]() {
+            vkDestroySampler(device, retiredSampler, allocator);
+        });
+    }
+
+    LveTextureStreamer::TextureId LveTextureStreamer::load(const std::string &path) {
+        const TextureId id = static_cast<TextureId>(textures.size());
+        textures.emplace_back();
+        textures.back().path = path;
+        startDecode(id);
+        return id;
+    }
+
+    uint32_t LveTextureStreamer::use(TextureId id) {
+        Texture &texture = textures[id];
+        texture.lastUsed = frame;
+        return texture.bindlessIndex;
+    }
+
+    VkExtent2D LveTextureStreamer::getExtent(TextureId id) const {
+        return {textures[id].width, textures[id].height};
+    }
+
+    void LveTextureStreamer::startDecode(TextureId id) {
+        Texture &texture = textures[id];
+        texture.decoding = true;
+        decodeCount++;
+        jobSystem.run([this, id, path = texture.path]() {
+            DecodedTexture result{};
+            try {
+                result = decodeFile(path);
+            } catch (const std::exception &error) {
+                result.error = error.what();
+            }
+            result.id = id;
+            std::lock_guard<std::mutex> lock{decodedMutex};
+            decoded.push_back(std::move(result));
+        }, &decodeJobs);
+    }
+
+    LveTextureStreamer::DecodedTexture LveTextureStreamer::decodeFile(const std::string &path) {
+        DecodedTexture result{};
+        LveMappedFile file{path};
+        std::vector<LveImage> images;
+        if (isKtx2(file.data(), file.size())) {
+            LveKtx2Image ktx2 = parseKtx2(file.data(), file.size());
+            result.width = ktx2.width;
+            result.height = ktx2.height;
+            const VkFormatFeatureFlags sampled =
+                VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+            if (!isRgba8(ktx2.format) && lveDevice.supportsFormat(ktx2.format, VK_IMAGE_TILING_OPTIMAL, sampled)) {
+                // Uploaded as stored; the device cannot blit compressed levels, so the file's are all there is
+                result.format = ktx2.format;
+                result.levelCount = static_cast<uint32_t>(ktx2.levels.size());
+                result.levels = std::make_shared<const Levels>(std::move(ktx2.levels));
+                return result;
+            }
+            if (!isRgba8(ktx2.format) && !canDecodeBlocks(ktx2.format)) {
+                throw std::runtime_error(
+                    "KTX2 format " + std::to_string(ktx2.format) + " is not supported by the device or the CPU decoder");
+            }
+
+            // Stored levels are used down to the coarse one, then halved as for other images
+            const uint32_t coarse = sizeCoarseLevel(ktx2.width, ktx2.height, COARSE_SIZE);
+            for (uint32_t level = 0; level < ktx2.levels.size() && level <= coarse; level++) {
+                const uint32_t width = std::max(ktx2.width >> level, 1u);
+                const uint32_t height = std::max(ktx2.height >> level, 1u);
+                if (isRgba8(ktx2.format)) {
+                    images.push_back({width, height, std::move(ktx2.levels[level])});
+                } else {
+                    images.push_back(decodeBlocks(ktx2.format, ktx2.levels[level].data(), width, height, jobSystem));
+                }
+            }
+            result.format = isSrgbFormat(ktx2.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+            result.transcoded = !isRgba8(ktx2.format);
+        } else {
+            images.push_back(decodeImage(file.data(), file.size()));
+            result.width = images.front().width;
+            result.height = images.front().height;
+            result.format = IMAGE_FORMAT;
+        }
+
+        // Only the levels uploaded from the CPU are built here; the GPU blits the coarser ones
+        while (std::max(images.back().width, images.back().height) > COARSE_SIZE) {
+            images.push_back(halveImage(images.back()));
+        }
+        result.levelCount = 1;
+        while (std::max(result.width, result.height) >> result.levelCount) {
+            result.levelCount++;
+        }
+        auto levels = std::make_shared<Levels>();
+        for (auto &image : images) {
+            levels->push_back(std::move(image.rgba));
+        }
+        result.levels = std::move(levels);
+        return result;
+    }
+
+    void LveTextureStreamer::takeDecoded() {
+        std::vector<DecodedTexture> ready;
+        {
+            std::lock_guard<std::mutex> lock{decodedMutex};
+            ready.swap(decoded);
+        }
+        for (auto &result : ready) {
+            Texture &texture = textures[result.id];
+            texture.decoding = false;
+            if (!result.levels) {
+                texture.failed = true;
+                std::fprintf(stderr, "texture %s: %s\n", texture.path.c_str(), result.error.c_str());
+                continue;
+            }
+            texture.format = result.format;
+            texture.block = getTexelBlock(result.format);
+            texture.width = result.width;
+            texture.height = result.height;
+            texture.levelCount = result.levelCount;
+            texture.coarseLevel = std::min(
+                sizeCoarseLevel(texture.width, texture.height, COARSE_SIZE), texture.levelCount - 1);
+            texture.levels = std::move(result.levels);
+            texture.transcoded = result.transcoded;
+        }
+    }
+
+    VkExtent2D LveTextureStreamer::levelExtent(const Texture &texture, uint32_t level) const {
+        return {std::max(texture.width >> level, 1u), std::max(texture.height >> level, 1u)};
+    }
+
+    VkDeviceSize LveTextureStreamer::chainBytes(const Texture &texture, uint32_t topLevel) const {
+        VkDeviceSize bytes = 0;
+        for (uint32_t level = topLevel; level < texture.levelCount; level++) {
+            VkExtent2D extent = levelExtent(texture, level);
+            bytes += getLevelBytes(texture.format, extent.width, extent.height);
+        }
+        return bytes;
+    }
+
+    LveTextureStreamer::Residency LveTextureStreamer::createResidency(const Texture &texture, uint32_t topLevel) {
+        Residency residency{};
+        residency.topLevel = topLevel;
+        residency.levelCount = texture.levelCount - topLevel;
+        residency.bytes = chainBytes(texture, topLevel);
+        const VkExtent2D extent = levelExtent(texture, topLevel);
+        const uint32_t levelCount = residency.levelCount;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = texture.format;
+        imageInfo.extent = {extent.width, extent.height, 1};
+        imageInfo.mipLevels = levelCount;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, residency.image, residency.memory);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = residency.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = texture.format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = levelCount;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(lveDevice.device(), &viewInfo, lveDevice.getAllocator(), &residency.view) != VK_SUCCESS) {
+            vkDestroyImage(lveDevice.device(), residency.image, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), residency.memory, lveDevice.getAllocator());
+            throw std::runtime_error("Failed to create texture image view");
+        }
+        residentBytes += residency.bytes;
+        return residency;
+    }
+
+    void LveTextureStreamer::destroyResidency(Residency &residency) {
+        if (residency.image == VK_NULL_HANDLE) {
+            return;
+        }
+        lveDevice.deferDestroyImage(residency.image, residency.view, residency.memory);
+        residentBytes -= residency.bytes;
+        residency = {};
+    }
+
+    bool LveTextureStreamer::uploadRows(VkCommandBuffer commandBuffer, Texture &texture, VkDeviceSize &uploadBudget) {
+        Residency &pending = texture.pending;
+        const LveTexelBlock &block = texture.block;
+        // Compressed copies start on a whole block
+        const VkDeviceSize alignment = std::max<VkDeviceSize>(copyAlignment, block.bytes);
+        while (pending.levelsUploaded < pending.uploadLevels) {
+            const uint32_t level = pending.topLevel + pending.levelsUploaded;
+            const std::vector<uint8_t> &source = (*texture.levels)[level];
+            const VkExtent2D extent = levelExtent(texture, level);
+            const uint32_t blockRows = (extent.height + block.height - 1) / block.height;
+            const VkDeviceSize rowBytes = VkDeviceSize{(extent.width + block.width - 1) / block.width} * block.bytes;
+
+            // At least one row per frame, so a level wider than the budget still makes progress
+            uint32_t rows = blockRows - pending.rowsUploaded;
+            if (uploadBudget < rowBytes * rows) {
+                const VkDeviceSize budgetRows = uploadBudget == UPLOAD_BYTES_PER_FRAME ? 1 : 0;
+                rows = static_cast<uint32_t>(std::max(uploadBudget / rowBytes, budgetRows));
+            }
+            VkDeviceSize offset = 0;
+            while (rows > 0 && !stagingRing.allocate(rowBytes * rows, alignment, offset)) {
+                rows /= 2;
+            }
+            if (rows == 0) {
+                uploadBudget = 0;
+                return false;
+            }
+
+            const VkDeviceSize bytes = rowBytes * rows;
+            std::memcpy(stagingRing.getMapped() + offset, source.data() + rowBytes * pending.rowsUploaded, bytes);
+
+            // The last block row may reach past the level's edge
+            const uint32_t firstRow = pending.rowsUploaded * block.height;
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = pending.levelsUploaded;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, static_cast<int32_t>(firstRow), 0};
+            region.imageExtent = {extent.width, std::min(rows * block.height, extent.height - firstRow), 1};
+            vkCmdCopyBufferToImage(
+                commandBuffer,
+                stagingRing.getBuffer(),
+                pending.image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &region);
+
+            pending.rowsUploaded += rows;
+            uploadBudget -= std::min(uploadBudget, bytes);
+            uploadedBytes += bytes;
+            if (pending.rowsUploaded < blockRows) {
+                return false;
+            }
+            pending.levelsUploaded++;
+            pending.rowsUploaded = 0;
+        }
+        return true;
+    }
+
+    void LveTextureStreamer::copyLevels(
+        VkCommandBuffer commandBuffer,
+        const Texture &texture,
+        const Residency &source,
+        const Residency &destination) {
+        // Earlier frames sampled the source in fragment shaders
+        const uint32_t topLevel = std::max(source.topLevel, destination.topLevel);
+        const uint32_t levelCount = texture.levelCount - topLevel;
+        recordBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            imageBarrier(
+                source.image,
+                topLevel - source.topLevel,
+                levelCount,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                0,
+                VK_ACCESS_TRANSFER_READ_BIT));
+
+        std::vector<VkImageCopy> copies(levelCount);
+        for (uint32_t level = 0; level < levelCount; level++) {
+            VkExtent2D extent = levelExtent(texture, topLevel + level);
+            copies[level].srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, topLevel - source.topLevel + level, 0, 1};
+            copies[level].dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, topLevel - destination.topLevel + level, 0, 1};
+            copies[level].extent = {extent.width, extent.height, 1};
+        }
+        vkCmdCopyImage(
+            commandBuffer,
+            source.image,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            destination.image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(copies.size()),
+            copies.data());
+    }
+
+    void LveTextureStreamer::recordMipChain(
+        VkCommandBuffer commandBuffer,
+        const Residency &residency,
+        uint32_t filledLevels,
+        VkExtent2D extent) {
+        if (filledLevels > 1) {
+            recordBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                imageBarrier(
+                    residency.image,
+                    0,
+                    filledLevels - 1,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_ACCESS_SHADER_READ_BIT));
+        }
+
+        // Each level is read once, by the blit into the next one, then handed to the fragment shader
+        int32_t width = static_cast<int32_t>(extent.width);
+        int32_t height = static_cast<int32_t>(extent.height);
+        for (uint32_t level = filledLevels; level < residency.levelCount; level++) {
+            recordBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                imageBarrier(
+                    residency.image,
+                    level - 1,
+                    1,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_ACCESS_TRANSFER_READ_BIT));
+
+            const int32_t nextWidth = std::max(width / 2, 1);
+            const int32_t nextHeight = std::max(height / 2, 1);
+            VkImageBlit blit{};
+            blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+            blit.srcOffsets[1] = {width, height, 1};
+            blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+            vkCmdBlitImage(
+                commandBuffer,
+                residency.image,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                residency.image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &blit,
+                VK_FILTER_LINEAR);
+
+            recordBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                imageBarrier(
+                    residency.image,
+                    level - 1,
+                    1,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_ACCESS_SHADER_READ_BIT));
+            width = nextWidth;
+            height = nextHeight;
+        }
+        recordBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            imageBarrier(
+                residency.image,
+                residency.levelCount - 1,
+                1,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_ACCESS_SHADER_READ_BIT));
+    }
+
+    void LveTextureStreamer::finishUpload(VkCommandBuffer commandBuffer, Texture &texture) {
+        // A promotion only uploads its new top level; the levels below are the resident image's
+        Residency &pending = texture.pending;
+        uint32_t filledLevels = pending.uploadLevels;
+        if (texture.resident.image != VK_NULL_HANDLE) {
+            copyLevels(commandBuffer, texture, texture.resident, pending);
+            filledLevels += texture.resident.levelCount;
+        }
+        recordMipChain(
+            commandBuffer, pending, filledLevels, levelExtent(texture, pending.topLevel + filledLevels - 1));
+        makeResident(texture, pending);
+        promotions++;
+    }
+
+    void LveTextureStreamer::makeResident(Texture &texture, Residency &residency) {
+        // Frames already recorded keep the old index and image until they retire
+        if (texture.bindlessIndex != NOT_RESIDENT) {
+            bindlessHeap.releaseImage(texture.bindlessIndex);
+        }
+        destroyResidency(texture.resident);
+        texture.resident = residency;
+        residency = {};
+        texture.bindlessIndex = bindlessHeap.registerImage(texture.resident.view, sampler);
+        if (texture.resident.topLevel == 0) {
+            texture.levels.reset();
+        }
+    }
+
+    void LveTextureStreamer::demote(VkCommandBuffer commandBuffer, Texture &texture) {
+        Residency &old = texture.resident;
+        Residency coarser = createResidency(texture, old.topLevel + 1);
+
+        // The old image's levels 1.. are exactly the new image's levels, so they are copied
+        // rather than filtered again
+        recordBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            imageBarrier(
+                coarser.image,
+                0,
+                coarser.levelCount,
+                VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                0,
+                VK_ACCESS_TRANSFER_WRITE_BIT));
+        copyLevels(commandBuffer, texture, old, coarser);
+
+        recordBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            imageBarrier(
+                coarser.image,
+                0,
+                coarser.levelCount,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_ACCESS_SHADER_READ_BIT));
+        makeResident(texture, coarser);
+        demotions++;
+    }
+
+    bool LveTextureStreamer::reserve(VkCommandBuffer commandBuffer, VkDeviceSize bytes, TextureId keep) {
+        const uint64_t keepUsed = textures[keep].lastUsed;
+        while (residentBytes + bytes > budgetBytes) {
+            // Least recently used first, and among those the one holding the finest level.
+            // Textures never drop below their coarse level, so they stay visible.
+            Texture *victim = nullptr;
+            for (auto &texture : textures) {
+                if (texture.resident.image == VK_NULL_HANDLE || texture.pending.image != VK_NULL_HANDLE ||
+                    texture.lastUsed >= keepUsed || texture.resident.topLevel >= texture.coarseLevel) {
+                    continue;
+                }
+                if (!victim || texture.lastUsed < victim->lastUsed ||
+                    (texture.lastUsed == victim->lastUsed && texture.resident.topLevel < victim->resident.topLevel)) {
+                    victim = &texture;
+                }
+            }
+            if (!victim) {
+                return false;
+            }
+            demote(commandBuffer, *victim);
+        }
+        return true;
+    }
+
+    void LveTextureStreamer::update(VkCommandBuffer commandBuffer, uint32_t slot) {
+        stagingRing.beginFrame(slot);
+        frame++;
+        takeDecoded();
+
+        // Uploads already under way finish first, so their images stop counting against the
+        // budget without being shown
+        VkDeviceSize uploadBudget = UPLOAD_BYTES_PER_FRAME;
+        for (auto &texture : textures) {
+            if (texture.pending.image == VK_NULL_HANDLE || uploadBudget == 0) {
+                continue;
+            }
+            if (uploadRows(commandBuffer, texture, uploadBudget)) {
+                finishUpload(commandBuffer, texture);
+            }
+        }
+
+        // Textures not shown yet come first, then the coarsest resident ones, so everything
+        // sharpens together; only textures drawn last frame are promoted past the coarse level
+        std::vector<TextureId> candidates;
+        for (TextureId id = 0; id < textures.size(); id++) {
+            const Texture &texture = textures[id];
+            if (texture.failed || texture.pending.image != VK_NULL_HANDLE) {
+                continue;
+            }
+            const bool shown = texture.resident.image != VK_NULL_HANDLE;
+            if (!shown || (texture.resident.topLevel > 0 && texture.lastUsed + 1 >= frame)) {
+                candidates.push_back(id);
+            }
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [this](TextureId a, TextureId b) {
+            const Residency &x = textures[a].resident;
+            const Residency &y = textures[b].resident;
+            const uint32_t xTop = x.image != VK_NULL_HANDLE ? x.topLevel : UINT32_MAX;
+            const uint32_t yTop = y.image != VK_NULL_HANDLE ? y.topLevel : UINT32_MAX;
+            return xTop > yTop;
+        });
+
+        uint32_t stalled = 0;
+        for (TextureId id : candidates) {
+            if (uploadBudget == 0) {
+                break;
+            }
+            Texture &texture = textures[id];
+            if (!texture.levels) {
+                // Evicted after level 0 was shown once, so the file is decoded again
+                if (!texture.decoding) {
+                    startDecode(id);
+                }
+                continue;
+            }
+            const bool promotion = texture.resident.image != VK_NULL_HANDLE;
+            const uint32_t topLevel = promotion ? texture.resident.topLevel - 1 : texture.coarseLevel;
+            if (!reserve(commandBuffer, chainBytes(texture, topLevel), id)) {
+                budgetStalls++;
+                stalled++;
+                continue;
+            }
+
+            texture.pending = createResidency(texture, topLevel);
+            const uint32_t cpuLevels = std::min(static_cast<uint32_t>(texture.levels->size()), texture.levelCount);
+            texture.pending.uploadLevels = promotion ? 1 : cpuLevels - topLevel;
+            recordBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                imageBarrier(
+                    texture.pending.image,
+                    0,
+                    texture.pending.levelCount,
+                    VK_IMAGE_LAYOUT_UNDEFINED,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    0,
+                    VK_ACCESS_TRANSFER_WRITE_BIT));
+            if (uploadRows(commandBuffer, texture, uploadBudget)) {
+                finishUpload(commandBuffer, texture);
+            }
+        }
+
+        // Candidates held back only by the budget wait for other textures to go unused
+        streaming = candidates.size() > stalled;
+        for (const auto &texture : textures) {
+            streaming = streaming || texture.decoding || texture.pending.image != VK_NULL_HANDLE;
+        }
+    }
+
+    void LveTextureStreamer::printReport() {
+        uint32_t full = 0;
+        uint32_t shown = 0;
+        uint32_t compressed = 0;
+        uint32_t transcoded = 0;
+        for (const auto &texture : textures) {
+            shown += texture.resident.image != VK_NULL_HANDLE ? 1 : 0;
+            full += texture.resident.image != VK_NULL_HANDLE && texture.resident.topLevel == 0 ? 1 : 0;
+            compressed += texture.block.width > 1 ? 1 : 0;
+            transcoded += texture.transcoded ? 1 : 0;
+        }
+        std::printf("textures: %zu loaded, %u shown, %u at full resolution, %u compressed, %u transcoded, "
+                    "%.1f of %.1f MB resident, %.1f MB uploaded, %llu decodes, %llu promotions, %llu demotions, "
+                    "%llu budget stalls\n",
+            textures.size(),
+            shown,
+            full,
+            compressed,
+            transcoded,
+            residentBytes / 1048576.0,
+            budgetBytes / 1048576.0,
+            uploadedBytes / 1048576.0,
+            static_cast<unsigned long long>(decodeCount),
+            static_cast<unsigned long long>(promotions),
+            static_cast<unsigned long long>(demotions),
+            static_cast<unsigned long long>(budgetStalls));
+    }
+}
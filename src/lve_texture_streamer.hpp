@@ -0,0 +1,184 @@
+#pragma once
+
+#include "lve_bindless_heap.hpp"
+#include "lve_device.hpp"
+#include "lve_image_decoder.hpp"
+#include "lve_job_system.hpp"
+#include "lve_ktx2.hpp"
+#include "lve_staging_ring.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Streams textures in without the render loop ever waiting. Files are decoded on job system
+    // workers; update() then uploads through a staging ring inside the frame's own command
+    // buffer and generates the mip chain below the uploaded level with vkCmdBlitImage.
+    //
+    // KTX2 files in a block-compressed format the device samples are uploaded as stored, with
+    // the levels the file holds. Other BC and ETC2 files are transcoded to RGBA8 on the workers
+    // and then handled like PNG and PPM images.
+    //
+    // A texture first becomes visible at a coarse level and is promoted one level finer per
+    // frame while it is being used. Each residency change builds a new image holding levels
+    // [topLevel, levelCount) of the full chain and registers it in the bindless heap, so the
+    // index returned by use() can change from frame to frame. When promoting would exceed the
+    // memory budget, the least recently used textures drop their finest level instead.
+    class LveTextureStreamer {
+        public:
+            using TextureId = uint32_t;
+            // Returned by use() until the first level is resident
+            static constexpr uint32_t NOT_RESIDENT = UINT32_MAX;
+            // First level shown: the finest whose larger side is at most this
+            static constexpr uint32_t COARSE_SIZE = 64;
+            static constexpr VkDeviceSize STAGING_SIZE = VkDeviceSize{64} << 20;
+            static constexpr VkDeviceSize UPLOAD_BYTES_PER_FRAME = VkDeviceSize{16} << 20;
+
+            LveTextureStreamer(
+                LveDevice &device,
+                LveJobSystem &jobSystem,
+                LveBindlessHeap &bindlessHeap,
+                uint32_t slotCount,
+                VkDeviceSize budgetBytes);
+            // Waits for decodes still running
+            ~LveTextureStreamer();
+
+            LveTextureStreamer(const LveTextureStreamer &) = delete;
+            LveTextureStreamer &operator=(const LveTextureStreamer &) = delete;
+
+            // Starts decoding on a worker and returns at once
+            TextureId load(const std::string &path);
+
+            // Marks the texture as drawn this frame and returns its bindless image index, or
+            // NOT_RESIDENT. Call after update() for the frame being recorded.
+            uint32_t use(TextureId id);
+            // Full-resolution size, 0 x 0 until decoded
+            VkExtent2D getExtent(TextureId id) const;
+
+            // Must be recorded outside of a render pass, before any draw that samples the
+            // textures, once the slot's fence has signalled
+            void update(VkCommandBuffer commandBuffer, uint32_t slot);
+
+            // True while the last update() left decodes, uploads or promotions to do, so on-demand
+            // drawing knows to keep going
+            bool isStreaming() const { return streaming; }
+            VkDeviceSize getResidentBytes() const { return residentBytes; }
+            void printReport();
+
+        private:
+            // One residency of a texture: levels [topLevel, levelCount) of the full chain
+            struct Residency {
+                VkImage image = VK_NULL_HANDLE;
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                VkImageView view = VK_NULL_HANDLE;
+                uint32_t topLevel = 0;
+                uint32_t levelCount = 0;
+                VkDeviceSize bytes = 0;
+                // Leading levels copied from the CPU; the rest come from the previous image or blits
+                uint32_t uploadLevels = 0;
+                // Progress of the upload, which may be spread over several frames
+                uint32_t levelsUploaded = 0;
+                uint32_t rowsUploaded = 0;
+            };
+
+            // Levels as uploaded: tightly packed rows of texel blocks, level 0 first
+            using Levels = std::vector<std::vector<uint8_t>>;
+
+            struct Texture {
+                std::string path;
+                VkFormat format = VK_FORMAT_UNDEFINED;
+                LveTexelBlock block{};
+                uint32_t width = 0;
+                uint32_t height = 0;
+                // Levels of the image chain; fewer than a full chain for compressed files
+                uint32_t levelCount = 0;
+                // First level shown
+                uint32_t coarseLevel = 0;
+                // Every level of compressed files, levels 0 up to the coarse level of RGBA8 ones;
+                // dropped once level 0 is resident
+                std::shared_ptr<const Levels> levels;
+                bool transcoded = false;
+                bool decoding = false;
+                bool failed = false;
+
+                Residency resident;
+                // Being uploaded; replaces resident once complete
+                Residency pending;
+                uint32_t bindlessIndex = NOT_RESIDENT;
+                uint64_t lastUsed = 0;
+            };
+
+            struct DecodedTexture {
+                TextureId id = 0;
+                VkFormat format = VK_FORMAT_UNDEFINED;
+                uint32_t width = 0;
+                uint32_t height = 0;
+                uint32_t levelCount = 0;
+                std::shared_ptr<const Levels> levels;
+                std::string error;
+                bool transcoded = false;
+            };
+
+            void startDecode(TextureId id);
+            // Runs on a worker; throws on files that cannot be shown
+            DecodedTexture decodeFile(const std::string &path);
+            void takeDecoded();
+            VkExtent2D levelExtent(const Texture &texture, uint32_t level) const;
+            VkDeviceSize chainBytes(const Texture &texture, uint32_t topLevel) const;
+
+            Residency createResidency(const Texture &texture, uint32_t topLevel);
+            void destroyResidency(Residency &residency);
+            // Copies block rows of the pending upload levels; returns true once all are uploaded
+            bool uploadRows(VkCommandBuffer commandBuffer, Texture &texture, VkDeviceSize &uploadBudget);
+            // Copies the levels both images hold, which must be shader readable in source
+            void copyLevels(
+                VkCommandBuffer commandBuffer,
+                const Texture &texture,
+                const Residency &source,
+                const Residency &destination);
+            // Blits levels filledLevels.. of the image from the one above, with extent the size of
+            // level filledLevels - 1, and leaves every level shader readable
+            void recordMipChain(
+                VkCommandBuffer commandBuffer,
+                const Residency &residency,
+                uint32_t filledLevels,
+                VkExtent2D extent);
+            // Completes the pending image once its uploads are recorded and makes it resident
+            void finishUpload(VkCommandBuffer commandBuffer, Texture &texture);
+            // Swaps in residency as the texture's image and registers it with the heap
+            void makeResident(Texture &texture, Residency &residency);
+            // Replaces the resident image with one a level coarser, copied from it on the GPU
+            void demote(VkCommandBuffer commandBuffer, Texture &texture);
+            // Frees budget for bytes by demoting textures used less recently than keep
+            bool reserve(VkCommandBuffer commandBuffer, VkDeviceSize bytes, TextureId keep);
+
+            LveDevice &lveDevice;
+            LveJobSystem &jobSystem;
+            LveBindlessHeap &bindlessHeap;
+            VkDeviceSize budgetBytes;
+            LveStagingRing stagingRing;
+            VkSampler sampler = VK_NULL_HANDLE;
+            VkDeviceSize copyAlignment;
+
+            std::vector<Texture> textures;
+            uint64_t frame = 1;
+            VkDeviceSize residentBytes = 0;
+            bool streaming = true;
+
+            // Filled by decode jobs, drained by update()
+            std::mutex decodedMutex;
+            std::vector<DecodedTexture> decoded;
+            LveJobSystem::Counter decodeJobs;
+
+            uint64_t decodeCount = 0;
+            uint64_t uploadedBytes = 0;
+            uint64_t promotions = 0;
+            uint64_t demotions = 0;
+            uint64_t budgetStalls = 0;
+    };
+}
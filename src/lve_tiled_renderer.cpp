@@ -0,0 +1,485 @@
+#include "lve_tiled_renderer.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    LveTiledRenderer::LveTiledRenderer(
+        LveDevice &device,
+        LveJobSystem &jobSystem,
+        bool dynamicRendering,
+        const Settings &settings)
+        : lveDevice{device}, jobSystem{jobSystem}, dynamicRendering{dynamicRendering}, settings{settings} {
+        const auto &limits = lveDevice.properties.limits;
+        if (settings.width == 0 || settings.height == 0) {
+            throw std::runtime_error("tiled render size must be non-zero");
+        }
+        if (settings.tileSize == 0 ||
+            settings.tileSize > limits.maxImageDimension2D ||
+            settings.tileSize > limits.maxFramebufferWidth ||
+            settings.tileSize > limits.maxFramebufferHeight) {
+            throw std::runtime_error(
+                "tile size must be between 1 and " + std::to_string(limits.maxImageDimension2D));
+        }
+
+        const uint32_t tileSize = settings.tileSize;
+        columns = (settings.width + tileSize - 1) / tileSize;
+        rows = (settings.height + tileSize - 1) / tileSize;
+        tileCount = uint64_t{columns} * rows;
+        // Only the last band can be shorter than a tile
+        chunksPerBand = (tileSize + CHUNK_ROWS - 1) / CHUNK_ROWS;
+        const uint32_t lastBandHeight = settings.height - (rows - 1) * tileSize;
+        chunkCount = uint64_t{rows - 1} * chunksPerBand + (lastBandHeight + CHUNK_ROWS - 1) / CHUNK_ROWS;
+
+        bands.resize(std::min(BAND_BUFFERS, rows));
+        for (uint32_t i = 0; i < bands.size(); i++) {
+            bands[i].row = i;
+            bands[i].rgb.resize(size_t{settings.width} * tileSize * 3);
+        }
+
+        createTileSlots();
+        createRenderGraph();
+        createPipeline();
+
+        frameReadback = std::make_unique<LveFrameReadback>(
+            lveDevice,
+            VkExtent2D{tileSize, tileSize},
+            TILE_FORMAT,
+            TILES_IN_FLIGHT,
+            [this](const LveFrameReadback::Frame &frame) { placeTile(frame); });
+        pngWriter = std::make_unique<LvePngWriter>(settings.outputPath, settings.width, settings.height);
+    }
+
+    LveTiledRenderer::~LveTiledRenderer() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        stateChanged.notify_all();
+        vkDeviceWaitIdle(lveDevice.device());
+
+        // Drains the writers first; their sinks bail out now that stopping is set
+        frameReadback.reset();
+        // Queued jobs still point at this renderer; their errors no longer matter
+        auto finishJobs = [this](LveJobSystem::Counter &counter) {
+            try {
+                jobSystem.wait(counter);
+            } catch (...) {
+            }
+        };
+        for (auto &tileGeometry : geometry) {
+            finishJobs(tileGeometry.done);
+        }
+        finishJobs(compressionJobs);
+
+        renderGraph.reset();
+        pipeline.reset();
+        vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, lveDevice.getAllocator());
+        for (auto &slot : slots) {
+            vkDestroyFence(lveDevice.device(), slot.fence, lveDevice.getAllocator());
+            vkFreeCommandBuffers(lveDevice.device(), lveDevice.getCommandPool(), 1, &slot.commandBuffer);
+            vkUnmapMemory(lveDevice.device(), slot.vertexMemory);
+            vkDestroyBuffer(lveDevice.device(), slot.vertexBuffer, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), slot.vertexMemory, lveDevice.getAllocator());
+            vkDestroyImageView(lveDevice.device(), slot.view, lveDevice.getAllocator());
+            vkDestroyImage(lveDevice.device(), slot.image, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), slot.imageMemory, lveDevice.getAllocator());
+        }
+    }
+
+    void LveTiledRenderer::createTileSlots() {
+        slots.resize(TILES_IN_FLIGHT);
+        for (auto &slot : slots) {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent = {settings.tileSize, settings.tileSize, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = TILE_FORMAT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, slot.image, slot.imageMemory);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = slot.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = TILE_FORMAT;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+            if (vkCreateImageView(lveDevice.device(), &viewInfo, lveDevice.getAllocator(), &slot.view) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create tile image view");
+            }
+
+            // Rewritten for every tile, so host visible rather than staged
+            lveDevice.createBuffer(
+                sizeof(LveModel::Vertex) * MAX_TRIANGLES * 3,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                slot.vertexBuffer,
+                slot.vertexMemory);
+            void *mapped = nullptr;
+            vkMapMemory(lveDevice.device(), slot.vertexMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
+            slot.vertices = static_cast<LveModel::Vertex *>(mapped);
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = lveDevice.getCommandPool();
+            allocInfo.commandBufferCount = 1;
+            if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, &slot.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate tile command buffer");
+            }
+
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+            if (vkCreateFence(lveDevice.device(), &fenceInfo, lveDevice.getAllocator(), &slot.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create tile fence");
+            }
+        }
+    }
+
+    void LveTiledRenderer::createRenderGraph() {
+        renderGraph = std::make_unique<LveRenderGraph>(lveDevice, dynamicRendering);
+        const VkExtent2D extent{settings.tileSize, settings.tileSize};
+
+        // The slot's fence was waited on before recording, so nothing earlier needs to finish and
+        // the old contents are never read
+        tileImage = renderGraph->importImage(
+            "tile",
+            {TILE_FORMAT, extent},
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_IMAGE_LAYOUT_UNDEFINED);
+
+        tilePass = renderGraph->addGraphicsPass("tile", [this](VkCommandBuffer commandBuffer) {
+            recordTile(commandBuffer, *recordingSlot);
+        })
+            .writeColor(tileImage, VkClearColorValue{{0.1f, 0.1f, 0.1f, 1.0f}})
+            .id();
+        renderGraph->addTransferPass("readback", [this](VkCommandBuffer commandBuffer) {
+            frameReadback->recordCopy(
+                commandBuffer, static_cast<uint32_t>(recordingSlot - slots.data()), recordingSlot->image);
+        })
+            .copySource(tileImage)
+            .sideEffect();
+
+        renderGraph->compile();
+        renderGraph->printReport();
+    }
+
+    void LveTiledRenderer::createPipeline() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstantData);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, lveDevice.getAllocator(), &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create tile pipeline layout");
+        }
+
+        // Every tile has the same extent, so viewport and scissor are baked in
+        auto pipelineConfig = LvePipeline::defaultPipelineConfigInfo(settings.tileSize, settings.tileSize);
+        RenderTargetInfo target{};
+        target.renderPass = renderGraph->getRenderPass(tilePass);
+        target.colorFormat = TILE_FORMAT;
+        pipelineConfig.setRenderTarget(target);
+        pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+        pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+        pipelineConfig.pipelineLayout = pipelineLayout;
+        pipeline = std::make_unique<LvePipeline>(
+            lveDevice,
+            "shaders/simple_shader.vert.spv",
+            "shaders/simple_shader.frag.spv",
+            pipelineConfig);
+    }
+
+    LveCamera LveTiledRenderer::getTileCamera(uint64_t tile) const {
+        // The image maps isotropically onto [-w/l, w/l] x [-h/l, h/l] world units, l being the longer
+        // side, so a square image shows the same root triangle as the app at zoom 1
+        const double tileSize = settings.tileSize;
+        const double longSide = std::max(settings.width, settings.height);
+        const double column = static_cast<double>(tile % columns);
+        const double row = static_cast<double>(tile / columns);
+
+        glm::dvec2 center{
+            -settings.width / longSide + (column + 0.5) * tileSize * 2.0 / longSide,
+            -settings.height / longSide + (row + 0.5) * tileSize * 2.0 / longSide};
+        LveCamera camera{};
+        camera.setView(center, longSide / tileSize);
+        return camera;
+    }
+
+    void LveTiledRenderer::recordTile(VkCommandBuffer commandBuffer, const TileSlot &slot) {
+        pipeline->bind(commandBuffer);
+
+        PushConstantData push{};
+        push.scale = slot.transform.scale;
+        push.offset = slot.transform.offset;
+        vkCmdPushConstants(
+            commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(PushConstantData),
+            &push);
+
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &slot.vertexBuffer, &offset);
+        vkCmdDraw(commandBuffer, slot.vertexCount, 1, 0, 0);
+    }
+
+    void LveTiledRenderer::run() {
+        for (uint64_t tile = 0; tile < std::min<uint64_t>(tileCount, geometry.size()); tile++) {
+            scheduleGeometry(tile);
+        }
+
+        std::printf("tiled render: %ux%u as %ux%u tiles of %u px into %s\n",
+            settings.width, settings.height, columns, rows, settings.tileSize, settings.outputPath.c_str());
+        auto startTime = std::chrono::steady_clock::now();
+        auto lastProgress = startTime;
+
+        for (uint64_t tile = 0; tile < tileCount; tile++) {
+            const uint32_t slotIndex = static_cast<uint32_t>(tile % slots.size());
+            TileSlot &slot = slots[slotIndex];
+
+            vkWaitForFences(lveDevice.device(), 1, &slot.fence, VK_TRUE, UINT64_MAX);
+            frameReadback->collect(slotIndex);
+            rethrowError();
+
+            TileGeometry &tileGeometry = geometry[tile % geometry.size()];
+            // Rethrows a geometry failure. Queued jobs run here in the meantime, so not all of the
+            // wait is idle time.
+            auto waitStart = std::chrono::steady_clock::now();
+            jobSystem.wait(tileGeometry.done);
+            geometryWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+            slot.vertexCount = static_cast<uint32_t>(tileGeometry.vertices.size());
+            slot.transform = tileGeometry.transform;
+            std::memcpy(slot.vertices, tileGeometry.vertices.data(), sizeof(LveModel::Vertex) * slot.vertexCount);
+            if (tile + geometry.size() < tileCount) {
+                scheduleGeometry(tile + geometry.size());
+            }
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            if (vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording tile command buffer");
+            }
+            recordingSlot = &slot;
+            renderGraph->setImportedImage(tileImage, slot.image, slot.view);
+            renderGraph->execute(slot.commandBuffer);
+            if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record tile command buffer");
+            }
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &slot.commandBuffer;
+            vkResetFences(lveDevice.device(), 1, &slot.fence);
+            if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &submitInfo, slot.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit tile command buffer");
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastProgress > std::chrono::seconds{2}) {
+                lastProgress = now;
+                std::printf("tiled render: %llu/%llu tiles\n",
+                    static_cast<unsigned long long>(tile + 1),
+                    static_cast<unsigned long long>(tileCount));
+            }
+        }
+
+        vkDeviceWaitIdle(lveDevice.device());
+        frameReadback->collectAll();
+        // Waits for the writers, so every band has been placed and its chunks queued after this
+        frameReadback->printReport();
+        jobSystem.wait(compressionJobs);
+        rethrowError();
+        if (chunksWritten != chunkCount) {
+            throw std::runtime_error("tiled render finished with chunks missing from " + settings.outputPath);
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        // Peak memory is set by the band ring plus tiles in flight and queued for the writers
+        const size_t bandBytes = bands.size() * bands[0].rgb.size();
+        const size_t tileBytes =
+            (LveFrameReadback::MAX_QUEUED_FRAMES + TILES_IN_FLIGHT) * size_t{settings.tileSize} * settings.tileSize * 4;
+        std::printf("tiled render: %llu tiles in %.2f s (%.1f tiles/s, %.1f Mpx/s), %.1f MB written\n",
+            static_cast<unsigned long long>(tileCount),
+            seconds,
+            tileCount / seconds,
+            static_cast<double>(settings.width) * settings.height / seconds / 1.0e6,
+            pngWriter->getBytesWritten() / 1.0e6);
+        std::printf("tiled render: %.1f MB in %zu bands + %.1f MB of tiles, waited %.1f ms on geometry, %.1f ms on bands\n",
+            bandBytes / 1.0e6,
+            bands.size(),
+            tileBytes / 1.0e6,
+            geometryWaitSeconds * 1000.0,
+            bandWaitSeconds * 1000.0);
+    }
+
+    void LveTiledRenderer::scheduleGeometry(uint64_t tile) {
+        jobSystem.run([this, tile]() { buildGeometry(tile); }, &geometry[tile % geometry.size()].done);
+    }
+
+    void LveTiledRenderer::buildGeometry(uint64_t tile) {
+        std::unique_ptr<LveFractal> fractal;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!idleFractals.empty()) {
+                fractal = std::move(idleFractals.back());
+                idleFractals.pop_back();
+            }
+        }
+        if (!fractal) {
+            fractal = std::make_unique<LveFractal>(MAX_TRIANGLES, REFINE_PIXEL_SIZE);
+        }
+
+        LveCamera camera = getTileCamera(tile);
+        fractal->update(camera, static_cast<float>(settings.tileSize));
+        TileGeometry &target = geometry[tile % geometry.size()];
+        const auto &vertices = fractal->getVertices();
+        target.vertices.assign(vertices.begin(), vertices.begin() + fractal->getVertexCount());
+        target.transform = camera.getTransform(fractal->getAnchor());
+
+        std::lock_guard<std::mutex> lock{mutex};
+        idleFractals.push_back(std::move(fractal));
+    }
+
+    void LveTiledRenderer::placeTile(const LveFrameReadback::Frame &frame) {
+        const uint32_t tileSize = settings.tileSize;
+        const uint32_t row = static_cast<uint32_t>(frame.number / columns);
+        const uint32_t column = static_cast<uint32_t>(frame.number % columns);
+        Band &band = bands[row % bands.size()];
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            if (band.row != row) {
+                // The band still holds an earlier row that is being compressed
+                auto waitStart = std::chrono::steady_clock::now();
+                stateChanged.wait(lock, [&]() { return band.row == row || stopping || error; });
+                bandWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+            }
+            if (band.row != row) {
+                throw std::runtime_error("tiled render stopped before tile " + std::to_string(frame.number) + " was placed");
+            }
+        }
+
+        // Edge tiles are rendered whole and cropped here
+        const uint32_t x = column * tileSize;
+        const uint32_t copyWidth = std::min(tileSize, settings.width - x);
+        const uint32_t copyHeight = std::min(tileSize, settings.height - row * tileSize);
+        for (uint32_t y = 0; y < copyHeight; y++) {
+            std::memcpy(
+                band.rgb.data() + (size_t{y} * settings.width + x) * 3,
+                frame.rgb.data() + size_t{y} * tileSize * 3,
+                size_t{copyWidth} * 3);
+        }
+
+        std::vector<Chunk> chunks;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (++band.tilesPlaced < columns) {
+                return;
+            }
+            uint64_t index = uint64_t{row} * chunksPerBand;
+            for (uint32_t firstRow = 0; firstRow < copyHeight; firstRow += CHUNK_ROWS, index++) {
+                Chunk chunk{};
+                chunk.index = index;
+                chunk.band = static_cast<uint32_t>(row % bands.size());
+                chunk.firstRow = firstRow;
+                chunk.rowCount = std::min(CHUNK_ROWS, copyHeight - firstRow);
+                chunk.last = index + 1 == chunkCount;
+                chunks.push_back(chunk);
+                band.chunksLeft++;
+            }
+        }
+        for (const auto &chunk : chunks) {
+            jobSystem.run([this, chunk]() { compressChunk(chunk); }, &compressionJobs);
+        }
+    }
+
+    void LveTiledRenderer::compressChunk(const Chunk &chunk) {
+        try {
+            Band &band = bands[chunk.band];
+            auto compressed = LvePngWriter::compressBand(
+                band.rgb.data() + size_t{chunk.firstRow} * settings.width * 3,
+                settings.width,
+                chunk.rowCount,
+                chunk.last,
+                COMPRESSION_LEVEL);
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (--band.chunksLeft == 0) {
+                    // Compressed data is held separately, so the pixels can be overwritten now
+                    band.row += static_cast<uint32_t>(bands.size());
+                    band.tilesPlaced = 0;
+                }
+            }
+            stateChanged.notify_all();
+            writeChunk(chunk.index, std::move(compressed));
+        } catch (...) {
+            // Reported through fail() so writers waiting for a band wake up too
+            fail(std::current_exception());
+        }
+    }
+
+    void LveTiledRenderer::writeChunk(uint64_t index, LvePngWriter::CompressedBand compressed) {
+        std::unique_lock<std::mutex> lock{mutex};
+        compressedChunks.emplace(index, std::move(compressed));
+        if (writingFile) {
+            // Whoever is writing picks this chunk up when its turn comes
+            return;
+        }
+        writingFile = true;
+        while (!compressedChunks.empty() && compressedChunks.begin()->first == chunksWritten) {
+            auto next = compressedChunks.extract(compressedChunks.begin());
+            lock.unlock();
+            try {
+                pngWriter->writeBand(next.mapped());
+            } catch (...) {
+                lock.lock();
+                writingFile = false;
+                throw;
+            }
+            lock.lock();
+            chunksWritten++;
+        }
+        writingFile = false;
+    }
+
+    void LveTiledRenderer::fail(std::exception_ptr exception) {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!error) {
+                error = exception;
+            }
+        }
+        stateChanged.notify_all();
+    }
+
+    void LveTiledRenderer::rethrowError() {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "lve_camera.hpp"
+#include "lve_device.hpp"
+#include "lve_frame_readback.hpp"
+#include "lve_fractal.hpp"
+#include "lve_job_system.hpp"
+#include "lve_model.hpp"
+#include "lve_pipeline.hpp"
+#include "lve_png_writer.hpp"
+#include "lve_render_graph.hpp"
+
+// std
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+    // Renders the fractal at sizes no single image could hold, e.g. 64k x 64k, as a grid of
+    // offscreen tiles with a camera per tile, and streams the result into one PNG.
+    //
+    // Everything is pipelined: geometry jobs refine the fractal a few tiles ahead, the GPU
+    // renders TILES_IN_FLIGHT tiles at once, LveFrameReadback hands finished tiles to writer
+    // threads that place them into a ring of row bands, and compression jobs deflate each full
+    // band in chunks while the next one fills. The jobs run on the shared job system, and the main
+    // thread helps with them whenever it waits for geometry. PNG rows span the whole image, so
+    // memory is bounded by BAND_BUFFERS bands of width x tileSize pixels rather than by the image.
+    class LveTiledRenderer {
+        public:
+            static constexpr uint32_t TILES_IN_FLIGHT = 3;
+            static constexpr uint32_t BAND_BUFFERS = 3;
+            // Rows deflated per compression job; smaller chunks spread a band over more threads
+            static constexpr uint32_t CHUNK_ROWS = 32;
+            // Tiles the geometry jobs may run ahead of the GPU
+            static constexpr uint32_t GEOMETRY_LOOKAHEAD = 8;
+            static constexpr int COMPRESSION_LEVEL = 6;
+            static constexpr uint32_t MAX_TRIANGLES = 1 << 16;
+            static constexpr float REFINE_PIXEL_SIZE = 2.0f;
+            static constexpr VkFormat TILE_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+            struct Settings {
+                uint32_t width;
+                uint32_t height;
+                uint32_t tileSize = 256;
+                std::string outputPath;
+            };
+
+            LveTiledRenderer(
+                LveDevice &device,
+                LveJobSystem &jobSystem,
+                bool dynamicRendering,
+                const Settings &settings);
+            ~LveTiledRenderer();
+
+            LveTiledRenderer(const LveTiledRenderer &) = delete;
+            LveTiledRenderer &operator=(const LveTiledRenderer &) = delete;
+
+            void run();
+
+        private:
+            struct PushConstantData {
+                glm::vec2 scale;
+                glm::vec2 offset;
+            };
+
+            struct TileSlot {
+                VkImage image = VK_NULL_HANDLE;
+                VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+                VkImageView view = VK_NULL_HANDLE;
+                VkBuffer vertexBuffer = VK_NULL_HANDLE;
+                VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+                LveModel::Vertex *vertices = nullptr;
+                uint32_t vertexCount = 0;
+                LveCamera::Transform transform{};
+                VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+                VkFence fence = VK_NULL_HANDLE;
+            };
+
+            // Written by one geometry job, read by the main thread once done reaches zero
+            struct TileGeometry {
+                std::vector<LveModel::Vertex> vertices;
+                LveCamera::Transform transform{};
+                LveJobSystem::Counter done;
+            };
+
+            // One row of tiles; reused for row + BAND_BUFFERS once every chunk is compressed
+            struct Band {
+                uint32_t row;
+                uint32_t tilesPlaced = 0;
+                uint32_t chunksLeft = 0;
+                std::vector<uint8_t> rgb;
+            };
+
+            struct Chunk {
+                uint64_t index;
+                uint32_t band;
+                uint32_t firstRow;
+                uint32_t rowCount;
+                bool last;
+            };
+
+            void createTileSlots();
+            void createPipeline();
+            void createRenderGraph();
+            LveCamera getTileCamera(uint64_t tile) const;
+            void recordTile(VkCommandBuffer commandBuffer, const TileSlot &slot);
+
+            void scheduleGeometry(uint64_t tile);
+            void buildGeometry(uint64_t tile);
+            void placeTile(const LveFrameReadback::Frame &frame);
+            void compressChunk(const Chunk &chunk);
+            void writeChunk(uint64_t index, LvePngWriter::CompressedBand compressed);
+            void fail(std::exception_ptr exception);
+            void rethrowError();
+
+            LveDevice &lveDevice;
+            LveJobSystem &jobSystem;
+            bool dynamicRendering;
+            Settings settings;
+            uint32_t columns;
+            uint32_t rows;
+            uint64_t tileCount;
+            uint32_t chunksPerBand;
+            uint64_t chunkCount;
+
+            std::vector<TileSlot> slots;
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+            std::unique_ptr<LvePipeline> pipeline;
+            std::unique_ptr<LveRenderGraph> renderGraph;
+            LveRenderGraph::ResourceId tileImage;
+            LveRenderGraph::PassId tilePass;
+            TileSlot *recordingSlot = nullptr;
+            std::unique_ptr<LveFrameReadback> frameReadback;
+            std::unique_ptr<LvePngWriter> pngWriter;
+
+            // Guards everything the jobs and writer threads share below
+            std::mutex mutex;
+            std::condition_variable stateChanged;
+            bool stopping = false;
+            std::exception_ptr error;
+
+            std::array<TileGeometry, GEOMETRY_LOOKAHEAD> geometry;
+            // Idle trees; a job reusing one keeps most coarse nodes of a nearby tile
+            std::vector<std::unique_ptr<LveFractal>> idleFractals;
+
+            std::vector<Band> bands;
+            LveJobSystem::Counter compressionJobs;
+            std::map<uint64_t, LvePngWriter::CompressedBand> compressedChunks;
+            uint64_t chunksWritten = 0;
+            bool writingFile = false;
+
+            double bandWaitSeconds = 0.0;
+            double geometryWaitSeconds = 0.0;
+    };
+}
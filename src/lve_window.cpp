@@ -19,10 +19,35 @@ namespace lve {
         glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
 
         window = glfwCreateWindow(width, height, windowName.c_str(), nullptr, nullptr);
+        glfwSetWindowUserPointer(window, this);
+        glfwSetScrollCallback(window, scrollCallback);
+        glfwSetWindowRefreshCallback(window, refreshCallback);
     }
 
-    void LveWindow::createWindowSurface(VkInstance instance, VkSurfaceKHR *surface) {
-        if (glfwCreateWindowSurface(instance, window, nullptr, surface) != VK_SUCCESS) {
+    void LveWindow::scrollCallback(GLFWwindow *window, double xOffset, double yOffset) {
+        auto lveWindow = reinterpret_cast<LveWindow *>(glfwGetWindowUserPointer(window));
+        lveWindow->scrollOffset += yOffset;
+    }
+
+    void LveWindow::refreshCallback(GLFWwindow *window) {
+        auto lveWindow = reinterpret_cast<LveWindow *>(glfwGetWindowUserPointer(window));
+        lveWindow->damaged = true;
+    }
+
+    double LveWindow::takeScrollOffset() {
+        double offset = scrollOffset;
+        scrollOffset = 0.0;
+        return offset;
+    }
+
+    bool LveWindow::takeDamage() {
+        bool wasDamaged = damaged;
+        damaged = false;
+        return wasDamaged;
+    }
+
+    void LveWindow::createWindowSurface(VkInstance instance, VkSurfaceKHR *surface, const VkAllocationCallbacks *allocator) {
+        if (glfwCreateWindowSurface(instance, window, allocator, surface) != VK_SUCCESS) {
             throw std::runtime_error("failed to create window surface");
         }
     }
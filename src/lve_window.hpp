@@ -15,14 +15,24 @@ namespace lve {
             LveWindow &operator=(const LveWindow &) = delete;
 
             bool shouldClose() {return glfwWindowShouldClose(window);}
-            void createWindowSurface(VkInstance instance, VkSurfaceKHR *surface);
+            void createWindowSurface(VkInstance instance, VkSurfaceKHR *surface, const VkAllocationCallbacks *allocator = nullptr);
             VkExtent2D getExtent() {return {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}; };
+            GLFWwindow *getGLFWwindow() const {return window;}
+
+            // Scroll wheel movement accumulated since the last call
+            double takeScrollOffset();
+            // True once after the window system asked for the contents to be redrawn
+            bool takeDamage();
         private:
+            static void scrollCallback(GLFWwindow *window, double xOffset, double yOffset);
+            static void refreshCallback(GLFWwindow *window);
             void initWindow();
             const int width;
             const int height;
+            double scrollOffset = 0.0;
+            bool damaged = false;
 
             std::string windowName; 
             GLFWwindow *window;
     };
-}
\ No newline at end of file
+}
@@ -1,18 +1,51 @@
 #include "first_app.hpp"
+#include "lve_benchmarks.hpp"
+#include "lve_config.hpp"
+#include "lve_device.hpp"
+#include "lve_job_system.hpp"
+#include "lve_tiled_renderer.hpp"
+#include "lve_window.hpp"
 
 // std
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 
-int main() {
-    lve::FirstApp app{};
-
+int main(int argc, char **argv) {
     try {
+        auto config = lve::LveAppConfig::fromArgs(argc, argv);
+        if (!config.benchmark.empty()) {
+            lve::runBenchmark(config);
+            return EXIT_SUCCESS;
+        }
+        if (config.listDevices) {
+            // A surface is needed for the present check
+            lve::LveWindow window{320, 240, "lve devices"};
+            lve::LveDevice::listPhysicalDevices(window);
+            return EXIT_SUCCESS;
+        }
+
+        if (!config.gigapixelPath.empty()) {
+            // Offscreen only; the window just provides a surface for device selection
+            lve::LveWindow window{320, 240, "lve tiled render"};
+            lve::LveDevice device{window, config.device};
+            lve::LveTiledRenderer::Settings settings{};
+            settings.width = config.gigapixelWidth;
+            settings.height = config.gigapixelHeight;
+            settings.tileSize = config.tileSize;
+            settings.outputPath = config.gigapixelPath;
+            lve::LveJobSystem jobSystem;
+            lve::LveTiledRenderer renderer{
+                device, jobSystem, device.supportsDynamicRendering() && !config.renderPasses, settings};
+            renderer.run();
+            return EXIT_SUCCESS;
+        }
+
+        lve::FirstApp app{config};
         app.run();
     } catch (const std::exception &e) {
         std::cerr << e.what() << '\n';
         return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
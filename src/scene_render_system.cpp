@@ -0,0 +1,140 @@
+#include "scene_render_system.hpp"
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+    SceneRenderSystem::SceneRenderSystem(
+        LveDevice &device,
+        const RenderTargetInfo &renderTarget,
+        VkExtent2D extent,
+        uint32_t maxInstances,
+        uint32_t frameCount)
+        : lveDevice{device}, maxInstances{maxInstances} {
+        createPipelineLayout();
+        createPipeline(renderTarget, extent);
+
+        instanceBuffers.resize(frameCount);
+        for (auto &instanceBuffer : instanceBuffers) {
+            lveDevice.createBuffer(
+                sizeof(LveScene::InstanceData) * maxInstances,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                instanceBuffer.buffer,
+                instanceBuffer.memory
+            );
+            void *data;
+            vkMapMemory(lveDevice.device(), instanceBuffer.memory, 0, VK_WHOLE_SIZE, 0, &data);
+            instanceBuffer.mapped = static_cast<LveScene::InstanceData *>(data);
+        }
+    }
+
+    SceneRenderSystem::~SceneRenderSystem() {
+        for (auto &instanceBuffer : instanceBuffers) {
+            vkUnmapMemory(lveDevice.device(), instanceBuffer.memory);
+            vkDestroyBuffer(lveDevice.device(), instanceBuffer.buffer, lveDevice.getAllocator());
+            vkFreeMemory(lveDevice.device(), instanceBuffer.memory, lveDevice.getAllocator());
+        }
+        lvePipeline.reset();
+        vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, lveDevice.getAllocator());
+    }
+
+    void SceneRenderSystem::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstantData);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 0;
+        pipelineLayoutInfo.pSetLayouts = nullptr;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, lveDevice.getAllocator(), &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create scene pipeline layout");
+        }
+    }
+
+    void SceneRenderSystem::createPipeline(const RenderTargetInfo &renderTarget, VkExtent2D extent) {
+        auto pipelineConfig = LvePipeline::defaultPipelineConfigInfo(extent.width, extent.height);
+        pipelineConfig.setRenderTarget(renderTarget);
+        pipelineConfig.pipelineLayout = pipelineLayout;
+        // Scene objects are a 2D overlay drawn over the fractal at the same depth
+        pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+        pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+
+        VkVertexInputBindingDescription instanceBinding{};
+        instanceBinding.binding = 1;
+        instanceBinding.stride = sizeof(LveScene::InstanceData);
+        instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        pipelineConfig.bindingDescriptions.push_back(instanceBinding);
+
+        pipelineConfig.attributeDescriptions.push_back(
+            {1, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(LveScene::InstanceData, position)});
+        pipelineConfig.attributeDescriptions.push_back(
+            {2, 1, VK_FORMAT_R32_SFLOAT, offsetof(LveScene::InstanceData, rotation)});
+        pipelineConfig.attributeDescriptions.push_back(
+            {3, 1, VK_FORMAT_R32_SFLOAT, offsetof(LveScene::InstanceData, scale)});
+        pipelineConfig.attributeDescriptions.push_back(
+            {4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(LveScene::InstanceData, color)});
+
+        lvePipeline = std::make_unique<LvePipeline>(
+            lveDevice,
+            "shaders/instanced.vert.spv",
+            "shaders/instanced.frag.spv",
+            pipelineConfig
+        );
+    }
+
+    void SceneRenderSystem::render(
+        VkCommandBuffer commandBuffer,
+        uint32_t frameIndex,
+        const LveScene &scene,
+        LveMeshPool &meshPool,
+        const LveCamera &camera) {
+        glm::dvec2 viewMin, viewMax;
+        camera.getViewBounds(viewMin, viewMax);
+        scene.cull(glm::vec2{viewMin}, glm::vec2{viewMax}, visibleIndices);
+        if (visibleIndices.size() > maxInstances) {
+            visibleIndices.resize(maxInstances);
+        }
+        if (visibleIndices.empty()) {
+            return;
+        }
+        scene.buildDrawList(visibleIndices, instances, batches);
+
+        auto &instanceBuffer = instanceBuffers[frameIndex];
+        memcpy(instanceBuffer.mapped, instances.data(), sizeof(LveScene::InstanceData) * instances.size());
+
+        drawItems.clear();
+        for (const auto &batch : batches) {
+            drawItems.push_back({batch.meshId, batch.instanceCount, batch.firstInstance});
+        }
+
+        auto transform = camera.getTransform(glm::dvec2{0.0});
+        PushConstantData push{};
+        push.scale = transform.scale;
+        push.offset = transform.offset;
+
+        lvePipeline->bind(commandBuffer);
+        vkCmdPushConstants(
+            commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(PushConstantData),
+            &push);
+
+        meshPool.bind(commandBuffer);
+        VkBuffer buffers[] = {instanceBuffer.buffer};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, buffers, offsets);
+        meshPool.drawBatch(commandBuffer, frameIndex, drawItems);
+    }
+}
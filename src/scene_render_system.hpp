@@ -0,0 +1,61 @@
+#pragma once
+
+#include "lve_camera.hpp"
+#include "lve_device.hpp"
+#include "lve_mesh_pool.hpp"
+#include "lve_pipeline.hpp"
+#include "lve_scene.hpp"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+    // Draws an LveScene whose objects reference meshes in an LveMeshPool:
+    // cull -> draw list -> one instance upload -> one batched draw per frame.
+    class SceneRenderSystem {
+        public:
+            SceneRenderSystem(LveDevice &device, const RenderTargetInfo &renderTarget, VkExtent2D extent, uint32_t maxInstances, uint32_t frameCount);
+            ~SceneRenderSystem();
+
+            SceneRenderSystem(const SceneRenderSystem &) = delete;
+            SceneRenderSystem &operator=(const SceneRenderSystem &) = delete;
+
+            // Must be recorded inside the render pass
+            void render(
+                VkCommandBuffer commandBuffer,
+                uint32_t frameIndex,
+                const LveScene &scene,
+                LveMeshPool &meshPool,
+                const LveCamera &camera);
+
+            uint32_t getVisibleCount() const { return static_cast<uint32_t>(visibleIndices.size()); }
+
+        private:
+            struct PushConstantData {
+                glm::vec2 scale;
+                glm::vec2 offset;
+            };
+
+            struct InstanceBuffer {
+                VkBuffer buffer;
+                VkDeviceMemory memory;
+                LveScene::InstanceData *mapped;
+            };
+
+            void createPipelineLayout();
+            void createPipeline(const RenderTargetInfo &renderTarget, VkExtent2D extent);
+
+            LveDevice &lveDevice;
+            uint32_t maxInstances;
+            std::unique_ptr<LvePipeline> lvePipeline;
+            VkPipelineLayout pipelineLayout;
+            std::vector<InstanceBuffer> instanceBuffers;
+
+            std::vector<uint32_t> visibleIndices;
+            std::vector<LveScene::InstanceData> instances;
+            std::vector<LveScene::DrawBatch> batches;
+            std::vector<LveMeshPool::DrawItem> drawItems;
+    };
+}
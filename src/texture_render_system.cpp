@@ -0,0 +1,105 @@
+#include "texture_render_system.hpp"
+
+// std
+#include <stdexcept>
+
+namespace lve {
+
+    TextureRenderSystem::TextureRenderSystem(
+        LveDevice &device,
+        const RenderTargetInfo &renderTarget,
+        VkExtent2D extent,
+        LveBindlessHeap &bindlessHeap)
+        : lveDevice{device}, extent{extent}, bindlessHeap{bindlessHeap} {
+        createPipelineLayout();
+        createPipeline(renderTarget);
+    }
+
+    TextureRenderSystem::~TextureRenderSystem() {
+        lvePipeline.reset();
+        vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, lveDevice.getAllocator());
+    }
+
+    void TextureRenderSystem::createPipelineLayout() {
+        VkDescriptorSetLayout setLayout = bindlessHeap.getSetLayout();
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstantData);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, lveDevice.getAllocator(), &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create texture pipeline layout");
+        }
+    }
+
+    void TextureRenderSystem::createPipeline(const RenderTargetInfo &renderTarget) {
+        auto pipelineConfig = LvePipeline::defaultPipelineConfigInfo(extent.width, extent.height);
+        pipelineConfig.setRenderTarget(renderTarget);
+        pipelineConfig.pipelineLayout = pipelineLayout;
+        pipelineConfig.bindingDescriptions.clear();
+        pipelineConfig.attributeDescriptions.clear();
+        pipelineConfig.setTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+        // Drawn over everything else, blended by the texture's alpha
+        pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+        pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+        pipelineConfig.colorBlendAttachment.blendEnable = VK_TRUE;
+        pipelineConfig.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        pipelineConfig.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        pipelineConfig.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        pipelineConfig.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+
+        lvePipeline = std::make_unique<LvePipeline>(
+            lveDevice,
+            "shaders/textured_quad.vert.spv",
+            "shaders/textured_quad.frag.spv",
+            pipelineConfig
+        );
+    }
+
+    void TextureRenderSystem::render(
+        VkCommandBuffer commandBuffer,
+        LveTextureStreamer &streamer,
+        const std::vector<LveTextureStreamer::TextureId> &textures) {
+        lvePipeline->bind(commandBuffer);
+        bindlessHeap.bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout);
+
+        // Pixels to normalized device coordinates, with y pointing down as in Vulkan
+        const glm::vec2 pixelToNdc{2.0f / extent.width, 2.0f / extent.height};
+        float x = THUMBNAIL_MARGIN;
+        const float y = extent.height - THUMBNAIL_MARGIN - THUMBNAIL_HEIGHT;
+        for (auto id : textures) {
+            // Marks the texture as used even while it is not resident, so it is streamed in
+            const uint32_t imageIndex = streamer.use(id);
+            const VkExtent2D textureExtent = streamer.getExtent(id);
+            if (imageIndex == LveTextureStreamer::NOT_RESIDENT || textureExtent.height == 0) {
+                continue;
+            }
+            const float width = THUMBNAIL_HEIGHT * textureExtent.width / textureExtent.height;
+            if (x + width > extent.width) {
+                break;
+            }
+
+            PushConstantData push{};
+            push.offset = glm::vec2{x, y} * pixelToNdc - 1.0f;
+            push.size = glm::vec2{width, THUMBNAIL_HEIGHT} * pixelToNdc;
+            push.imageIndex = imageIndex;
+            vkCmdPushConstants(
+                commandBuffer,
+                pipelineLayout,
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0,
+                sizeof(PushConstantData),
+                &push);
+            vkCmdDraw(commandBuffer, 4, 1, 0, 0);
+            x += width + THUMBNAIL_MARGIN;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "lve_bindless_heap.hpp"
+#include "lve_device.hpp"
+#include "lve_pipeline.hpp"
+#include "lve_texture_streamer.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+    // Draws streamed textures as a row of thumbnails along the bottom of the frame. Each quad
+    // is a four-vertex strip with no vertex buffer that samples the bindless heap at the index
+    // the streamer currently reports, so it sharpens as finer levels become resident.
+    class TextureRenderSystem {
+        public:
+            // Thumbnail height and the gap around each one, in pixels
+            static constexpr float THUMBNAIL_HEIGHT = 128.0f;
+            static constexpr float THUMBNAIL_MARGIN = 8.0f;
+
+            TextureRenderSystem(
+                LveDevice &device,
+                const RenderTargetInfo &renderTarget,
+                VkExtent2D extent,
+                LveBindlessHeap &bindlessHeap);
+            ~TextureRenderSystem();
+
+            TextureRenderSystem(const TextureRenderSystem &) = delete;
+            TextureRenderSystem &operator=(const TextureRenderSystem &) = delete;
+
+            // Must be recorded inside the render pass, after streamer.update() for this frame
+            void render(
+                VkCommandBuffer commandBuffer,
+                LveTextureStreamer &streamer,
+                const std::vector<LveTextureStreamer::TextureId> &textures);
+
+        private:
+            // Matches the push block in textured_quad.vert/.frag
+            struct PushConstantData {
+                glm::vec2 offset;
+                glm::vec2 size;
+                uint32_t imageIndex;
+            };
+
+            void createPipelineLayout();
+            void createPipeline(const RenderTargetInfo &renderTarget);
+
+            LveDevice &lveDevice;
+            VkExtent2D extent;
+            LveBindlessHeap &bindlessHeap;
+            VkPipelineLayout pipelineLayout;
+            std::unique_ptr<LvePipeline> lvePipeline;
+    };
+}